@@ -1,40 +1,179 @@
 #include "AIManager.h"
+#include "AIMemory.h"
 #include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
 
-UAIManager* UAIManager::Get(UWorld* World)
+static TAutoConsoleVariable<float> CVarVisibilityExpireSeconds(
+    TEXT("ai.Visibility.ExpireSeconds"),
+    5.0f,
+    TEXT("Seconds a character is remembered after the last AI lost sight of it."));
+
+UAIManager::UAIManager()
+    : Snapshot(MakeShared<const FVisibilitySnapshot, ESPMode::ThreadSafe>())
+{
+}
+
+UAIManager* UAIManager::Get(const UWorld* World)
+{
+    return World ? World->GetSubsystem<UAIManager>() : nullptr;
+}
+
+void UAIManager::Deinitialize()
+{
+    Clear();
+    Super::Deinitialize();
+}
+
+void UAIManager::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+    Super::GetResourceSizeEx(CumulativeResourceSize);
+
+    SIZE_T Bytes = Records.GetAllocatedSize() + RecordIndices.GetAllocatedSize()
+        + sizeof(FVisibilitySnapshot) + Snapshot->Entries.GetAllocatedSize();
+    for (const FVisibilityRecord& Record : Records)
+    {
+        Bytes += Record.Observers.GetAllocatedSize();
+    }
+    CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Bytes);
+}
+
+TStatId UAIManager::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UAIManager, STATGROUP_Tickables);
+}
+
+FVisibilityRecord* UAIManager::FindRecord(const AActor* Actor)
+{
+    const int32* Index = RecordIndices.Find(Actor);
+    return Index ? &Records[*Index] : nullptr;
+}
+
+void UAIManager::RemoveRecordAt(int32 Index)
 {
-    // Store the manager in the world as a singleton
-    static UAIManager* Manager = nullptr;
-    if (!Manager)
+    RecordIndices.Remove(Records[Index].Key);
+    Records.RemoveAtSwap(Index, EAllowShrinking::No);
+    if (Records.IsValidIndex(Index))
     {
-        Manager = NewObject<UAIManager>(World, UAIManager::StaticClass());
-        Manager->AddToRoot(); // Prevent garbage collection
+        RecordIndices.Add(Records[Index].Key, Index);
     }
-    return Manager;
 }
 
-void UAIManager::AddVisibleCharacter(AActor* Actor)
+void UAIManager::AddVisibleCharacter(AActor* Actor, const AActor* Observer)
 {
-    if (Actor)
+    LLM_SCOPE_BYTAG(AIPerception);
+
+    if (!Actor) return;
+
+    FVisibilityRecord* Record = FindRecord(Actor);
+    if (!Record)
     {
-        VisibleCharacters.Add(Actor);
+        RecordIndices.Add(Actor, Records.Num());
+        Record = &Records.AddDefaulted_GetRef();
+        Record->Actor = Actor;
+        Record->Key = Actor;
     }
+
+    if (Observer)
+    {
+        Record->Observers.AddUnique(Observer);
+    }
+    Record->LastKnownLocation = Actor->GetActorLocation();
+    Record->LastSeenTime = GetWorld()->GetTimeSeconds();
 }
 
-void UAIManager::RemoveVisibleCharacter(AActor* Actor)
+void UAIManager::RemoveVisibleCharacter(AActor* Actor, const AActor* Observer)
 {
-    if (Actor)
+    if (!Actor) return;
+
+    const int32* Index = RecordIndices.Find(Actor);
+    if (!Index) return;
+
+    if (!Observer)
     {
-        VisibleCharacters.Remove(Actor);
+        RemoveRecordAt(*Index);
+        return;
     }
+
+    // Remembered at its last known location until it expires
+    Records[*Index].Observers.Remove(Observer);
 }
 
-const TSet<TWeakObjectPtr<AActor>>& UAIManager::GetVisibleCharacters() const
+void UAIManager::RemoveObserver(const AActor* Observer)
 {
-    return VisibleCharacters;
+    for (FVisibilityRecord& Record : Records)
+    {
+        Record.Observers.Remove(Observer);
+    }
 }
 
 void UAIManager::Clear()
 {
-    VisibleCharacters.Empty();
-}
\ No newline at end of file
+    Records.Empty();
+    RecordIndices.Empty();
+    Snapshot = MakeShared<const FVisibilitySnapshot, ESPMode::ThreadSafe>();
+    bSnapshotStale = false;
+}
+
+void UAIManager::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+    LLM_SCOPE_BYTAG(AIPerception);
+
+    const double Now = GetWorld()->GetTimeSeconds();
+    const double ExpireSeconds = CVarVisibilityExpireSeconds.GetValueOnGameThread();
+
+    // Backwards so swapped-in records have already been visited
+    for (int32 Index = Records.Num() - 1; Index >= 0; --Index)
+    {
+        FVisibilityRecord& Record = Records[Index];
+        const AActor* Actor = Record.Actor.Get();
+        if (!Actor)
+        {
+            RemoveRecordAt(Index);
+            continue;
+        }
+
+        Record.Observers.RemoveAll([](const TWeakObjectPtr<const AActor>& Observer) { return !Observer.IsValid(); });
+        if (Record.Observers.Num() > 0)
+        {
+            Record.LastKnownLocation = Actor->GetActorLocation();
+            Record.LastSeenTime = Now;
+        }
+        else if (Now - Record.LastSeenTime > ExpireSeconds)
+        {
+            RemoveRecordAt(Index);
+        }
+    }
+
+    if (Records.Num() > 0 || Snapshot->Entries.Num() > 0)
+    {
+        bSnapshotStale = true;
+    }
+}
+
+FVisibilitySnapshotRef UAIManager::GetSnapshot() const
+{
+    check(IsInGameThread());
+    if (bSnapshotStale)
+    {
+        PublishSnapshot();
+    }
+    return Snapshot;
+}
+
+void UAIManager::PublishSnapshot() const
+{
+    LLM_SCOPE_BYTAG(AIPerception);
+
+    TSharedRef<FVisibilitySnapshot, ESPMode::ThreadSafe> NewSnapshot = MakeShared<FVisibilitySnapshot, ESPMode::ThreadSafe>();
+    NewSnapshot->Time = GetWorld()->GetTimeSeconds();
+    NewSnapshot->Entries.Reserve(Records.Num());
+    for (const FVisibilityRecord& Record : Records)
+    {
+        NewSnapshot->Entries.Add({ Record.Key, Record.LastKnownLocation, Record.LastSeenTime, Record.GetObserverCount() });
+    }
+
+    // Readers holding the previous snapshot keep it alive until they are done
+    Snapshot = NewSnapshot;
+    bSnapshotStale = false;
+}
@@ -1,32 +1,90 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "UObject/NoExportTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
 #include "GameFramework/Actor.h"
 #include "AIManager.generated.h"
 
+// One character some AI has seen recently
+struct FVisibilityRecord
+{
+    TWeakObjectPtr<AActor> Actor;
+    TObjectKey<AActor> Key;
+
+    // Observers that currently see the actor; the record is kept alive while there are any
+    TArray<TWeakObjectPtr<const AActor>, TInlineAllocator<4>> Observers;
+
+    FVector LastKnownLocation = FVector::ZeroVector;
+    double LastSeenTime = 0.0;
+
+    int32 GetObserverCount() const { return Observers.Num(); }
+};
+
+// Plain copy of the registry, made at most once per frame. It never changes after it is published, so
+// planners on worker threads can read a snapshot handed to them without any locking.
+struct FVisibilitySnapshot
+{
+    struct FEntry
+    {
+        TObjectKey<AActor> Actor;
+        FVector LastKnownLocation;
+        double LastSeenTime;
+        int32 ObserverCount;
+    };
+
+    double Time = 0.0;
+    TArray<FEntry> Entries;
+};
+
+using FVisibilitySnapshotRef = TSharedRef<const FVisibilitySnapshot, ESPMode::ThreadSafe>;
+
+// Per-world registry of the characters the AI can see.
+// Records live in a dense array. A record whose observers have all lost sight expires
+// ai.Visibility.ExpireSeconds after it was last seen.
 UCLASS()
-class GOAP_AI_DEMO_API UAIManager : public UObject
+class GOAP_AI_DEMO_API UAIManager : public UTickableWorldSubsystem
 {
     GENERATED_BODY()
 
 public:
-    // Singleton accessor
-    static UAIManager* Get(UWorld* World);
+    UAIManager();
+
+    static UAIManager* Get(const UWorld* World);
+
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    virtual void Deinitialize() override;
+    virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+    // Observer now sees Actor. Without an observer the sighting only refreshes the timestamp.
+    void AddVisibleCharacter(AActor* Actor, const AActor* Observer = nullptr);
 
-    // Add a visible character
-    void AddVisibleCharacter(AActor* Actor);
+    // Observer lost sight of Actor. Without an observer the record is dropped at once.
+    void RemoveVisibleCharacter(AActor* Actor, const AActor* Observer = nullptr);
 
-    // Remove a character from visibility
-    void RemoveVisibleCharacter(AActor* Actor);
+    // Forgets every sighting by Observer, e.g. when it is destroyed
+    void RemoveObserver(const AActor* Observer);
 
-    // Get all currently visible characters
-    const TSet<TWeakObjectPtr<AActor>>& GetVisibleCharacters() const;
+    // All records, including those only remembered until they expire. Game thread only.
+    const TArray<FVisibilityRecord>& GetVisibilityRecords() const { return Records; }
+
+    // Copy of the records, built on the first call after each tick so frames nobody asks pay nothing.
+    // Grab it on the game thread and pass it to workers.
+    FVisibilitySnapshotRef GetSnapshot() const;
 
     // Clear all (e.g., on level reset)
     void Clear();
 
 private:
-    // Set of currently visible characters
-    TSet<TWeakObjectPtr<AActor>> VisibleCharacters;
-};
\ No newline at end of file
+    FVisibilityRecord* FindRecord(const AActor* Actor);
+    void RemoveRecordAt(int32 Index);
+    void PublishSnapshot() const;
+
+    TArray<FVisibilityRecord> Records;
+    TMap<TObjectKey<AActor>, int32> RecordIndices;
+
+    // Rebuilt lazily by GetSnapshot once a tick has marked it stale
+    mutable FVisibilitySnapshotRef Snapshot;
+    mutable bool bSnapshotStale = false;
+};
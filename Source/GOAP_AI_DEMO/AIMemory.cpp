@@ -0,0 +1,117 @@
+#include "AIMemory.h"
+#include "AI_Character.h"
+#include "GOAPAgentComponent.h"
+#include "Node.h"
+#include "AIController.h"
+#include "Perception/AIPerceptionComponent.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/OutputDevice.h"
+#include "UObject/UObjectIterator.h"
+
+LLM_DEFINE_TAG(AIGOAP, TEXT("GOAP"));
+LLM_DEFINE_TAG(AINodeGraph, TEXT("NodeGraph"));
+LLM_DEFINE_TAG(AIPerception, TEXT("AIPerception"));
+
+namespace AIMemory
+{
+    // The object itself plus what its GetResourceSizeEx reports
+    static SIZE_T GetObjectBytes(const UObject* Object)
+    {
+        return Object ? Object->GetClass()->GetStructureSize() + Object->GetResourceSizeBytes(EResourceSizeMode::Exclusive) : 0;
+    }
+
+    struct FAgentFootprint
+    {
+        FString Name;
+        SIZE_T GOAPBytes = 0;
+        SIZE_T PerceptionBytes = 0;
+        int32 NumActions = 0;
+
+        SIZE_T GetTotal() const { return GOAPBytes + PerceptionBytes; }
+    };
+
+    static FAgentFootprint MeasureAgent(const AAI_Character& Agent)
+    {
+        FAgentFootprint Footprint;
+        Footprint.Name = Agent.GetName();
+
+        if (const UGOAPAgentComponent* GOAPAgent = Agent.GOAPAgentComponent)
+        {
+            Footprint.GOAPBytes = GetObjectBytes(GOAPAgent);
+            for (const UGOAPAction* Action : GOAPAgent->ActionInstances)
+            {
+                Footprint.GOAPBytes += GetObjectBytes(Action);
+            }
+            Footprint.NumActions = GOAPAgent->ActionInstances.Num();
+        }
+
+        if (const AAIController* Controller = Cast<AAIController>(Agent.GetController()))
+        {
+            Footprint.PerceptionBytes = GetObjectBytes(Controller->GetPerceptionComponent())
+                + Controller->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+        }
+        return Footprint;
+    }
+
+    static void DumpMemory(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+    {
+        if (!World) return;
+
+        const int32 TopCount = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 10;
+
+        TArray<TPair<FString, SIZE_T>> Subsystems;
+        SIZE_T SubsystemTotal = 0;
+        for (TObjectIterator<UWorldSubsystem> It; It; ++It)
+        {
+            if (It->GetWorld() != World || It->HasAnyFlags(RF_ClassDefaultObject)) continue;
+
+            const SIZE_T Bytes = GetObjectBytes(*It);
+            Subsystems.Emplace(It->GetClass()->GetName(), Bytes);
+            SubsystemTotal += Bytes;
+        }
+        Subsystems.Sort([](const TPair<FString, SIZE_T>& A, const TPair<FString, SIZE_T>& B) { return A.Value > B.Value; });
+
+        Ar.Logf(TEXT("World subsystems: %.1f KB"), SubsystemTotal / 1024.0);
+        for (const TPair<FString, SIZE_T>& Subsystem : Subsystems)
+        {
+            Ar.Logf(TEXT("  %-40s %10.1f KB"), *Subsystem.Key, Subsystem.Value / 1024.0);
+        }
+
+        TArray<FAgentFootprint> Agents;
+        SIZE_T GOAPTotal = 0, PerceptionTotal = 0;
+        for (TActorIterator<AAI_Character> It(World); It; ++It)
+        {
+            const FAgentFootprint& Footprint = Agents.Add_GetRef(MeasureAgent(**It));
+            GOAPTotal += Footprint.GOAPBytes;
+            PerceptionTotal += Footprint.PerceptionBytes;
+        }
+        Agents.Sort([](const FAgentFootprint& A, const FAgentFootprint& B) { return A.GetTotal() > B.GetTotal(); });
+
+        const int32 NumAgents = FMath::Max(Agents.Num(), 1);
+        Ar.Logf(TEXT("Agents: %d, GOAP %.1f KB (%.2f KB each), perception %.1f KB (%.2f KB each)"),
+            Agents.Num(), GOAPTotal / 1024.0, GOAPTotal / 1024.0 / NumAgents, PerceptionTotal / 1024.0, PerceptionTotal / 1024.0 / NumAgents);
+        for (int32 Index = 0; Index < FMath::Min(TopCount, Agents.Num()); ++Index)
+        {
+            const FAgentFootprint& Footprint = Agents[Index];
+            Ar.Logf(TEXT("  %-40s %8.2f KB  (GOAP %.2f KB in %d actions, perception %.2f KB)"), *Footprint.Name,
+                Footprint.GetTotal() / 1024.0, Footprint.GOAPBytes / 1024.0, Footprint.NumActions, Footprint.PerceptionBytes / 1024.0);
+        }
+
+        int32 NumNodes = 0;
+        SIZE_T NodeBytes = 0;
+        for (TActorIterator<ANode> It(World); It; ++It)
+        {
+            ++NumNodes;
+            NodeBytes += It->GetClass()->GetStructureSize() + It->LinkedNodes.GetAllocatedSize();
+        }
+        Ar.Logf(TEXT("Node actors: %d, %.1f KB excluding components"), NumNodes, NodeBytes / 1024.0);
+    }
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdAIDumpMemory(
+    TEXT("ai.DumpMemory"),
+    TEXT("Lists the memory used by AI world subsystems, agents and node actors. Optional argument: number of agents to list (default 10)."),
+    FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&AIMemory::DumpMemory));
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+// Low-level memory tracker tags for the AI layer; run with -llm and use "stat LLM" to see them.
+//   AIGOAP: agent components, action instances, domains, plans, the planner, squads and the crowd
+//   AINodeGraph: the compiled node graph, cost scales, patrol path cache and flow fields
+//   AIPerception: perception components, the sight subsystem and visibility records
+// The ai.DumpMemory console command lists per-subsystem and per-agent footprints.
+LLM_DECLARE_TAG_API(AIGOAP, GOAP_AI_DEMO_API);
+LLM_DECLARE_TAG_API(AINodeGraph, GOAP_AI_DEMO_API);
+LLM_DECLARE_TAG_API(AIPerception, GOAP_AI_DEMO_API);
@@ -0,0 +1,245 @@
+#include "AISignificanceSubsystem.h"
+#include "AI_Character.h"
+#include "AI_Character_Controller.h"
+#include "AIManager.h"
+#include "SightSubsystem.h"
+#include "GOAPAgentComponent.h"
+#include "GOAPStats.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Perception/AIPerceptionComponent.h"
+#include "Perception/AISense_Sight.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<float> CVarSignificanceHighDistance(
+    TEXT("ai.Significance.HighDistance"),
+    2000.0f,
+    TEXT("Agents farther than this from every player view drop below High significance."));
+
+static TAutoConsoleVariable<float> CVarSignificanceMediumDistance(
+    TEXT("ai.Significance.MediumDistance"),
+    5000.0f,
+    TEXT("Agents farther than this from every player view drop to Low significance."));
+
+static TAutoConsoleVariable<float> CVarSignificanceLowDistance(
+    TEXT("ai.Significance.LowDistance"),
+    10000.0f,
+    TEXT("Agents farther than this from every player view become Dormant."));
+
+static TAutoConsoleVariable<float> CVarSignificanceHysteresis(
+    TEXT("ai.Significance.Hysteresis"),
+    0.1f,
+    TEXT("Fraction of a distance threshold an agent must pass before it changes bucket."));
+
+static TAutoConsoleVariable<int32> CVarSignificanceAgentsPerFrame(
+    TEXT("ai.Significance.AgentsPerFrame"),
+    100,
+    TEXT("Agents whose significance is re-evaluated per frame."));
+
+namespace AISignificance
+{
+    // Indexed by EAISignificance
+    static const FAISignificanceSettings Settings[] =
+    {
+        //  Tick   Movement  Sight  Expansions  Animate  Sight
+        {   0.f,   0.f,      0.f,   0,          true,    true  },
+        {   0.1f,  0.f,      0.2f,  256,        false,   true  },
+        {   0.25f, 0.05f,    0.5f,  128,        false,   true  },
+        {   1.f,   0.1f,     1.f,   64,         false,   false },
+    };
+
+    // A mesh rendered within this many seconds counts as on screen
+    constexpr float RecentlyRenderedTime = 0.5f;
+}
+
+UAISignificanceSubsystem* UAISignificanceSubsystem::Get(const UWorld* World)
+{
+    return World ? World->GetSubsystem<UAISignificanceSubsystem>() : nullptr;
+}
+
+const FAISignificanceSettings& UAISignificanceSubsystem::GetSettings(EAISignificance Significance)
+{
+    return AISignificance::Settings[(int32)Significance];
+}
+
+void UAISignificanceSubsystem::Deinitialize()
+{
+    Agents.Empty();
+    FMemory::Memzero(BucketCounts);
+    Super::Deinitialize();
+}
+
+TStatId UAISignificanceSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UAISignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void UAISignificanceSubsystem::RegisterAgent(AAI_Character* Agent)
+{
+    if (!Agent || Agents.ContainsByPredicate([Agent](const FAgentEntry& Entry) { return Entry.Agent.Get() == Agent; })) return;
+
+    // Agents start at full fidelity and settle within a few frames
+    FAgentEntry& Entry = Agents.AddDefaulted_GetRef();
+    Entry.Agent = Agent;
+    ++BucketCounts[(int32)Entry.Significance];
+}
+
+void UAISignificanceSubsystem::UnregisterAgent(AAI_Character* Agent)
+{
+    const int32 Index = Agents.IndexOfByPredicate([Agent](const FAgentEntry& Entry) { return Entry.Agent.Get() == Agent; });
+    if (Index == INDEX_NONE) return;
+
+    --BucketCounts[(int32)Agents[Index].Significance];
+    Agents.RemoveAtSwap(Index, EAllowShrinking::No);
+}
+
+EAISignificance UAISignificanceSubsystem::GetSignificance(const AAI_Character* Agent) const
+{
+    const FAgentEntry* Entry = Agents.FindByPredicate([Agent](const FAgentEntry& Candidate) { return Candidate.Agent.Get() == Agent; });
+    return Entry ? Entry->Significance : EAISignificance::High;
+}
+
+void UAISignificanceSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+    GOAPStats::FScopedSubsystemTimer Timer(EGOAPTimedSubsystem::Significance);
+
+    for (int32 Index = Agents.Num() - 1; Index >= 0; --Index)
+    {
+        if (!Agents[Index].Agent.IsValid())
+        {
+            --BucketCounts[(int32)Agents[Index].Significance];
+            Agents.RemoveAtSwap(Index, EAllowShrinking::No);
+        }
+    }
+    if (Agents.Num() == 0) return;
+
+    UWorld* World = GetWorld();
+
+    ViewLocations.Reset();
+    for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+    {
+        if (const APlayerController* PlayerController = It->Get())
+        {
+            FVector Location;
+            FRotator Rotation;
+            PlayerController->GetPlayerViewPoint(Location, Rotation);
+            ViewLocations.Add(Location);
+        }
+    }
+
+    // Controllers that currently see someone
+    Observing.Reset();
+    if (const UAIManager* Manager = UAIManager::Get(World))
+    {
+        for (const FVisibilityRecord& Record : Manager->GetVisibilityRecords())
+        {
+            for (const TWeakObjectPtr<const AActor>& Observer : Record.Observers)
+            {
+                Observing.Add(Observer.Get());
+            }
+        }
+    }
+
+    const int32 NumToEvaluate = FMath::Min(Agents.Num(), FMath::Max(CVarSignificanceAgentsPerFrame.GetValueOnGameThread(), 1));
+    for (int32 Count = 0; Count < NumToEvaluate; ++Count)
+    {
+        NextAgent = NextAgent % Agents.Num();
+        FAgentEntry& Entry = Agents[NextAgent++];
+        AAI_Character* Agent = Entry.Agent.Get();
+
+        float DistanceSq = ViewLocations.Num() > 0 ? UE_MAX_FLT : 0.f;
+        for (const FVector& View : ViewLocations)
+        {
+            DistanceSq = FMath::Min(DistanceSq, (float)FVector::DistSquared(View, Agent->GetActorLocation()));
+        }
+        Entry.DistanceBucket = EvaluateDistance(Entry, FMath::Sqrt(DistanceSq));
+
+        int32 Bucket = Entry.DistanceBucket;
+        if (Observing.Contains(Agent->GetController()))
+        {
+            Bucket = (int32)EAISignificance::High;
+        }
+        else if (Agent->WasRecentlyRendered(AISignificance::RecentlyRenderedTime))
+        {
+            Bucket = FMath::Max(Bucket - 1, 0);
+        }
+
+        const EAISignificance Significance = (EAISignificance)Bucket;
+        if (Significance != Entry.Significance)
+        {
+            --BucketCounts[(int32)Entry.Significance];
+            ++BucketCounts[Bucket];
+            Entry.Significance = Significance;
+            Apply(*Agent, Significance);
+        }
+    }
+}
+
+int32 UAISignificanceSubsystem::EvaluateDistance(const FAgentEntry& Entry, float Distance) const
+{
+    const float Thresholds[] =
+    {
+        CVarSignificanceHighDistance.GetValueOnGameThread(),
+        CVarSignificanceMediumDistance.GetValueOnGameThread(),
+        CVarSignificanceLowDistance.GetValueOnGameThread()
+    };
+    const float Hysteresis = CVarSignificanceHysteresis.GetValueOnGameThread();
+
+    // Thresholds already crossed have to be re-crossed by the band to come back, and new ones passed by it
+    int32 Bucket = 0;
+    for (int32 Index = 0; Index < UE_ARRAY_COUNT(Thresholds); ++Index)
+    {
+        const float Scale = Index < Entry.DistanceBucket ? 1.f - Hysteresis : 1.f + Hysteresis;
+        if (Distance > Thresholds[Index] * Scale)
+        {
+            Bucket = Index + 1;
+        }
+    }
+    return Bucket;
+}
+
+void UAISignificanceSubsystem::Apply(AAI_Character& Agent, EAISignificance Significance) const
+{
+    const FAISignificanceSettings& Settings = GetSettings(Significance);
+
+    Agent.SetActorTickInterval(Settings.TickInterval);
+
+    if (UGOAPAgentComponent* GOAPAgent = Agent.GOAPAgentComponent)
+    {
+        GOAPAgent->SetComponentTickInterval(Settings.TickInterval);
+        GOAPAgent->MaxPlanExpansions = Settings.MaxPlanExpansions;
+    }
+
+    if (UCharacterMovementComponent* Movement = Agent.GetCharacterMovement())
+    {
+        Movement->SetComponentTickInterval(Settings.MovementTickInterval);
+    }
+
+    if (USkeletalMeshComponent* Mesh = Agent.GetMesh())
+    {
+        Mesh->VisibilityBasedAnimTickOption = Settings.bAnimateWhenNotRendered
+            ? EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones
+            : EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+    }
+
+    // Centralized sight throttles the observer's traces; the perception component can only switch sight off
+    if (AAI_Character_Controller* Controller = Cast<AAI_Character_Controller>(Agent.GetController()))
+    {
+        USightSubsystem* Sight = USightSubsystem::Get(GetWorld());
+        if (Sight && !USightSubsystem::IsCentralizedSightEnabled())
+        {
+            // Without centralized sight, throttled agents are handed to the sight subsystem for the slower trace rate
+            Controller->SetSharedSight(Settings.bSightEnabled && Settings.SightTraceInterval > 0.f);
+        }
+        if (!Sight || !Sight->SetObserverTraceInterval(Controller, Settings.SightTraceInterval))
+        {
+            if (UAIPerceptionComponent* PerceptionComp = Controller->GetPerceptionComponent())
+            {
+                PerceptionComp->SetSenseEnabled(UAISense_Sight::StaticClass(), Settings.bSightEnabled);
+            }
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AISignificanceSubsystem.generated.h"
+
+class AAI_Character;
+
+UENUM(BlueprintType)
+enum class EAISignificance : uint8
+{
+    High,
+    Medium,
+    Low,
+    Dormant
+};
+
+// What an agent in a significance bucket is allowed to spend
+struct FAISignificanceSettings
+{
+    // Actor and GOAP agent tick interval, in seconds
+    float TickInterval = 0.f;
+
+    // Character movement tick interval, in seconds
+    float MovementTickInterval = 0.f;
+
+    // Minimum seconds between line of sight traces for this observer. Without ai.Sight.Centralized,
+    // agents with an interval are moved from their perception sight sense to the sight subsystem.
+    float SightTraceInterval = 0.f;
+
+    // States one planner search may expand before it gives up; 0 means no limit
+    // A search cut short retries with a doubled limit, so this bounds a single tick's cost, not the plan depth
+    int32 MaxPlanExpansions = 0;
+
+    // Whether the skeletal mesh keeps animating while off screen
+    bool bAnimateWhenNotRendered = true;
+
+    // Whether the perception sight sense stays on (perception component only)
+    bool bSightEnabled = true;
+};
+
+// Buckets every AAI_Character by its distance to the nearest player view and by visibility.
+// Agents that currently see a player are always High; agents rendered recently move up one bucket.
+// Each bucket scales tick rates, sight trace rates, planner expansions and movement fidelity.
+// An agent only moves to a farther bucket after passing the threshold by ai.Significance.Hysteresis,
+// and only moves back after coming the same fraction inside it.
+UCLASS()
+class GOAP_AI_DEMO_API UAISignificanceSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static UAISignificanceSubsystem* Get(const UWorld* World);
+
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    virtual void Deinitialize() override;
+
+    void RegisterAgent(AAI_Character* Agent);
+    void UnregisterAgent(AAI_Character* Agent);
+
+    EAISignificance GetSignificance(const AAI_Character* Agent) const;
+
+    static const FAISignificanceSettings& GetSettings(EAISignificance Significance);
+
+    int32 GetNumAgents(EAISignificance Significance) const { return BucketCounts[(int32)Significance]; }
+
+private:
+    struct FAgentEntry
+    {
+        TWeakObjectPtr<AAI_Character> Agent;
+        EAISignificance Significance = EAISignificance::High;
+
+        // Bucket from distance alone; the hysteresis band is relative to it
+        int32 DistanceBucket = 0;
+    };
+
+    // Distance bucket for Distance, widened by the hysteresis band around the entry's current one
+    int32 EvaluateDistance(const FAgentEntry& Entry, float Distance) const;
+
+    void Apply(AAI_Character& Agent, EAISignificance Significance) const;
+
+    TArray<FAgentEntry> Agents;
+    int32 NextAgent = 0;
+    int32 BucketCounts[4] = { 0, 0, 0, 0 };
+
+    // Per-tick scratch
+    TArray<FVector> ViewLocations;
+    TSet<const AActor*> Observing;
+};
@@ -6,6 +6,13 @@
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/PlayerController.h"
 #include "GameFramework/Character.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "PatrolPathCacheSubsystem.h"
+#include "AsyncPathRequestSubsystem.h"
+#include "AISignificanceSubsystem.h"
+#include "NodeGraphSubsystem.h"
+#include "DStarLitePath.h"
 
 AAI_Character::AAI_Character()
 {
@@ -19,6 +26,21 @@ AAI_Character::AAI_Character()
 void AAI_Character::BeginPlay()
 {
     Super::BeginPlay();
+
+    if (UAISignificanceSubsystem* Significance = UAISignificanceSubsystem::Get(GetWorld()))
+    {
+        Significance->RegisterAgent(this);
+    }
+}
+
+void AAI_Character::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UAISignificanceSubsystem* Significance = UAISignificanceSubsystem::Get(GetWorld()))
+    {
+        Significance->UnregisterAgent(this);
+    }
+
+    Super::EndPlay(EndPlayReason);
 }
 
 // Patrol logic: move to each node in the PatrolPath in sequence
@@ -26,22 +48,166 @@ void AAI_Character::Patrol()
 {
     if (PatrolPath.Num() == 0) return;
 
+    // The agent replans often; the route carries on from HandleMoveCompleted, not from every plan
+    if (bPatrolMoveActive) return;
+
     ANode* TargetNode = PatrolPath[CurrentPatrolIndex];
     if (!TargetNode) return;
 
     MoveToNode(TargetNode);
 }
 
+void AAI_Character::StopPatrol()
+{
+    bPatrolMoveActive = false;
+    bReachedGraphHop = false;
+
+    AAIController* AICon = Cast<AAIController>(GetController());
+    UAsyncPathRequestSubsystem* AsyncPaths = UAsyncPathRequestSubsystem::Get(GetWorld());
+    if (AICon && AsyncPaths)
+    {
+        AsyncPaths->CancelRequest(AICon);
+    }
+}
+
 void AAI_Character::MoveToNode(ANode* TargetNode)
 {
     if (AAIController* AICon = Cast<AAIController>(GetController()))
     {
-        AICon->MoveToLocation(TargetNode->GetActorLocation(), AcceptanceRadius, true);
+        UAsyncPathRequestSubsystem* AsyncPaths = UAsyncPathRequestSubsystem::Get(GetWorld());
+
+        // Linked nodes are walked over the graph, hop by hop; otherwise only the first hop onto
+        // the route (or a hop the cache has no path for) pathfinds
+        if (MoveAlongGraphPath(AICon, TargetNode) || MoveAlongCachedPath(AICon, TargetNode))
+        {
+            if (AsyncPaths) AsyncPaths->CancelRequest(AICon);
+        }
+        // and it does so asynchronously, batched with every other agent's request
+        else if (!AsyncPaths || AsyncPaths->RequestMove(AICon, TargetNode->GetActorLocation(), AcceptanceRadius) == INDEX_NONE)
+        {
+            // A move that fails outright reports nothing, so the next Patrol call tries again
+            if (AICon->MoveToLocation(TargetNode->GetActorLocation(), AcceptanceRadius, true) == EPathFollowingRequestResult::Failed) return;
+        }
+
+        // Set after the request, since replacing a move reports the old one as finished
+        bPatrolMoveActive = true;
+    }
+}
+
+bool AAI_Character::MoveAlongGraphPath(AAIController* AICon, ANode* TargetNode)
+{
+    const bool bFromHop = bReachedGraphHop;
+    bReachedGraphHop = false;
+    GraphHopNode = INDEX_NONE;
+
+    UNodeGraphSubsystem* GraphSubsystem = UNodeGraphSubsystem::Get(GetWorld());
+    if (!GraphSubsystem) return false;
+
+    const FNodeGraph& Graph = GraphSubsystem->GetGraph();
+    const int32 Goal = Graph.GetNodeIndex(TargetNode);
+    if (Goal == INDEX_NONE) return false;
+
+    // Carry on from the hop just reached; anywhere else starts from the nearest node
+    int32 Start = bFromHop && GraphPath && GraphPath->IsValid() ? GraphPath->GetStart() : INDEX_NONE;
+    if (Start == INDEX_NONE)
+    {
+        ANode* FromNode = LastReachedNode.Get();
+        Start = FromNode && FVector::DistSquared2D(GetActorLocation(), FromNode->GetActorLocation()) <= FMath::Square(AcceptanceRadius * 2.f)
+            ? Graph.GetNodeIndex(FromNode)
+            : Graph.FindNearestNode(GetActorLocation(), AcceptanceRadius * 2.f);
+    }
+    if (Start == INDEX_NONE || Start == Goal) return false;
+
+    // A path to the same node is only moved along; the subsystem has already repaired it for cost changes
+    if (GraphPath && GraphPath->IsValid() && GraphPath->GetGoal() == Goal)
+    {
+        if (GraphPath->GetStart() != Start)
+        {
+            GraphPath->UpdateStart(Start);
+        }
+        if (GraphPath->NeedsRepair())
+        {
+            GraphPath->ComputeShortestPath();
+        }
+    }
+    else
+    {
+        GraphPath = GraphSubsystem->CreatePath(Start, Goal);
     }
+
+    const int32 NextNode = GraphPath ? GraphPath->GetNextNode() : INDEX_NONE;
+    if (NextNode == INDEX_NONE) return false;
+
+    if (AICon->MoveToLocation(Graph.GetLocation(NextNode), AcceptanceRadius, true) == EPathFollowingRequestResult::Failed) return false;
+
+    GraphHopNode = NextNode;
+    return true;
+}
+
+bool AAI_Character::MoveAlongCachedPath(AAIController* AICon, ANode* TargetNode)
+{
+    ANode* FromNode = LastReachedNode.Get();
+    UPatrolPathCacheSubsystem* PathCache = UPatrolPathCacheSubsystem::Get(GetWorld());
+    UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    if (!FromNode || FromNode == TargetNode || !PathCache || !NavSys) return false;
+
+    // Other moves (chasing, searching) also complete through HandleMoveCompleted; make sure we really are on the route
+    if (FVector::DistSquared2D(GetActorLocation(), FromNode->GetActorLocation()) > FMath::Square(AcceptanceRadius * 2.f)) return false;
+
+    const ANavigationData* NavData = NavSys->GetNavDataForProps(AICon->GetNavAgentPropertiesRef(), AICon->GetNavAgentLocation());
+    if (!NavData) return false;
+
+    const TArray<FVector>* Points = PathCache->FindOrComputePath(*NavData, FromNode, TargetNode);
+    if (!Points) return false;
+
+    // Each agent follows its own path object; only the points are shared
+    FNavPathSharedPtr Path = MakeShared<FNavigationPath>(*Points);
+    Path->SetNavigationDataUsed(NavData);
+    Path->MarkReady();
+
+    FAIMoveRequest MoveRequest(TargetNode->GetActorLocation());
+    MoveRequest.SetAcceptanceRadius(AcceptanceRadius);
+    MoveRequest.SetUsePathfinding(true);
+    return AICon->RequestMove(MoveRequest, Path).IsValid();
 }
 
-void AAI_Character::HandleMoveCompleted(FAIRequestID, const FPathFollowingResult&)
+void AAI_Character::HandleMoveCompleted(FAIRequestID, const FPathFollowingResult& Result)
 {
-    CurrentPatrolIndex = (CurrentPatrolIndex + 1) % PatrolPath.Num();
+    // The action that started the move may carry on with the next one, e.g. a chase walking hop to hop
+    if (!Result.HasFlag(FPathFollowingResultFlags::NewRequest) && GOAPAgentComponent && GOAPAgentComponent->HandleMoveCompleted(Result)) return;
+
+    if (PatrolPath.Num() == 0) return;
+
+    // Another move took over; whoever issued it owns the agent's movement now
+    if (Result.HasFlag(FPathFollowingResultFlags::NewRequest))
+    {
+        bPatrolMoveActive = false;
+        return;
+    }
+
+    // A graph hop short of the patrol node moves the path's start along and keeps walking
+    if (bPatrolMoveActive && Result.IsSuccess() && GraphPath && GraphPath->IsValid()
+        && GraphHopNode != INDEX_NONE && GraphHopNode != GraphPath->GetGoal())
+    {
+        GraphPath->UpdateStart(GraphHopNode);
+        bReachedGraphHop = true;
+        bPatrolMoveActive = false;
+        Patrol();
+        return;
+    }
+
+    // A failed or aborted move leaves us off the route; the next hop pathfinds from wherever we are.
+    // Any other move (a chase hop) ending just resumes the route towards the same node.
+    if (bPatrolMoveActive)
+    {
+        LastReachedNode = Result.IsSuccess() ? PatrolPath[CurrentPatrolIndex] : nullptr;
+        CurrentPatrolIndex = (CurrentPatrolIndex + 1) % PatrolPath.Num();
+    }
+    else
+    {
+        LastReachedNode = nullptr;
+    }
+
+    bPatrolMoveActive = false;
     Patrol();
 }
@@ -6,6 +6,8 @@
 #include "GOAPAgentComponent.h"
 #include "AI_Character.generated.h"
 
+class AAIController;
+class FDStarLitePath;
 struct FAIRequestID;
 struct FPathFollowingResult;
 
@@ -18,6 +20,7 @@ public:
     AAI_Character();
 
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
     /**  Patrol path set in the editor */
     UPROPERTY(EditAnywhere, Category = "Patrol")
@@ -26,8 +29,16 @@ public:
     /** Called by our AI-controller when a move finishes */
     void HandleMoveCompleted(FAIRequestID RequestID, const FPathFollowingResult& Result);
 
+    // Walks to the next patrol node; does nothing while a patrol move is already under way
     void Patrol();
 
+    // Gives up the current patrol move so another behaviour can take over movement
+    void StopPatrol();
+
+    // Index into PatrolPath of the node walked to next; used to hand patrol progress to and from the crowd
+    int32 GetPatrolIndex() const { return CurrentPatrolIndex; }
+    void SetPatrolIndex(int32 Index) { CurrentPatrolIndex = PatrolPath.Num() > 0 ? FMath::Abs(Index) % PatrolPath.Num() : 0; }
+
     /** GOAP Agent Component */
     UPROPERTY(BlueprintReadOnly, VisibleAnywhere, Category = "GOAP")
     UGOAPAgentComponent* GOAPAgentComponent;
@@ -35,8 +46,30 @@ public:
 private:
     void MoveToNode(ANode* Target); // Issues the MoveTo request
 
+    // Walks one hop of an incremental path over the node graph; false if the graph does not connect us to Target.
+    // Danger nodes and other cost changes are repaired into the path while we walk it.
+    bool MoveAlongGraphPath(AAIController* AICon, ANode* Target);
+
+    // Follows the cached path from the node we are standing on; false if there is none
+    bool MoveAlongCachedPath(AAIController* AICon, ANode* Target);
+
     UPROPERTY(EditAnywhere, Category = "Patrol", meta = (AllowPrivateAccess = "true"))
     float AcceptanceRadius = 100.f;
 
     int32 CurrentPatrolIndex = 0;
+
+    // A move to CurrentPatrolIndex has been issued or queued and has not finished
+    bool bPatrolMoveActive = false;
+
+    // Patrol node the last move ended on, or null before the first node is reached
+    TWeakObjectPtr<ANode> LastReachedNode;
+
+    // Graph path to the current patrol node, kept across hops so cost changes only repair it
+    TSharedPtr<FDStarLitePath> GraphPath;
+
+    // Graph node the patrol move is walking to, or INDEX_NONE when it is not walking the graph
+    int32 GraphHopNode = INDEX_NONE;
+
+    // GraphHopNode was reached, and the path carries on from there
+    bool bReachedGraphHop = false;
 };
@@ -1,12 +1,17 @@
 #include "AI_Character_Controller.h"
+#include "AIMemory.h"
 #include "AI_Character.h"
 #include "Navigation/PathFollowingComponent.h"
 #include "Perception/AIPerceptionComponent.h"
 #include "Perception/AISenseConfig_Sight.h"
+#include "Perception/AISense_Sight.h"
 #include "AIManager.h"
+#include "SightSubsystem.h"
 
 AAI_Character_Controller::AAI_Character_Controller()
 {
+    LLM_SCOPE_BYTAG(AIPerception);
+
     // Ensure the perception component exists; create if not present
     if (!GetPerceptionComponent())
     {
@@ -44,6 +49,65 @@ AAI_Character_Controller::AAI_Character_Controller()
     }
 }
 
+void AAI_Character_Controller::BeginPlay()
+{
+    Super::BeginPlay();
+
+    // With centralized sight the world subsystem does the sight checks for every controller
+    if (USightSubsystem::IsCentralizedSightEnabled())
+    {
+        SetSharedSight(true);
+    }
+}
+
+void AAI_Character_Controller::SetSharedSight(bool bShared)
+{
+    USightSubsystem* Sight = USightSubsystem::Get(GetWorld());
+    if (!Sight || !SightConfig || bSharedSight == bShared) return;
+
+    bSharedSight = bShared;
+    if (bShared)
+    {
+        Sight->RegisterObserver(this, SightConfig->SightRadius, SightConfig->LoseSightRadius, SightConfig->PeripheralVisionAngleDegrees);
+    }
+    else
+    {
+        Sight->UnregisterObserver(this);
+    }
+
+    if (UAIPerceptionComponent* PerceptionComp = GetPerceptionComponent())
+    {
+        PerceptionComp->SetSenseEnabled(UAISense_Sight::StaticClass(), !bShared);
+    }
+}
+
+void AAI_Character_Controller::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (USightSubsystem* Sight = USightSubsystem::Get(GetWorld()))
+    {
+        Sight->UnregisterObserver(this);
+    }
+    if (UAIManager* Manager = UAIManager::Get(GetWorld()))
+    {
+        Manager->RemoveObserver(this);
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void AAI_Character_Controller::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+    Super::GetResourceSizeEx(CumulativeResourceSize);
+
+    CumulativeResourceSize.AddDedicatedSystemMemoryBytes(ReportedVisible.GetAllocatedSize());
+}
+
+void AAI_Character_Controller::HandleSightUpdated(const TArray<AActor*>& SeenActors)
+{
+    // An empty list clears EnemyVisible, just like losing the stimulus does
+    ApplyVisibleActors(SeenActors);
+}
+
 void AAI_Character_Controller::OnMoveCompleted(FAIRequestID RequestID,
     const FPathFollowingResult& Result)
 {
@@ -59,11 +123,25 @@ void AAI_Character_Controller::OnMoveCompleted(FAIRequestID RequestID,
 
 void AAI_Character_Controller::OnPerceptionUpdated(const TArray<AActor*>& UpdatedActors)
 {
+    // UpdatedActors also holds actors that were just lost, so ask for what is still in sight
+    TArray<AActor*> SeenActors;
+    if (UAIPerceptionComponent* PerceptionComp = GetPerceptionComponent())
+    {
+        PerceptionComp->GetCurrentlyPerceivedActors(UAISense_Sight::StaticClass(), SeenActors);
+    }
+    ApplyVisibleActors(SeenActors);
+}
+
+void AAI_Character_Controller::ApplyVisibleActors(const TArray<AActor*>& SeenActors)
+{
+    LLM_SCOPE_BYTAG(AIPerception);
+
     bool bPlayerSeen = false;
     UWorld* World = GetWorld();
     UAIManager* Manager = UAIManager::Get(World);
 
-    for (AActor* Actor : UpdatedActors)
+    TArray<TWeakObjectPtr<AActor>> StillVisible;
+    for (AActor* Actor : SeenActors)
     {
         if (!Actor) continue;
 
@@ -71,14 +149,34 @@ void AAI_Character_Controller::OnPerceptionUpdated(const TArray<AActor*>& Update
         if (Attitude == ETeamAttitude::Friendly)
         {
             bPlayerSeen = true;
-            Manager->AddVisibleCharacter(Actor); // Only add friendlies (the player)
+            StillVisible.Add(Actor);
+            if (Manager)
+            {
+                Manager->AddVisibleCharacter(Actor, this); // Only add friendlies (the player)
+            }
+        }
+    }
+
+    // Tell the manager which characters this controller no longer sees
+    for (const TWeakObjectPtr<AActor>& Reported : ReportedVisible)
+    {
+        if (Manager && Reported.IsValid() && !StillVisible.Contains(Reported))
+        {
+            Manager->RemoveVisibleCharacter(Reported.Get(), this);
         }
     }
+    ReportedVisible = MoveTemp(StillVisible);
 
     if (AAI_Character* AIChar = Cast<AAI_Character>(GetPawn()))
     {
         if (AIChar->GOAPAgentComponent)
         {
+            // Seeing the player, or losing them, makes the current plan stale and starts the hunt over
+            if (AIChar->GOAPAgentComponent->WorldState.FindRef("EnemyVisible") != bPlayerSeen)
+            {
+                AIChar->GOAPAgentComponent->InvalidatePlan(true);
+                AIChar->GOAPAgentComponent->WorldState.Add("EnemyCaught", false);
+            }
             AIChar->GOAPAgentComponent->WorldState.Add("EnemyVisible", bPlayerSeen);
             AIChar->GOAPAgentComponent->WorldState.Add("Alert", bPlayerSeen);
         }
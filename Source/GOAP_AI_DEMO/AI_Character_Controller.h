@@ -13,7 +13,18 @@ class GOAP_AI_DEMO_API AAI_Character_Controller : public AAIController
 public:
     AAI_Character_Controller();
 
+    // Called by USightSubsystem with every actor this controller currently sees
+    void HandleSightUpdated(const TArray<AActor*>& SeenActors);
+
+    // Moves sight checks to USightSubsystem, which can trace at an interval, or back to the perception sight sense
+    void SetSharedSight(bool bShared);
+
+    virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
 protected:
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
     virtual void OnMoveCompleted(FAIRequestID RequestID,
         const FPathFollowingResult& Result) override;
 
@@ -25,6 +36,15 @@ protected:
     UFUNCTION()
     void OnPerceptionUpdated(const TArray<AActor*>& UpdatedActors);
 
+    // Updates the AI manager and the agent's world state from the full set of actors in sight
+    void ApplyVisibleActors(const TArray<AActor*>& SeenActors);
+
+    // Characters this controller has reported to the AI manager as visible
+    TArray<TWeakObjectPtr<AActor>> ReportedVisible;
+
+    // Whether USightSubsystem does this controller's sight checks
+    bool bSharedSight = false;
+
     // Do NOT re-inherit the interface here
     // Just override the function
     virtual FGenericTeamId GetGenericTeamId() const override;
@@ -0,0 +1,236 @@
+#include "AsyncPathRequestSubsystem.h"
+#include "GOAPStats.h"
+#include "AIController.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "NavFilters/NavigationQueryFilter.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarAsyncPathMaxDispatch(
+    TEXT("ai.AsyncPath.MaxDispatchPerFrame"),
+    32,
+    TEXT("Maximum async path queries started per frame."));
+
+static TAutoConsoleVariable<float> CVarAsyncPathDedupCellSize(
+    TEXT("ai.AsyncPath.DedupCellSize"),
+    50.0f,
+    TEXT("Requests whose start and goal fall in the same cells of this size share one path query."));
+
+UAsyncPathRequestSubsystem* UAsyncPathRequestSubsystem::Get(const UWorld* World)
+{
+    return World ? World->GetSubsystem<UAsyncPathRequestSubsystem>() : nullptr;
+}
+
+void UAsyncPathRequestSubsystem::Deinitialize()
+{
+    // Results for in-flight queries are dropped by the navigation system along with the world
+    Queued.Empty();
+    InFlight.Empty();
+    LatestRequest.Empty();
+    Super::Deinitialize();
+}
+
+TStatId UAsyncPathRequestSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UAsyncPathRequestSubsystem, STATGROUP_Tickables);
+}
+
+int32 UAsyncPathRequestSubsystem::RequestMove(AAIController* Controller, const FVector& Goal, float AcceptanceRadius, EPathRequestPriority Priority)
+{
+    UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    if (!Controller || !NavSys) return INDEX_NONE;
+
+    const FNavAgentProperties& AgentProperties = Controller->GetNavAgentPropertiesRef();
+    const FVector Start = Controller->GetNavAgentLocation();
+    const ANavigationData* NavData = NavSys->GetNavDataForProps(AgentProperties, Start);
+    if (!NavData) return INDEX_NONE;
+
+    const int32 RequestId = NextRequestId++;
+    LatestRequest.Add(Controller, RequestId);
+
+    const FWaiter Waiter{ Controller, RequestId, Goal, AcceptanceRadius, Controller->GetCurrentMoveRequestID() };
+
+    const float CellSize = FMath::Max(CVarAsyncPathDedupCellSize.GetValueOnGameThread(), 1.f);
+    FPathKey Key;
+    Key.NavData = NavData;
+    Key.FilterClass = Controller->GetDefaultNavigationFilterClass();
+    Key.Start = FIntVector(FMath::FloorToInt(Start.X / CellSize), FMath::FloorToInt(Start.Y / CellSize), FMath::FloorToInt(Start.Z / CellSize));
+    Key.Goal = FIntVector(FMath::FloorToInt(Goal.X / CellSize), FMath::FloorToInt(Goal.Y / CellSize), FMath::FloorToInt(Goal.Z / CellSize));
+
+    // Join an identical query that is already queued or running
+    for (TPair<uint32, FPendingPath>& Pair : InFlight)
+    {
+        if (Pair.Value.Key == Key)
+        {
+            Pair.Value.Waiters.Add(Waiter);
+            return RequestId;
+        }
+    }
+    for (FPendingPath& Pending : Queued)
+    {
+        if (Pending.Key == Key)
+        {
+            Pending.Waiters.Add(Waiter);
+            Pending.Priority = FMath::Max(Pending.Priority, Priority);
+            return RequestId;
+        }
+    }
+
+    FPendingPath& Pending = Queued.AddDefaulted_GetRef();
+    Pending.Key = Key;
+    Pending.Priority = Priority;
+    Pending.Sequence = NextSequence++;
+    Pending.Start = Start;
+    Pending.Goal = Goal;
+    Pending.AgentProperties = AgentProperties;
+    Pending.Waiters.Add(Waiter);
+    return RequestId;
+}
+
+void UAsyncPathRequestSubsystem::CancelRequest(AAIController* Controller)
+{
+    // Waiters are matched against the latest id, so forgetting it is enough
+    LatestRequest.Remove(Controller);
+}
+
+bool UAsyncPathRequestSubsystem::IsCurrent(const FWaiter& Waiter) const
+{
+    const int32* Latest = LatestRequest.Find(Waiter.Controller);
+    return Latest && *Latest == Waiter.RequestId && Waiter.Controller.IsValid();
+}
+
+bool UAsyncPathRequestSubsystem::HasNewerMove(const FWaiter& Waiter)
+{
+    // A move that has since finished leaves no active request, and the late path is still wanted
+    const FAIRequestID CurrentMove = Waiter.Controller->GetCurrentMoveRequestID();
+    return CurrentMove.IsValid() && CurrentMove.GetID() != Waiter.MoveAtRequest.GetID();
+}
+
+void UAsyncPathRequestSubsystem::FailWaiters(const FPendingPath& Pending)
+{
+    for (const FWaiter& Waiter : Pending.Waiters)
+    {
+        if (!IsCurrent(Waiter)) continue;
+
+        AAIController* Controller = Waiter.Controller.Get();
+        LatestRequest.Remove(Waiter.Controller);
+        if (HasNewerMove(Waiter)) continue;
+
+        UE_LOG(LogTemp, Verbose, TEXT("Async path for %s failed; pathfinding synchronously."), *Controller->GetName());
+        if (Controller->MoveToLocation(Waiter.Goal, Waiter.AcceptanceRadius, true) == EPathFollowingRequestResult::Failed)
+        {
+            // Without a completion the caller would wait forever
+            Controller->OnMoveCompleted(FAIRequestID::InvalidRequest, FPathFollowingResult(EPathFollowingResult::Invalid, FPathFollowingResultFlags::None));
+        }
+    }
+}
+
+void UAsyncPathRequestSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+    GOAPStats::FScopedSubsystemTimer Timer(EGOAPTimedSubsystem::AsyncPaths);
+
+    if (Queued.Num() > 0)
+    {
+        DispatchQueued();
+    }
+}
+
+void UAsyncPathRequestSubsystem::DispatchQueued()
+{
+    UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    if (!NavSys) return;
+
+    // Requests every waiter has since replaced are not worth a query
+    Queued.RemoveAll([this](FPendingPath& Pending)
+    {
+        Pending.Waiters.RemoveAll([this](const FWaiter& Waiter) { return !IsCurrent(Waiter); });
+        return Pending.Waiters.Num() == 0 || !Pending.Key.NavData.IsValid();
+    });
+
+    // Highest priority first, oldest first within a priority
+    Queued.Sort([](const FPendingPath& A, const FPendingPath& B)
+    {
+        return A.Priority != B.Priority ? A.Priority > B.Priority : A.Sequence < B.Sequence;
+    });
+
+    // Failures are handled after the loop, since they may queue new requests
+    TArray<FPendingPath> Failed;
+    const int32 NumToDispatch = FMath::Min(Queued.Num(), CVarAsyncPathMaxDispatch.GetValueOnGameThread());
+    for (int32 Index = 0; Index < NumToDispatch; ++Index)
+    {
+        FPendingPath& Pending = Queued[Index];
+        const ANavigationData& NavData = *Pending.Key.NavData.Get();
+
+        // The navigation system runs queued async queries as one batch on a worker thread
+        FPathFindingQuery Query(nullptr, NavData, Pending.Start, Pending.Goal,
+            UNavigationQueryFilter::GetQueryFilter(NavData, nullptr, Pending.Key.FilterClass));
+        const uint32 QueryId = NavSys->FindPathAsync(Pending.AgentProperties, Query,
+            FNavPathQueryDelegate::CreateUObject(this, &UAsyncPathRequestSubsystem::OnPathFound));
+
+        if (QueryId != INVALID_NAVQUERYID)
+        {
+            InFlight.Add(QueryId, MoveTemp(Pending));
+        }
+        else
+        {
+            Failed.Add(MoveTemp(Pending));
+        }
+    }
+    Queued.RemoveAt(0, NumToDispatch, EAllowShrinking::No);
+
+    for (const FPendingPath& Pending : Failed)
+    {
+        FailWaiters(Pending);
+    }
+}
+
+void UAsyncPathRequestSubsystem::OnPathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path)
+{
+    GOAPStats::FScopedSubsystemTimer Timer(EGOAPTimedSubsystem::AsyncPaths);
+
+    FPendingPath Pending;
+    if (!InFlight.RemoveAndCopyValue(QueryId, Pending)) return;
+
+    const bool bSuccess = Result == ENavigationQueryResult::Success && Path.IsValid() && Path->GetPathPoints().Num() > 0;
+    if (!bSuccess)
+    {
+        FailWaiters(Pending);
+        return;
+    }
+
+    bool bPathUsed = false;
+    for (const FWaiter& Waiter : Pending.Waiters)
+    {
+        if (!IsCurrent(Waiter)) continue;
+
+        AAIController* Controller = Waiter.Controller.Get();
+        LatestRequest.Remove(Waiter.Controller);
+
+        // Chasing, flanking or any other move started since then takes precedence over a late patrol path
+        if (HasNewerMove(Waiter)) continue;
+
+        // The first waiter takes the query's path; the others follow their own copy of the points
+        FNavPathSharedPtr WaiterPath = Path;
+        if (bPathUsed)
+        {
+            TArray<FVector> Points;
+            Points.Reserve(Path->GetPathPoints().Num());
+            for (const FNavPathPoint& Point : Path->GetPathPoints())
+            {
+                Points.Add(Point.Location);
+            }
+            WaiterPath = MakeShared<FNavigationPath>(Points);
+            WaiterPath->SetNavigationDataUsed(Path->GetNavigationDataUsed());
+            WaiterPath->MarkReady();
+        }
+        bPathUsed = true;
+
+        FAIMoveRequest MoveRequest(Waiter.Goal);
+        MoveRequest.SetAcceptanceRadius(Waiter.AcceptanceRadius);
+        MoveRequest.SetUsePathfinding(true);
+        Controller->RequestMove(MoveRequest, WaiterPath);
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NavigationSystemTypes.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "AITypes.h"
+#include "AsyncPathRequestSubsystem.generated.h"
+
+class AAIController;
+class ANavigationData;
+class UNavigationQueryFilter;
+
+UENUM(BlueprintType)
+enum class EPathRequestPriority : uint8
+{
+    Low,
+    Normal,
+    High
+};
+
+// Queues AI move requests and resolves them with asynchronous navmesh queries, so many agents
+// starting to move in the same frame no longer pathfind synchronously on the game thread.
+// Queued requests are dispatched highest priority first, at most ai.AsyncPath.MaxDispatchPerFrame per frame.
+// Requests with the same nav data, filter and start/goal (within ai.AsyncPath.DedupCellSize) share one query.
+// Path following starts when the result arrives, unless the controller has started another move meanwhile.
+// Failed queries fall back to a synchronous MoveToLocation; if that fails too, the controller's
+// OnMoveCompleted is called with an invalid request so whoever asked can advance or retry.
+UCLASS()
+class GOAP_AI_DEMO_API UAsyncPathRequestSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static UAsyncPathRequestSubsystem* Get(const UWorld* World);
+
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    virtual void Deinitialize() override;
+
+    // Queues a move for Controller to Goal, replacing any request it still has pending. Returns a request id.
+    int32 RequestMove(AAIController* Controller, const FVector& Goal, float AcceptanceRadius, EPathRequestPriority Priority = EPathRequestPriority::Normal);
+
+    // Drops Controller's pending request, if any
+    void CancelRequest(AAIController* Controller);
+
+    int32 GetNumQueued() const { return Queued.Num(); }
+    int32 GetNumInFlight() const { return InFlight.Num(); }
+
+private:
+    struct FPathKey
+    {
+        TWeakObjectPtr<const ANavigationData> NavData;
+        TSubclassOf<UNavigationQueryFilter> FilterClass;
+        FIntVector Start;
+        FIntVector Goal;
+
+        bool operator==(const FPathKey& Other) const
+        {
+            return NavData == Other.NavData && FilterClass == Other.FilterClass && Start == Other.Start && Goal == Other.Goal;
+        }
+    };
+
+    struct FWaiter
+    {
+        TWeakObjectPtr<AAIController> Controller;
+        int32 RequestId = INDEX_NONE;
+        FVector Goal = FVector::ZeroVector;
+        float AcceptanceRadius = 0.f;
+
+        // Controller's move when the request was made; a different active move by arrival time wins
+        FAIRequestID MoveAtRequest;
+    };
+
+    struct FPendingPath
+    {
+        FPathKey Key;
+        EPathRequestPriority Priority = EPathRequestPriority::Normal;
+        uint64 Sequence = 0;
+        FVector Start = FVector::ZeroVector;
+        FVector Goal = FVector::ZeroVector;
+        FNavAgentProperties AgentProperties;
+        TArray<FWaiter> Waiters;
+    };
+
+    // Starts async queries for the best queued requests
+    void DispatchQueued();
+
+    void OnPathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+
+    // True if Waiter's controller has not issued a newer request since
+    bool IsCurrent(const FWaiter& Waiter) const;
+
+    // True if Waiter's controller is following a move issued some other way since the request
+    static bool HasNewerMove(const FWaiter& Waiter);
+
+    // Moves Pending's current waiters without the async path, or tells them the move failed
+    void FailWaiters(const FPendingPath& Pending);
+
+    TArray<FPendingPath> Queued;
+    TMap<uint32, FPendingPath> InFlight;
+
+    // Latest request id per controller; older waiters are ignored when their path arrives
+    TMap<TWeakObjectPtr<AAIController>, int32> LatestRequest;
+
+    int32 NextRequestId = 0;
+    uint64 NextSequence = 0;
+};
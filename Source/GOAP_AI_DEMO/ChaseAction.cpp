@@ -1,11 +1,21 @@
 #include "ChaseAction.h"
 #include "AI_Character.h"
+#include "AIController.h"
+#include "AIManager.h"
+#include "FlowFieldSubsystem.h"
 #include "GOAPAgentComponent.h"
+#include "GOAPStats.h"
+#include "NodeGraphSubsystem.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "Kismet/GameplayStatics.h"
 
 UChaseAction::UChaseAction()
 {
     // Preconditions: must see the enemy
     Preconditions.Add(FGOAPState("EnemyVisible", true));
+
+    // Effects: the enemy is run down
+    Effects.Add(FGOAPState("EnemyCaught", true));
 }
 
 bool UChaseAction::CheckProceduralPrecondition(const TMap<FName, bool>& WorldState) const
@@ -16,15 +26,117 @@ bool UChaseAction::CheckProceduralPrecondition(const TMap<FName, bool>& WorldSta
 }
 
 void UChaseAction::PerformAction()
+{
+    bFlankIssued = false;
+    bClosingIn = false;
+    MoveTowardTarget();
+}
+
+bool UChaseAction::ContinueAfterMove(const FPathFollowingResult& Result)
+{
+    // Caught up, or the move failed; the agent decides what comes next
+    if (bClosingIn || !Result.IsSuccess()) return false;
+
+    // Sight of the enemy lost mid-chase; perception has already asked for a new plan
+    const UGOAPAgentComponent* AgentComp = Cast<UGOAPAgentComponent>(GetOuter());
+    if (!AgentComp || !CheckProceduralPrecondition(AgentComp->WorldState)) return false;
+
+    return MoveTowardTarget();
+}
+
+bool UChaseAction::MoveTowardTarget()
 {
     UGOAPAgentComponent* AgentComp = Cast<UGOAPAgentComponent>(GetOuter());
-    if (!AgentComp) return;
+    if (!AgentComp) return false;
 
     AAI_Character* AIChar = Cast<AAI_Character>(AgentComp->GetOwner());
-    if (AIChar)
+    AAIController* AICon = AIChar ? Cast<AAIController>(AIChar->GetController()) : nullptr;
+    AActor* Target = FindChaseTarget();
+    if (!AICon || !Target) return false;
+
+    UWorld* World = AIChar->GetWorld();
+
+    // A patrol path still in flight must not override the chase when it arrives
+    AIChar->StopPatrol();
+    GOAPStats::RecordChaseMove();
+
+    if (FlankOffset != 0.f && !bFlankIssued)
+    {
+        // Flankers leave the shared flow field and run for a point beside the target, then close in from there
+        const FVector ToTarget = (Target->GetActorLocation() - AIChar->GetActorLocation()).GetSafeNormal2D();
+        const FVector Side = FVector::CrossProduct(FVector::UpVector, ToTarget);
+        bFlankIssued = true;
+        return AICon->MoveToLocation(Target->GetActorLocation() + Side * FlankOffset, AcceptanceRadius) != EPathFollowingRequestResult::Failed;
+    }
+
+    UFlowFieldSubsystem* FlowField = UFlowFieldSubsystem::Get(World);
+    UNodeGraphSubsystem* GraphSubsystem = UNodeGraphSubsystem::Get(World);
+    if (!FlowField || !GraphSubsystem)
+    {
+        return CloseIn(*AICon, *Target);
+    }
+
+    const FNodeGraph& Graph = GraphSubsystem->GetGraph();
+    const FVector Location = AIChar->GetActorLocation();
+
+    // The nearest-node search only runs when we are off the graph, not every step
+    if (!Graph.IsValidNode(HopNode) || HopGraphVersion != GraphSubsystem->GetGraphVersion() ||
+        FVector::DistSquared(Location, Graph.GetLocation(HopNode)) > FMath::Square(ReacquireDistance))
+    {
+        HopNode = Graph.FindNearestNode(Location, ReacquireDistance);
+        HopGraphVersion = GraphSubsystem->GetGraphVersion();
+    }
+
+    if (HopNode == INDEX_NONE)
+    {
+        return CloseIn(*AICon, *Target);
+    }
+
+    // Reached the hop node: the shared field says where to go next, no pathfinding involved
+    if (FVector::DistSquared2D(Location, Graph.GetLocation(HopNode)) <= FMath::Square(AcceptanceRadius))
+    {
+        int32 NextNode = INDEX_NONE;
+        if (!FlowField->SampleNextHop(Target, HopNode, NextNode))
+        {
+            // Field still building or target unreachable over the graph
+            return CloseIn(*AICon, *Target);
+        }
+
+        if (NextNode == INDEX_NONE)
+        {
+            // On the target's node; close the last stretch directly
+            return CloseIn(*AICon, *Target);
+        }
+        HopNode = NextNode;
+    }
+
+    return AICon->MoveToLocation(Graph.GetLocation(HopNode), AcceptanceRadius, true, false) != EPathFollowingRequestResult::Failed;
+}
+
+bool UChaseAction::CloseIn(AAIController& AICon, AActor& Target)
+{
+    bClosingIn = true;
+    return AICon.MoveToActor(&Target, AcceptanceRadius) != EPathFollowingRequestResult::Failed;
+}
+
+AActor* UChaseAction::FindChaseTarget() const
+{
+    UWorld* World = GetWorld();
+
+    // Most recently seen character; ones still in someone's sight are refreshed every frame
+    AActor* Best = nullptr;
+    double BestTime = -UE_BIG_NUMBER;
+    if (const UAIManager* Manager = UAIManager::Get(World))
     {
-        // Implement your chase logic here, e.g., move toward the player
-        UE_LOG(LogTemp, Warning, TEXT("AI_Character is chasing the player!"));
-        // Example: AIChar->ChasePlayer();
+        for (const FVisibilityRecord& Record : Manager->GetVisibilityRecords())
+        {
+            AActor* Actor = Record.Actor.Get();
+            if (Actor && Record.LastSeenTime > BestTime)
+            {
+                Best = Actor;
+                BestTime = Record.LastSeenTime;
+            }
+        }
     }
+    return Best ? Best : UGameplayStatics::GetPlayerPawn(World, 0);
 }
@@ -4,6 +4,8 @@
 #include "GOAPAction.h"
 #include "ChaseAction.generated.h"
 
+class AAIController;
+
 UCLASS()
 class GOAP_AI_DEMO_API UChaseAction : public UGOAPAction
 {
@@ -14,4 +16,38 @@ public:
 
 	virtual bool CheckProceduralPrecondition(const TMap<FName, bool>& WorldState) const override;
 	virtual void PerformAction() override;
+
+	// Keeps walking hop to hop while the enemy stays visible, until the final approach ends
+	virtual bool ContinueAfterMove(const FPathFollowingResult& Result) override;
+
+	// Distance at which a graph node counts as reached
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chase")
+	float AcceptanceRadius = 100.f;
+
+	// Further than this from the node being walked to, the agent looks up its nearest node again
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chase")
+	float ReacquireDistance = 1000.f;
+
+	// Set by the squad for flankers: run to this far to the side of the target (negative is left) instead of at it
+	float FlankOffset = 0.f;
+
+private:
+	// Issues the next move of the chase; false if there is nothing to move to
+	bool MoveTowardTarget();
+
+	// Pathfinds straight to the target; the chase ends when this move does
+	bool CloseIn(AAIController& AICon, AActor& Target);
+
+	// Actor being chased: the most recently seen character, otherwise the first player
+	AActor* FindChaseTarget() const;
+
+	// This chase already sent the agent to its flank point
+	bool bFlankIssued = false;
+
+	// The last move went straight for the target; its end ends the chase
+	bool bClosingIn = false;
+
+	// Graph node the agent is walking to, sampled from the shared flow field
+	int32 HopNode = INDEX_NONE;
+	uint32 HopGraphVersion = 0;
 };
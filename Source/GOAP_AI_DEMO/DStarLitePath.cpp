@@ -0,0 +1,204 @@
+#include "DStarLitePath.h"
+#include "NodeGraph.h"
+
+FDStarLitePath::FDStarLitePath(const FNodeGraph& InGraph, int32 InStart, int32 InGoal)
+    : Graph(InGraph)
+    , Start(InStart)
+    , Goal(InGoal)
+    , LastStart(InStart)
+{
+    const int32 NumNodes = Graph.NumNodes();
+    G.Init(UE_MAX_FLT, NumNodes);
+    Rhs.Init(UE_MAX_FLT, NumNodes);
+    OpenKeys.SetNumZeroed(NumNodes);
+    InOpen.Init(false, NumNodes);
+
+    if (!Graph.IsValidNode(Start) || !Graph.IsValidNode(Goal))
+    {
+        bValid = false;
+        return;
+    }
+
+    Rhs[Goal] = 0.f;
+    InsertOpen(Goal, CalculateKey(Goal));
+}
+
+float FDStarLitePath::Heuristic(int32 From, int32 To) const
+{
+    // Straight-line distance; admissible because cost scales are >= 1
+    return FVector::Dist(Graph.GetLocation(From), Graph.GetLocation(To));
+}
+
+FDStarLitePath::FKey FDStarLitePath::CalculateKey(int32 Node) const
+{
+    const float MinCost = FMath::Min(G[Node], Rhs[Node]);
+    return { MinCost + Heuristic(Start, Node) + KeyModifier, MinCost };
+}
+
+void FDStarLitePath::InsertOpen(int32 Node, const FKey& Key)
+{
+    OpenKeys[Node] = Key;
+    InOpen[Node] = true;
+    OpenHeap.HeapPush({ Key, Node });
+}
+
+void FDStarLitePath::PruneOpen()
+{
+    while (OpenHeap.Num() > 0)
+    {
+        const FOpenEntry& Top = OpenHeap.HeapTop();
+        if (InOpen[Top.Node] && !(Top.Key < OpenKeys[Top.Node]) && !(OpenKeys[Top.Node] < Top.Key))
+        {
+            return;
+        }
+        OpenHeap.HeapPopDiscard(EAllowShrinking::No);
+    }
+}
+
+void FDStarLitePath::UpdateVertex(int32 Node)
+{
+    if (Node != Goal)
+    {
+        // rhs is a one-step lookahead over successors
+        float Best = UE_MAX_FLT;
+        for (int32 Edge = Graph.EdgeBegin(Node); Edge < Graph.EdgeEnd(Node); ++Edge)
+        {
+            Best = FMath::Min(Best, Graph.GetEdgeCost(Edge) + G[Graph.GetEdgeTarget(Edge)]);
+        }
+        Rhs[Node] = Best;
+    }
+
+    RemoveOpen(Node);
+    if (G[Node] != Rhs[Node])
+    {
+        InsertOpen(Node, CalculateKey(Node));
+    }
+}
+
+void FDStarLitePath::UpdateStart(int32 NewStart)
+{
+    if (!bValid || NewStart == Start || !Graph.IsValidNode(NewStart)) return;
+
+    // Keys stay comparable by adding the distance the start moved instead of re-keying the queue
+    Start = NewStart;
+    KeyModifier += Heuristic(LastStart, Start);
+    LastStart = Start;
+    bNeedsRepair = true;
+}
+
+void FDStarLitePath::NotifyNodeCostChanged(int32 Node)
+{
+    if (!bValid || !Graph.IsValidNode(Node)) return;
+
+    for (int32 I = Graph.InEdgeBegin(Node); I < Graph.InEdgeEnd(Node); ++I)
+    {
+        UpdateVertex(Graph.GetEdgeSource(Graph.GetInEdge(I)));
+    }
+    bNeedsRepair = true;
+}
+
+void FDStarLitePath::NotifyEdgeCostChanged(int32 Edge)
+{
+    if (!bValid || Edge < 0 || Edge >= Graph.NumEdges()) return;
+
+    UpdateVertex(Graph.GetEdgeSource(Edge));
+    bNeedsRepair = true;
+}
+
+bool FDStarLitePath::ComputeShortestPath(int32 MaxExpansions)
+{
+    if (!bValid) return false;
+
+    int32 Expansions = 0;
+    PruneOpen();
+    while (OpenHeap.Num() > 0 && (OpenHeap.HeapTop().Key < CalculateKey(Start) || Rhs[Start] > G[Start]))
+    {
+        if (Expansions++ >= MaxExpansions)
+        {
+            return false; // Budget spent; call again to continue
+        }
+
+        FOpenEntry Entry;
+        OpenHeap.HeapPop(Entry, EAllowShrinking::No);
+        const int32 Node = Entry.Node;
+        const FKey NewKey = CalculateKey(Node);
+
+        if (Entry.Key < NewKey)
+        {
+            // Key is stale because the start moved; requeue with the current key
+            InsertOpen(Node, NewKey);
+        }
+        else if (G[Node] > Rhs[Node])
+        {
+            // Overconsistent: cost went down, settle it and tell predecessors
+            G[Node] = Rhs[Node];
+            RemoveOpen(Node);
+            for (int32 I = Graph.InEdgeBegin(Node); I < Graph.InEdgeEnd(Node); ++I)
+            {
+                UpdateVertex(Graph.GetEdgeSource(Graph.GetInEdge(I)));
+            }
+        }
+        else
+        {
+            // Underconsistent: cost went up, reset it and re-derive it and its predecessors
+            G[Node] = UE_MAX_FLT;
+            UpdateVertex(Node);
+            for (int32 I = Graph.InEdgeBegin(Node); I < Graph.InEdgeEnd(Node); ++I)
+            {
+                UpdateVertex(Graph.GetEdgeSource(Graph.GetInEdge(I)));
+            }
+        }
+
+        PruneOpen();
+    }
+
+    bNeedsRepair = false;
+    return Rhs[Start] < UE_MAX_FLT;
+}
+
+int32 FDStarLitePath::GetNextNode() const
+{
+    if (!bValid || Start == Goal || G[Start] >= UE_MAX_FLT) return INDEX_NONE;
+
+    int32 BestNode = INDEX_NONE;
+    float BestCost = UE_MAX_FLT;
+    for (int32 Edge = Graph.EdgeBegin(Start); Edge < Graph.EdgeEnd(Start); ++Edge)
+    {
+        const int32 Target = Graph.GetEdgeTarget(Edge);
+        const float Cost = Graph.GetEdgeCost(Edge) + G[Target];
+        if (Cost < BestCost)
+        {
+            BestCost = Cost;
+            BestNode = Target;
+        }
+    }
+    return BestNode;
+}
+
+void FDStarLitePath::GetPath(TArray<int32>& OutPath) const
+{
+    OutPath.Reset();
+    if (!bValid || G[Start] >= UE_MAX_FLT) return;
+
+    OutPath.Add(Start);
+    int32 Current = Start;
+    while (Current != Goal && OutPath.Num() <= Graph.NumNodes())
+    {
+        int32 Next = INDEX_NONE;
+        float BestCost = UE_MAX_FLT;
+        for (int32 Edge = Graph.EdgeBegin(Current); Edge < Graph.EdgeEnd(Current); ++Edge)
+        {
+            const int32 Target = Graph.GetEdgeTarget(Edge);
+            const float Cost = Graph.GetEdgeCost(Edge) + G[Target];
+            if (Cost < BestCost)
+            {
+                BestCost = Cost;
+                Next = Target;
+            }
+        }
+
+        if (Next == INDEX_NONE) break;
+        OutPath.Add(Next);
+        Current = Next;
+    }
+}
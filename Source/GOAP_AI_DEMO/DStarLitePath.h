@@ -0,0 +1,88 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FNodeGraph;
+
+// Incremental shortest path on the compiled node graph (D* Lite, Koenig & Likhachev).
+// The search runs backwards from the goal, so when edge costs change or the agent moves
+// only the affected part of the search is repaired instead of planning from scratch.
+class GOAP_AI_DEMO_API FDStarLitePath
+{
+public:
+    FDStarLitePath(const FNodeGraph& InGraph, int32 InStart, int32 InGoal);
+
+    int32 GetStart() const { return Start; }
+    int32 GetGoal() const { return Goal; }
+
+    // False once the graph has been recompiled; indices no longer match and a new path is needed
+    bool IsValid() const { return bValid; }
+    void Invalidate() { bValid = false; }
+
+    // True when costs or the start changed since the last ComputeShortestPath
+    bool NeedsRepair() const { return bNeedsRepair; }
+
+    // Call as the agent reaches each node; keeps the search state
+    void UpdateStart(int32 NewStart);
+
+    // Costs of every edge entering Node changed (e.g. the node became dangerous)
+    void NotifyNodeCostChanged(int32 Node);
+
+    // Cost of one edge changed
+    void NotifyEdgeCostChanged(int32 Edge);
+
+    // Repairs the search. Returns false if the goal is unreachable or MaxExpansions ran out.
+    bool ComputeShortestPath(int32 MaxExpansions = MAX_int32);
+
+    // Next node to walk to from the start, or INDEX_NONE
+    int32 GetNextNode() const;
+
+    // Start-to-goal node sequence along the current solution
+    void GetPath(TArray<int32>& OutPath) const;
+
+    // Cost from the start to the goal; >= UE_MAX_FLT when unreachable
+    float GetPathCost() const { return G.IsValidIndex(Start) ? G[Start] : UE_MAX_FLT; }
+
+private:
+    struct FKey
+    {
+        float K1;
+        float K2;
+
+        bool operator<(const FKey& Other) const { return K1 < Other.K1 || (K1 == Other.K1 && K2 < Other.K2); }
+    };
+
+    struct FOpenEntry
+    {
+        FKey Key;
+        int32 Node;
+
+        bool operator<(const FOpenEntry& Other) const { return Key < Other.Key; }
+    };
+
+    FKey CalculateKey(int32 Node) const;
+    float Heuristic(int32 From, int32 To) const;
+    void UpdateVertex(int32 Node);
+
+    void InsertOpen(int32 Node, const FKey& Key);
+    void RemoveOpen(int32 Node) { InOpen[Node] = false; }
+
+    // Drops heap entries whose node was removed or re-keyed since they were pushed
+    void PruneOpen();
+
+    const FNodeGraph& Graph;
+    int32 Start;
+    int32 Goal;
+    int32 LastStart;
+    float KeyModifier = 0.f;
+    bool bValid = true;
+    bool bNeedsRepair = true;
+
+    TArray<float> G;
+    TArray<float> Rhs;
+
+    // Lazy-deletion priority queue; OpenKeys/InOpen hold the live entry per node
+    TArray<FOpenEntry> OpenHeap;
+    TArray<FKey> OpenKeys;
+    TBitArray<> InOpen;
+};
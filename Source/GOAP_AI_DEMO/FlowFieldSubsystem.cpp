@@ -0,0 +1,246 @@
+#include "FlowFieldSubsystem.h"
+#include "AIMemory.h"
+#include "GOAPStats.h"
+#include "NodeGraphSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<float> CVarFlowFieldBudgetMs(
+    TEXT("ai.FlowField.BudgetMs"),
+    0.5f,
+    TEXT("Game thread time per frame spent rebuilding flow fields, in milliseconds."));
+
+static TAutoConsoleVariable<float> CVarFlowFieldIdleTimeout(
+    TEXT("ai.FlowField.IdleTimeout"),
+    5.0f,
+    TEXT("Seconds a flow field is kept after the last agent sampled it."));
+
+namespace FlowField
+{
+    // Nodes settled between time checks
+    constexpr int32 ExpansionsPerStep = 256;
+
+    // The target's nearest node is only looked up again after it moved this far
+    constexpr float RelocateDistance = 50.f;
+}
+
+UFlowFieldSubsystem* UFlowFieldSubsystem::Get(const UWorld* World)
+{
+    return World ? World->GetSubsystem<UFlowFieldSubsystem>() : nullptr;
+}
+
+void UFlowFieldSubsystem::Deinitialize()
+{
+    Fields.Empty();
+    Super::Deinitialize();
+}
+
+void UFlowFieldSubsystem::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+    Super::GetResourceSizeEx(CumulativeResourceSize);
+
+    SIZE_T Bytes = Fields.GetAllocatedSize();
+    for (const FFlowField& Field : Fields)
+    {
+        Bytes += Field.Costs.GetAllocatedSize() + Field.NextNodes.GetAllocatedSize()
+            + Field.BuildCosts.GetAllocatedSize() + Field.BuildNextNodes.GetAllocatedSize() + Field.Open.GetAllocatedSize();
+    }
+    CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Bytes);
+}
+
+TStatId UFlowFieldSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UFlowFieldSubsystem, STATGROUP_Tickables);
+}
+
+UFlowFieldSubsystem::FFlowField* UFlowFieldSubsystem::FindField(const AActor* Target)
+{
+    return Fields.FindByPredicate([Target](const FFlowField& Field) { return Field.Target.Get() == Target; });
+}
+
+const UFlowFieldSubsystem::FFlowField* UFlowFieldSubsystem::FindField(const AActor* Target) const
+{
+    return Fields.FindByPredicate([Target](const FFlowField& Field) { return Field.Target.Get() == Target; });
+}
+
+bool UFlowFieldSubsystem::SampleNextHop(const AActor* Target, int32 FromNode, int32& OutNextNode)
+{
+    OutNextNode = INDEX_NONE;
+    if (!Target) return false;
+
+    FFlowField* Field = FindField(Target);
+    if (!Field)
+    {
+        // Built from the next Tick on
+        Field = &Fields.AddDefaulted_GetRef();
+        Field->Target = Target;
+    }
+    Field->LastSampleTime = GetWorld()->GetTimeSeconds();
+
+    const UNodeGraphSubsystem* GraphSubsystem = UNodeGraphSubsystem::Get(GetWorld());
+    if (!GraphSubsystem || Field->GraphVersion != GraphSubsystem->GetGraphVersion()) return false;
+    if (!Field->NextNodes.IsValidIndex(FromNode)) return false;
+
+    if (FromNode == Field->TargetNode) return true;
+
+    OutNextNode = Field->NextNodes[FromNode];
+    return OutNextNode != INDEX_NONE;
+}
+
+float UFlowFieldSubsystem::GetCostToTarget(const AActor* Target, int32 Node) const
+{
+    const FFlowField* Field = FindField(Target);
+    return Field && Field->Costs.IsValidIndex(Node) ? Field->Costs[Node] : UE_MAX_FLT;
+}
+
+void UFlowFieldSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+    LLM_SCOPE_BYTAG(AINodeGraph);
+    GOAPStats::FScopedSubsystemTimer Timer(EGOAPTimedSubsystem::FlowField);
+
+    if (Fields.Num() == 0) return;
+
+    UNodeGraphSubsystem* GraphSubsystem = UNodeGraphSubsystem::Get(GetWorld());
+    if (!GraphSubsystem) return;
+
+    const FNodeGraph& Graph = GraphSubsystem->GetGraph();
+    const uint32 GraphVersion = GraphSubsystem->GetGraphVersion();
+
+    // Fields nobody samples any more, or whose target is gone, are dropped
+    const double Now = GetWorld()->GetTimeSeconds();
+    const double IdleTimeout = CVarFlowFieldIdleTimeout.GetValueOnGameThread();
+    Fields.RemoveAll([Now, IdleTimeout](const FFlowField& Field)
+    {
+        return !Field.Target.IsValid() || Now - Field.LastSampleTime > IdleTimeout;
+    });
+
+    for (FFlowField& Field : Fields)
+    {
+        if (Field.GraphVersion != GraphVersion)
+        {
+            // Node indices changed; start over
+            Field.GraphVersion = GraphVersion;
+            Field.TargetNode = INDEX_NONE;
+            Field.Costs.Reset();
+            Field.NextNodes.Reset();
+            Field.bBuilding = false;
+            Field.CurrentTargetNode = INDEX_NONE;
+            Field.LastTargetLocation = FVector(UE_BIG_NUMBER);
+        }
+        UpdateTargetNode(Field, Graph);
+    }
+
+    // Round-robin over the sweeps in progress until the budget runs out
+    const double EndTime = FPlatformTime::Seconds() + CVarFlowFieldBudgetMs.GetValueOnGameThread() / 1000.0;
+    bool bAnyWork = true;
+    while (bAnyWork && FPlatformTime::Seconds() < EndTime)
+    {
+        bAnyWork = false;
+        for (int32 Offset = 0; Offset < Fields.Num(); ++Offset)
+        {
+            FFlowField& Field = Fields[(RoundRobinStart + Offset) % Fields.Num()];
+            if (!Field.bBuilding) continue;
+
+            AdvanceSweep(Field, Graph, FlowField::ExpansionsPerStep);
+            bAnyWork = true;
+            if (FPlatformTime::Seconds() >= EndTime) break;
+        }
+    }
+    RoundRobinStart = Fields.Num() > 0 ? (RoundRobinStart + 1) % Fields.Num() : 0;
+}
+
+void UFlowFieldSubsystem::UpdateTargetNode(FFlowField& Field, const FNodeGraph& Graph)
+{
+    const AActor* Target = Field.Target.Get();
+    if (!Target) return;
+
+    const FVector Location = Target->GetActorLocation();
+    if (FVector::DistSquared(Location, Field.LastTargetLocation) > FMath::Square(FlowField::RelocateDistance))
+    {
+        Field.LastTargetLocation = Location;
+        Field.CurrentTargetNode = Graph.FindNearestNode(Location);
+    }
+
+    const int32 WantedNode = Field.CurrentTargetNode;
+    if (WantedNode == INDEX_NONE) return;
+    if (Field.bBuilding ? Field.BuildTargetNode == WantedNode : Field.TargetNode == WantedNode) return;
+
+    // Cost of the link the target stepped across, if it moved to a neighbour of the published node
+    float StepCost = UE_MAX_FLT;
+    if (Graph.IsValidNode(Field.TargetNode) && Field.Costs.Num() == Graph.NumNodes())
+    {
+        for (int32 Edge = Graph.EdgeBegin(Field.TargetNode); Edge < Graph.EdgeEnd(Field.TargetNode); ++Edge)
+        {
+            if (Graph.GetEdgeTarget(Edge) == WantedNode)
+            {
+                StepCost = Graph.GetEdgeCost(Edge);
+                break;
+            }
+        }
+    }
+
+    // A sweep for an older target node is simply restarted
+    Field.bBuilding = true;
+    Field.BuildTargetNode = WantedNode;
+    Field.Open.Reset();
+    if (StepCost < UE_MAX_FLT)
+    {
+        // Every route to the old node plus that link still reaches the new one. Seeded with those costs,
+        // the sweep only settles the nodes that got closer; the rest keep their old next hop.
+        Field.BuildCosts.SetNumUninitialized(Graph.NumNodes());
+        for (int32 Node = 0; Node < Graph.NumNodes(); ++Node)
+        {
+            Field.BuildCosts[Node] = Field.Costs[Node] < UE_MAX_FLT ? Field.Costs[Node] + StepCost : UE_MAX_FLT;
+        }
+        Field.BuildNextNodes = Field.NextNodes;
+        Field.BuildNextNodes[Field.TargetNode] = WantedNode;
+    }
+    else
+    {
+        Field.BuildCosts.Init(UE_MAX_FLT, Graph.NumNodes());
+        Field.BuildNextNodes.Init(INDEX_NONE, Graph.NumNodes());
+    }
+    Field.BuildCosts[WantedNode] = 0.f;
+    Field.BuildNextNodes[WantedNode] = INDEX_NONE;
+    Field.Open.HeapPush({ 0.f, WantedNode });
+}
+
+bool UFlowFieldSubsystem::AdvanceSweep(FFlowField& Field, const FNodeGraph& Graph, int32 MaxExpansions)
+{
+    int32 Expansions = 0;
+    while (Field.Open.Num() > 0)
+    {
+        if (Expansions++ >= MaxExpansions)
+        {
+            return false;
+        }
+
+        FOpenEntry Entry;
+        Field.Open.HeapPop(Entry, EAllowShrinking::No);
+
+        // Skip stale heap entries
+        if (Entry.Cost > Field.BuildCosts[Entry.Node]) continue;
+
+        // Walk links backwards: a predecessor's next hop is the node it links into
+        for (int32 I = Graph.InEdgeBegin(Entry.Node); I < Graph.InEdgeEnd(Entry.Node); ++I)
+        {
+            const int32 Edge = Graph.GetInEdge(I);
+            const int32 Source = Graph.GetEdgeSource(Edge);
+            const float NewCost = Entry.Cost + Graph.GetEdgeCost(Edge);
+            if (NewCost < Field.BuildCosts[Source])
+            {
+                Field.BuildCosts[Source] = NewCost;
+                Field.BuildNextNodes[Source] = Entry.Node;
+                Field.Open.HeapPush({ NewCost, Source });
+            }
+        }
+    }
+
+    // Publish; the old arrays are reused by the next sweep
+    Swap(Field.Costs, Field.BuildCosts);
+    Swap(Field.NextNodes, Field.BuildNextNodes);
+    Field.TargetNode = Field.BuildTargetNode;
+    Field.bBuilding = false;
+    return true;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FlowFieldSubsystem.generated.h"
+
+struct FNodeGraph;
+
+// Flow fields over the compiled node graph, one per chased target.
+// A field stores, for every node, the next node on the cheapest route to the node nearest the target.
+// It is built with one backwards Dijkstra sweep over incoming links, so any number of agents chasing
+// the same target share it and sample their next hop in O(1).
+// When the target reaches a different node the sweep is redone into a back buffer under a per-frame
+// time budget; agents keep sampling the previous field until the new one is swapped in. A target that
+// stepped to a linked node only costs a sweep over the nodes it came closer to.
+UCLASS()
+class GOAP_AI_DEMO_API UFlowFieldSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static UFlowFieldSubsystem* Get(const UWorld* World);
+
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    virtual void Deinitialize() override;
+    virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+    // Next node to walk to from FromNode toward Target. Creates the field on first use.
+    // Returns false while the field is being built or if FromNode cannot reach the target.
+    // OutNextNode is INDEX_NONE when FromNode is already the target's node; walk to the target itself.
+    bool SampleNextHop(const AActor* Target, int32 FromNode, int32& OutNextNode);
+
+    // Cost from Node to the target's node, or UE_MAX_FLT if unknown
+    float GetCostToTarget(const AActor* Target, int32 Node) const;
+
+    int32 GetNumFields() const { return Fields.Num(); }
+
+private:
+    struct FOpenEntry
+    {
+        float Cost;
+        int32 Node;
+        bool operator<(const FOpenEntry& Other) const { return Cost < Other.Cost; }
+    };
+
+    struct FFlowField
+    {
+        TWeakObjectPtr<const AActor> Target;
+        double LastSampleTime = 0.0;
+
+        // Where the target was when its node was last looked up
+        FVector LastTargetLocation = FVector(UE_BIG_NUMBER);
+        int32 CurrentTargetNode = INDEX_NONE;
+
+        // Published field
+        int32 TargetNode = INDEX_NONE;
+        uint32 GraphVersion = 0;
+        TArray<float> Costs;
+        TArray<int32> NextNodes;
+
+        // Sweep in progress, swapped into the published arrays when the open list runs dry
+        bool bBuilding = false;
+        int32 BuildTargetNode = INDEX_NONE;
+        TArray<float> BuildCosts;
+        TArray<int32> BuildNextNodes;
+        TArray<FOpenEntry> Open;
+    };
+
+    FFlowField* FindField(const AActor* Target);
+    const FFlowField* FindField(const AActor* Target) const;
+
+    // Starts a sweep toward the target's current node if it differs from the one published or being built
+    void UpdateTargetNode(FFlowField& Field, const FNodeGraph& Graph);
+
+    // Settles up to MaxExpansions nodes; returns true when the sweep finished
+    bool AdvanceSweep(FFlowField& Field, const FNodeGraph& Graph, int32 MaxExpansions);
+
+    TArray<FFlowField> Fields;
+    int32 RoundRobinStart = 0;
+};
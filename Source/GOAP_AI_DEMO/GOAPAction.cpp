@@ -18,3 +18,16 @@ void UGOAPAction::PerformAction()
     // Base class does nothing.
     // Child classes will override this.
 }
+
+bool UGOAPAction::ContinueAfterMove(const FPathFollowingResult& /*Result*/)
+{
+    // Most actions are done once their one move ends
+    return false;
+}
+
+void UGOAPAction::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+    Super::GetResourceSizeEx(CumulativeResourceSize);
+
+    CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Preconditions.GetAllocatedSize() + Effects.GetAllocatedSize());
+}
@@ -5,6 +5,16 @@
 #include "GOAPTypes.h"
 #include "GOAPAction.generated.h"
 
+struct FPathFollowingResult;
+
+// How a Mass crowd agent carries out an action; full actors always call PerformAction
+UENUM(BlueprintType)
+enum class EGOAPCrowdBehavior : uint8
+{
+    Instant     UMETA(DisplayName = "Instant"),    // Effects apply as soon as the action starts
+    Patrol      UMETA(DisplayName = "Patrol")      // Walks to the next node of the patrol route
+};
+
 UCLASS(Blueprintable)
 class GOAP_AI_DEMO_API UGOAPAction : public UObject
 {
@@ -25,6 +35,10 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GOAP")
     float Cost = 1.0f;
 
+    // What this action does when run by a background crowd agent
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GOAP")
+    EGOAPCrowdBehavior CrowdBehavior = EGOAPCrowdBehavior::Instant;
+
     // Optional check (e.g. is enemy in sight?)
     UFUNCTION(BlueprintCallable, Category = "GOAP")
     virtual bool CheckProceduralPrecondition(const TMap<FName, bool>& WorldState) const;
@@ -32,4 +46,10 @@ public:
     // The actual behavior to perform (to override in subclasses)
     UFUNCTION(BlueprintCallable, Category = "GOAP")
     virtual void PerformAction();
+
+    // A move this action started has finished. Return true if the action carried on with another move;
+    // false hands movement back to the character (e.g. its patrol).
+    virtual bool ContinueAfterMove(const FPathFollowingResult& Result);
+
+    virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
 };
@@ -1,16 +1,62 @@
 #include "GOAPAgentComponent.h"
+#include "AIMemory.h"
+#include "GOAPPlannerSubsystem.h"
+#include "GOAPSquadSubsystem.h"
+#include "GOAPStats.h"
+#include "HAL/IConsoleManager.h"
+#include "Algo/AllOf.h"
+
+static TAutoConsoleVariable<int32> CVarGOAPAnytime(
+    TEXT("ai.GOAP.Anytime"),
+    0,
+    TEXT("Agents plan alone with the bounded-memory anytime planner instead of plain A*."));
+
+static TAutoConsoleVariable<int32> CVarGOAPAnytimeMaxNodes(
+    TEXT("ai.GOAP.Anytime.MaxNodes"),
+    1024,
+    TEXT("States an anytime search may hold at once; its memory is reserved up front and never grows past this."));
+
+static TAutoConsoleVariable<int32> CVarGOAPAnytimeExpansionsPerTick(
+    TEXT("ai.GOAP.Anytime.ExpansionsPerTick"),
+    128,
+    TEXT("States an agent's anytime search expands per tick, when the agent sets no MaxPlanExpansions."));
+
+static TAutoConsoleVariable<int32> CVarGOAPAnytimeMaxTicks(
+    TEXT("ai.GOAP.Anytime.MaxTicks"),
+    4,
+    TEXT("Ticks an agent keeps improving its plan before acting on the best one found. A search with no plan yet carries on until it finds one or gives up.\n")
+    TEXT("Once the agent acts, the search carries on alongside and swaps in any cheaper plan it finds."));
+
+namespace GOAPAgent
+{
+    // Doublings of a capped search's limit before the cap is dropped altogether
+    constexpr int32 MaxCapDoublings = 6;
+
+    float GetPlanCost(const FGOAPDomain& Domain, TConstArrayView<int32> Steps)
+    {
+        float Cost = 0.f;
+        for (const int32 Step : Steps)
+        {
+            Cost += Domain.Actions[Step].Cost;
+        }
+        return Cost;
+    }
+}
 
 // Constructor
 UGOAPAgentComponent::UGOAPAgentComponent()
 {
     // Enable ticking for this component
     PrimaryComponentTick.bCanEverTick = true;
+
+    CurrentGoal.DesiredStates.Add(FGOAPState("EnemyCaught", true));
 }
 
 // Called when the game starts
 void UGOAPAgentComponent::BeginPlay()
 {
     Super::BeginPlay();
+    LLM_SCOPE_BYTAG(AIGOAP);
 
 
     // Create instances of all available action classes
@@ -23,10 +69,43 @@ void UGOAPAgentComponent::BeginPlay()
         }
     }
 
+    // Compiled in the same order, skipping the same null entries
+    if (UGOAPPlannerSubsystem* PlannerSubsystem = UGOAPPlannerSubsystem::Get(GetWorld()))
+    {
+        Domain = PlannerSubsystem->GetDomain(AvailableActionTypes);
+    }
+
+    if (UGOAPSquadSubsystem* Squads = UGOAPSquadSubsystem::Get(GetWorld()))
+    {
+        Squads->RegisterMember(this);
+    }
+    GOAPStats::AddAgent();
+
     // Try building a plan toward the current goal
     BuildPlan();
 }
 
+void UGOAPAgentComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UGOAPSquadSubsystem* Squads = UGOAPSquadSubsystem::Get(GetWorld()))
+    {
+        Squads->UnregisterMember(this);
+    }
+    GOAPStats::RemoveAgent();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void UGOAPAgentComponent::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+    Super::GetResourceSizeEx(CumulativeResourceSize);
+
+    // Action instances are separate objects and are measured on their own
+    CumulativeResourceSize.AddDedicatedSystemMemoryBytes(AvailableActionTypes.GetAllocatedSize() + ActionInstances.GetAllocatedSize()
+        + CurrentPlan.GetAllocatedSize() + WorldState.GetAllocatedSize() + CurrentGoal.DesiredStates.GetAllocatedSize()
+        + AnytimePlanner.GetAllocatedSize());
+}
+
 // Called every frame
 void UGOAPAgentComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
@@ -49,11 +128,24 @@ void UGOAPAgentComponent::TickComponent(float DeltaTime, ELevelTick TickType, FA
         UE_LOG(LogTemp, Warning, TEXT("AI_Character has reached its GOAP goal state(s)!"));
         return;
     }
+    GOAPStats::RecordAgentAwake();
 
-    // 2. If no plan exists, try to build one
+    // 2. If no plan exists, try to build one, or keep searching for it. An anytime search whose plan
+    // the agent is already acting on keeps looking for a cheaper one.
     if (CurrentPlan.Num() == 0)
     {
-        BuildPlan();
+        if (AnytimePlanner.IsActive() && !bAnytimePlanAdopted)
+        {
+            ContinueAnytimePlan();
+        }
+        else
+        {
+            BuildPlan();
+        }
+    }
+    else if (AnytimePlanner.IsActive())
+    {
+        ContinueAnytimePlan();
     }
 
     // 3. If a plan exists, execute the next action in the sequence
@@ -66,73 +158,264 @@ void UGOAPAgentComponent::TickComponent(float DeltaTime, ELevelTick TickType, FA
 // Attempts to create a plan from current world state to desired goal
 void UGOAPAgentComponent::BuildPlan()
 {
+    LLM_SCOPE_BYTAG(AIGOAP);
+
     CurrentPlan.Empty();  // Clear any previous plan
+    PlanMonitor.Reset();
+    PlanSharedState = FGOAPWorldState();
+    EndAnytimeSearch();
 
-    TArray<UGOAPAction*> OpenActions;
-    TMap<FName, bool> SimulatedState = WorldState;
+    if (bPerceptionReplan)
+    {
+        GOAPStats::RecordPerceptionReplan();
+        bPerceptionReplan = false;
+    }
+
+    // Squad members get their part of the squad's plan instead of searching alone
+    UGOAPSquadSubsystem* Squads = UGOAPSquadSubsystem::Get(GetWorld());
+    if (Squads && Squads->RequestPlan(this)) return;
 
-    // Step 1: Find actions whose preconditions match the simulated state
-    for (UGOAPAction* Action : ActionInstances)
+    UGOAPPlannerSubsystem* PlannerSubsystem = UGOAPPlannerSubsystem::Get(GetWorld());
+    if (!Domain || !PlannerSubsystem)
     {
-        if (Action && Action->CheckProceduralPrecondition(SimulatedState))
-        {
-            bool bMatches = true;
+        BuildFallbackPlan();
+        return;
+    }
 
-            // Check all preconditions
-            for (const FGOAPState& Pre : Action->Preconditions)
-            {
-                if (!SimulatedState.Contains(Pre.Key) || SimulatedState[Pre.Key] != Pre.Value)
-                {
-                    bMatches = false;
-                    break;
-                }
-            }
+    FGOAPWorldState Goal;
+    if (!Domain->MakeGoal(CurrentGoal, WorldState, Goal))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Goal needs a fact no action can change; falling back to the actions usable now."));
+        BuildFallbackPlan();
+        return;
+    }
 
-            // Add valid actions to the open set
-            if (bMatches)
-            {
-                OpenActions.Add(Action);
-            }
-        }
+    // Procedural preconditions are checked once, against the current world state
+    TBitArray<> AllowedActions(false, ActionInstances.Num());
+    for (int32 Index = 0; Index < ActionInstances.Num(); ++Index)
+    {
+        AllowedActions[Index] = ActionInstances[Index] && ActionInstances[Index]->CheckProceduralPrecondition(WorldState);
     }
 
-    // Step 2: Simulate applying action effects to reach the goal
-    for (UGOAPAction* Action : OpenActions)
+    if (CVarGOAPAnytime.GetValueOnGameThread())
     {
-        // Apply each effect to the simulated state
-        for (const FGOAPState& Effect : Action->Effects)
+        AnytimePlanner.Begin(*Domain, Domain->MakeState(WorldState), Goal, &AllowedActions, CVarGOAPAnytimeMaxNodes.GetValueOnGameThread());
+        AnytimeGoal = Goal;
+        AnytimeTicks = 0;
+        bAnytimePlanAdopted = false;
+        ContinueAnytimePlan();
+        return;
+    }
+
+    // Search the compiled domain; action indices match ActionInstances
+    TArray<int32> Plan;
+    const bool bFoundPlan = PlannerSubsystem->FindPlan(*Domain, Domain->MakeState(WorldState), Goal, GetPlanExpansionLimit(), &AllowedActions, Plan);
+    RecordPlanSearch(bFoundPlan, PlannerSubsystem->WasLastSearchCutShort());
+    if (bFoundPlan)
+    {
+        SetPlan(Plan, &Goal);
+    }
+    else
+    {
+        BuildFallbackPlan();
+    }
+
+    // Debug log: print number of actions in the plan
+    UE_LOG(LogTemp, Warning, TEXT("Plan built with %d actions."), CurrentPlan.Num());
+}
+
+void UGOAPAgentComponent::ContinueAnytimePlan()
+{
+    LLM_SCOPE_BYTAG(AIGOAP);
+
+    // MaxPlanExpansions, lowered for distant agents, becomes the per-tick share
+    const int32 Budget = MaxPlanExpansions > 0 ? MaxPlanExpansions : FMath::Max(CVarGOAPAnytimeExpansionsPerTick.GetValueOnGameThread(), 1);
+    const bool bFinished = AnytimePlanner.Step(Budget) == FGOAPAnytimePlanner::EStatus::Finished;
+    const bool bOutOfTicks = ++AnytimeTicks >= CVarGOAPAnytimeMaxTicks.GetValueOnGameThread();
+
+    if (bAnytimePlanAdopted)
+    {
+        if (AnytimePlanner.GetPlanCost() < AnytimePlanCost)
         {
-            SimulatedState.Add(Effect.Key, Effect.Value);
+            SwapInAnytimePlan();
+        }
+        if (bFinished)
+        {
+            EndAnytimeSearch();
         }
+        return;
+    }
+
+    // Dropping a search before its first plan would restart it from scratch, and large domains would never get one
+    if (!bFinished && (!bOutOfTicks || !AnytimePlanner.HasPlan())) return;
+
+    if (AnytimePlanner.HasPlan())
+    {
+        SetPlan(AnytimePlanner.GetPlan(), &AnytimeGoal);
+        AnytimePlanCost = AnytimePlanner.GetPlanCost();
+        bAnytimePlanAdopted = true;
+    }
+    else
+    {
+        BuildFallbackPlan();
+    }
+
+    // An unfinished search keeps going while the agent acts on its plan
+    if (bFinished)
+    {
+        EndAnytimeSearch();
+    }
+}
+
+void UGOAPAgentComponent::SwapInAnytimePlan()
+{
+    const TArray<int32>& Plan = AnytimePlanner.GetPlan();
+    AnytimePlanCost = AnytimePlanner.GetPlanCost();
+
+    // The new plan starts where the search did; pick it up from the furthest step the agent's state allows
+    FGOAPPlanMonitor Monitor;
+    Monitor.Build(*Domain, Plan, AnytimeGoal);
+    const int32 ResumeStep = Monitor.FindResumeStep(Domain->MakeState(WorldState), 0);
+    if (ResumeStep == INDEX_NONE) return;
+
+    TArray<int32> CurrentSteps;
+    for (const UGOAPAction* Action : CurrentPlan)
+    {
+        CurrentSteps.Add(ActionInstances.IndexOfByKey(Action));
+    }
+
+    const TConstArrayView<int32> Remaining = MakeArrayView(Plan).RightChop(ResumeStep);
+    if (GOAPAgent::GetPlanCost(*Domain, Remaining) < GOAPAgent::GetPlanCost(*Domain, CurrentSteps))
+    {
+        SetPlan(Remaining, &AnytimeGoal);
+    }
+}
+
+void UGOAPAgentComponent::EndAnytimeSearch()
+{
+    if (!AnytimePlanner.IsActive()) return;
+
+    GOAPStats::RecordSearch(AnytimePlanner.GetTotalExpansions(), AnytimePlanner.GetTotalCycles());
+    AnytimePlanner.Reset();
+    bAnytimePlanAdopted = false;
+}
+
+int32 UGOAPAgentComponent::GetPlanExpansionLimit() const
+{
+    if (MaxPlanExpansions <= 0 || CappedSearches >= GOAPAgent::MaxCapDoublings) return 0;
+    return MaxPlanExpansions << CappedSearches;
+}
+
+void UGOAPAgentComponent::RecordPlanSearch(bool bFoundPlan, bool bCutShort)
+{
+    if (bFoundPlan)
+    {
+        CappedSearches = 0;
+    }
+    else if (bCutShort)
+    {
+        // Retrying with the same cap would fail every tick for a plan deeper than it allows
+        ++CappedSearches;
+    }
+}
+
+void UGOAPAgentComponent::BuildFallbackPlan()
+{
+    TMap<FName, bool> SimulatedState = WorldState;
+    auto Holds = [&SimulatedState](const TArray<FGOAPState>& States)
+    {
+        return Algo::AllOf(States, [&SimulatedState](const FGOAPState& State)
+        {
+            const bool* Value = SimulatedState.Find(State.Key);
+            return Value && *Value == State.Value;
+        });
+    };
 
-        // Add action to the current plan
-        CurrentPlan.Add(Action);
+    // Only actions usable in the state the agent is really in; their effects are not chained
+    TArray<int32> Steps;
+    for (int32 Index = 0; Index < ActionInstances.Num(); ++Index)
+    {
+        const UGOAPAction* Action = ActionInstances[Index];
+        if (Action && Action->CheckProceduralPrecondition(WorldState) && Holds(Action->Preconditions))
+        {
+            Steps.Add(Index);
+        }
+    }
 
-        // Check if goal is achieved in the simulated state
-        bool bGoalMet = true;
-        for (const FGOAPState& GoalState : CurrentGoal.DesiredStates)
+    for (int32 Count = 0; Count < Steps.Num(); ++Count)
+    {
+        for (const FGOAPState& Effect : ActionInstances[Steps[Count]]->Effects)
         {
-            if (!SimulatedState.Contains(GoalState.Key) || SimulatedState[GoalState.Key] != GoalState.Value)
-            {
-                bGoalMet = false;
-                break;
-            }
+            SimulatedState.Add(Effect.Key, Effect.Value);
         }
 
-        // Stop planning if goal is reached
-        if (bGoalMet)
+        if (Holds(CurrentGoal.DesiredStates))
         {
+            Steps.SetNum(Count + 1);
             break;
         }
     }
 
-    // Debug log: print number of actions in the plan
-    UE_LOG(LogTemp, Warning, TEXT("Plan built with %d actions."), CurrentPlan.Num());
+    // Not a plan for the goal, so there is nothing to monitor it against
+    SetPlan(Steps, nullptr);
+}
+
+bool UGOAPAgentComponent::HandleMoveCompleted(const FPathFollowingResult& Result)
+{
+    if (MovingAction && MovingAction->ContinueAfterMove(Result)) return true;
+
+    MovingAction = nullptr;
+    return false;
+}
+
+void UGOAPAgentComponent::InvalidatePlan(bool bFromPerception)
+{
+    CurrentPlan.Empty();
+    PlanMonitor.Reset();
+    PlanSharedState = FGOAPWorldState();
+    EndAnytimeSearch();
+    bPerceptionReplan |= bFromPerception;
+}
+
+void UGOAPAgentComponent::SetPlan(TConstArrayView<int32> Steps, const FGOAPWorldState* Goal, const FGOAPWorldState* SharedState)
+{
+    CurrentPlan.Reset();
+    for (const int32 ActionIndex : Steps)
+    {
+        CurrentPlan.Add(ActionInstances[ActionIndex]);
+    }
+
+    PlanMonitor.Reset();
+    PlanSharedState = SharedState ? *SharedState : FGOAPWorldState();
+    if (Domain && Goal)
+    {
+        PlanMonitor.Build(*Domain, Steps, *Goal);
+    }
 }
 
 // Executes the next action in the plan
 void UGOAPAgentComponent::ExecutePlan()
 {
+    LLM_SCOPE_BYTAG(AIGOAP);
+
+    // Skip steps the world has already done for us, or drop a plan none of whose steps can still reach the goal
+    if (Domain && PlanMonitor.IsValid() && CurrentPlan.Num() <= PlanMonitor.NumSteps())
+    {
+        // Merged the way the squad merges its members: known if either knows it, true if either has it true
+        FGOAPWorldState State = Domain->MakeState(WorldState);
+        State.Known |= PlanSharedState.Known;
+        State.Values |= PlanSharedState.Values & PlanSharedState.Known;
+
+        const int32 FirstStep = PlanMonitor.NumSteps() - CurrentPlan.Num();
+        const int32 ResumeStep = PlanMonitor.FindResumeStep(State, FirstStep);
+        if (ResumeStep == INDEX_NONE)
+        {
+            InvalidatePlan();
+            return;
+        }
+        CurrentPlan.RemoveAt(0, ResumeStep - FirstStep, EAllowShrinking::No);
+    }
+
     if (CurrentPlan.Num() > 0)
     {
         // Get and remove the next action
@@ -143,11 +426,16 @@ void UGOAPAgentComponent::ExecutePlan()
         {
             // Perform the action behavior
             NextAction->PerformAction();
+            MovingAction = NextAction;
+            GOAPStats::RecordActionExecuted();
 
-            // Apply action's effects to the actual world state
+            // Apply action's effects to the actual world state; perception reports the sensed facts itself
             for (const FGOAPState& Effect : NextAction->Effects)
             {
-                WorldState.Add(Effect.Key, Effect.Value);
+                if (!SensedFacts.Contains(Effect.Key))
+                {
+                    WorldState.Add(Effect.Key, Effect.Value);
+                }
             }
         }
     }
@@ -4,6 +4,7 @@
 #include "Components/ActorComponent.h"
 #include "GOAPTypes.h"
 #include "GOAPAction.h"
+#include "GOAPPlanner.h"
 #include "GOAPAgentComponent.generated.h"
 
 UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
@@ -30,19 +31,97 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GOAP")
     TMap<FName, bool> WorldState;
 
-    // Desired goal state
+    // Desired goal state; catching the enemy by default
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GOAP")
     FGOAPGoal CurrentGoal;
 
+    // Facts only perception sets. Action effects on them are what the planner expects to happen
+    // (patrolling until the enemy shows up), so they are not written to WorldState when the action runs.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GOAP")
+    TArray<FName> SensedFacts = { TEXT("EnemyVisible") };
+
+    // Agents with the same squad name plan together through UGOAPSquadSubsystem; None plans alone
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GOAP")
+    FName SquadName;
+
+    // States one BuildPlan search may expand before it gives up; 0 means no limit. Lowered for distant agents.
+    // Each search cut short by it doubles the next one's limit, until a plan is found or the limit is lifted.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GOAP")
+    int32 MaxPlanExpansions = 0;
+
     // Called on BeginPlay
     virtual void BeginPlay() override;
 
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
     // Called every frame
     virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
-    // Starts building a plan
+    // Starts building a plan. With ai.GOAP.Anytime the search may carry on over the next few ticks.
     void BuildPlan();
 
     // Executes the next action in the current plan
     void ExecutePlan();
+
+    // Lets the last action performed carry on after its move finished; false if it is done moving
+    bool HandleMoveCompleted(const FPathFollowingResult& Result);
+
+    // Used when no plan reaches the goal: every action usable right now, in order, until their effects
+    // would reach it. Keeps an agent patrolling towards a goal it cannot plan for yet.
+    void BuildFallbackPlan();
+
+    // Drops the current plan so the next tick builds a new one
+    void InvalidatePlan(bool bFromPerception = false);
+
+    // Replaces the current plan with Steps, indices into ActionInstances. With a Goal, its regression
+    // conditions are built too, and ExecutePlan uses them to skip steps or drop the plan as the world state changes.
+    // SharedState, for plans made from what a whole squad knows, is merged into the agent's own state for those checks.
+    void SetPlan(TConstArrayView<int32> Steps, const FGOAPWorldState* Goal, const FGOAPWorldState* SharedState = nullptr);
+
+    // MaxPlanExpansions scaled up by searches cut short in a row; 0 once it has doubled MaxCapDoublings times
+    int32 GetPlanExpansionLimit() const;
+
+    // Feeds the outcome of a search run with GetPlanExpansionLimit back into the next limit
+    void RecordPlanSearch(bool bFoundPlan, bool bCutShort);
+
+    // Action set the planner searches, shared with other agents using the same actions
+    TSharedPtr<const FGOAPDomain> Domain;
+
+private:
+    // The next BuildPlan counts as a perception replan
+    bool bPerceptionReplan = false;
+
+    // Regression conditions of the plan CurrentPlan is the unexecuted tail of
+    FGOAPPlanMonitor PlanMonitor;
+
+    // Last action performed, while the moves it started may still be running
+    UPROPERTY()
+    UGOAPAction* MovingAction = nullptr;
+
+    // Squad state the current plan was made from; empty for plans made alone
+    FGOAPWorldState PlanSharedState;
+
+    // Searches in a row that ran out of expansions; each one doubles the next limit
+    int32 CappedSearches = 0;
+
+    // Runs one tick's share of the anytime search; adopts its best plan once the search is done, or once
+    // ai.GOAP.Anytime.MaxTicks is up and it has a plan. After that it swaps in cheaper plans as the search finds them.
+    void ContinueAnytimePlan();
+
+    // Replaces the current plan with the search's better one, if what is left of it costs less than what is left of the current one
+    void SwapInAnytimePlan();
+
+    // Counts the search's work and frees it
+    void EndAnytimeSearch();
+
+    // Anytime search in progress, while the agent waits without a plan or acts on the best one so far
+    FGOAPAnytimePlanner AnytimePlanner;
+    FGOAPWorldState AnytimeGoal;
+    int32 AnytimeTicks = 0;
+
+    // The agent acts on the search's plan, which cost AnytimePlanCost from where the search started
+    bool bAnytimePlanAdopted = false;
+    float AnytimePlanCost = 0.f;
 };
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "GOAPPlanner.h"
+#include "GOAPCrowdFragments.generated.h"
+
+class ANode;
+class AAI_Character;
+
+// Longest plan a crowd agent keeps; longer plans are cut and replanned when they run out
+constexpr int32 GOAPCrowdMaxPlanLength = 8;
+
+USTRUCT()
+struct FGOAPCrowdAgentTag : public FMassTag
+{
+    GENERATED_BODY()
+};
+
+USTRUCT()
+struct FGOAPWorldStateFragment : public FMassFragment
+{
+    GENERATED_BODY()
+
+    FGOAPWorldState State;
+};
+
+USTRUCT()
+struct FGOAPPlanFragment : public FMassFragment
+{
+    GENERATED_BODY()
+
+    // Indices into the domain's actions; wide enough for domains past 256 actions
+    uint16 Actions[GOAPCrowdMaxPlanLength] = {};
+    uint8 NumActions = 0;
+    uint8 CurrentStep = 0;
+
+    // The current step has been started and waits on movement
+    bool bStepStarted = false;
+
+    // World time before which a failed search is not retried
+    float NextPlanTime = 0.f;
+
+    bool IsDone() const { return CurrentStep >= NumActions; }
+};
+
+USTRUCT()
+struct FGOAPPatrolFragment : public FMassFragment
+{
+    GENERATED_BODY()
+
+    // Index into the shared route of the node walked to next
+    int32 PatrolIndex = 0;
+
+    // Walking to the PatrolIndex node; cleared on arrival
+    bool bMoving = false;
+};
+
+// Everything crowd agents spawned together share: the action domain, goal and patrol route
+USTRUCT()
+struct FGOAPCrowdSharedFragment : public FMassConstSharedFragment
+{
+    GENERATED_BODY()
+
+    // Distinguishes domains when shared fragments are deduplicated; Domain itself is not hashed
+    UPROPERTY()
+    int32 DomainId = INDEX_NONE;
+
+    TSharedPtr<const FGOAPDomain> Domain;
+
+    UPROPERTY()
+    uint64 GoalKnown = 0;
+
+    UPROPERTY()
+    uint64 GoalValues = 0;
+
+    // Patrol route as node actors, handed to promoted actors, and as locations, walked by crowd movement
+    UPROPERTY()
+    TArray<TObjectPtr<ANode>> Route;
+
+    UPROPERTY()
+    TArray<FVector> RouteLocations;
+
+    UPROPERTY()
+    float MoveSpeed = 300.f;
+
+    // Class spawned when an agent is promoted near a player
+    UPROPERTY()
+    TSubclassOf<AAI_Character> ActorClass;
+
+    FGOAPWorldState GetGoal() const { return { GoalKnown, GoalValues }; }
+};
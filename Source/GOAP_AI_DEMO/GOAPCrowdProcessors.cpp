@@ -0,0 +1,276 @@
+#include "GOAPCrowdProcessors.h"
+#include "GOAPCrowdFragments.h"
+#include "GOAPCrowdSubsystem.h"
+#include "MassCommonFragments.h"
+#include "MassExecutionContext.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarCrowdMaxPlansPerFrame(
+    TEXT("ai.GOAPCrowd.MaxPlansPerFrame"),
+    256,
+    TEXT("Maximum plans built for crowd agents per frame; the rest wait for the next frame."));
+
+static TAutoConsoleVariable<int32> CVarCrowdMaxExpansions(
+    TEXT("ai.GOAPCrowd.MaxExpansions"),
+    64,
+    TEXT("States a crowd agent's plan search may expand before giving up."));
+
+namespace GOAPCrowd
+{
+    const FName ProcessorGroup(TEXT("GOAPCrowd"));
+
+    // Seconds before an agent whose search failed tries again
+    constexpr float PlanRetryDelay = 1.f;
+}
+
+//----------------------------------------------------------------------//
+// Planning
+//----------------------------------------------------------------------//
+
+UGOAPCrowdPlanningProcessor::UGOAPCrowdPlanningProcessor()
+    : EntityQuery(*this)
+{
+    ExecutionFlags = (int32)EProcessorExecutionFlags::All;
+    ExecutionOrder.ExecuteInGroup = GOAPCrowd::ProcessorGroup;
+}
+
+void UGOAPCrowdPlanningProcessor::ConfigureQueries()
+{
+    EntityQuery.AddRequirement<FGOAPWorldStateFragment>(EMassFragmentAccess::ReadOnly);
+    EntityQuery.AddRequirement<FGOAPPlanFragment>(EMassFragmentAccess::ReadWrite);
+    EntityQuery.AddConstSharedRequirement<FGOAPCrowdSharedFragment>();
+    EntityQuery.AddTagRequirement<FGOAPCrowdAgentTag>(EMassFragmentPresence::All);
+}
+
+void UGOAPCrowdPlanningProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+    // Mass may run processors off the game thread
+    int32 PlansLeft = CVarCrowdMaxPlansPerFrame.GetValueOnAnyThread();
+    const int32 MaxExpansions = CVarCrowdMaxExpansions.GetValueOnAnyThread();
+    const float Now = Context.GetWorld()->GetTimeSeconds();
+
+    EntityQuery.ForEachEntityChunk(EntityManager, Context, [this, &PlansLeft, MaxExpansions, Now](FMassExecutionContext& Context)
+    {
+        const FGOAPCrowdSharedFragment& Shared = Context.GetConstSharedFragment<FGOAPCrowdSharedFragment>();
+        if (!Shared.Domain || PlansLeft <= 0) return;
+
+        const FGOAPDomain& Domain = *Shared.Domain;
+        const FGOAPWorldState Goal = Shared.GetGoal();
+        const TConstArrayView<FGOAPWorldStateFragment> States = Context.GetFragmentView<FGOAPWorldStateFragment>();
+        const TArrayView<FGOAPPlanFragment> Plans = Context.GetMutableFragmentView<FGOAPPlanFragment>();
+
+        for (int32 Index = 0; Index < Context.GetNumEntities() && PlansLeft > 0; ++Index)
+        {
+            FGOAPPlanFragment& Plan = Plans[Index];
+            const FGOAPWorldState& State = States[Index].State;
+            if (!Plan.IsDone() || Now < Plan.NextPlanTime || State.Satisfies(Goal)) continue;
+
+            --PlansLeft;
+            Plan.NumActions = 0;
+            Plan.CurrentStep = 0;
+            Plan.bStepStarted = false;
+            if (!Planner.FindPlan(Domain, State, Goal, MaxExpansions, nullptr, PlanScratch))
+            {
+                Plan.NextPlanTime = Now + GOAPCrowd::PlanRetryDelay;
+                continue;
+            }
+
+            Plan.NumActions = (uint8)FMath::Min(PlanScratch.Num(), GOAPCrowdMaxPlanLength);
+            for (int32 Step = 0; Step < Plan.NumActions; ++Step)
+            {
+                Plan.Actions[Step] = (uint16)PlanScratch[Step];
+            }
+        }
+    });
+}
+
+//----------------------------------------------------------------------//
+// Execution
+//----------------------------------------------------------------------//
+
+UGOAPCrowdExecutionProcessor::UGOAPCrowdExecutionProcessor()
+    : EntityQuery(*this)
+{
+    ExecutionFlags = (int32)EProcessorExecutionFlags::All;
+    ExecutionOrder.ExecuteInGroup = GOAPCrowd::ProcessorGroup;
+    ExecutionOrder.ExecuteAfter.Add(UGOAPCrowdPlanningProcessor::StaticClass()->GetFName());
+}
+
+void UGOAPCrowdExecutionProcessor::ConfigureQueries()
+{
+    EntityQuery.AddRequirement<FGOAPWorldStateFragment>(EMassFragmentAccess::ReadWrite);
+    EntityQuery.AddRequirement<FGOAPPlanFragment>(EMassFragmentAccess::ReadWrite);
+    EntityQuery.AddRequirement<FGOAPPatrolFragment>(EMassFragmentAccess::ReadWrite);
+    EntityQuery.AddConstSharedRequirement<FGOAPCrowdSharedFragment>();
+    EntityQuery.AddTagRequirement<FGOAPCrowdAgentTag>(EMassFragmentPresence::All);
+}
+
+void UGOAPCrowdExecutionProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+    EntityQuery.ForEachEntityChunk(EntityManager, Context, [](FMassExecutionContext& Context)
+    {
+        const FGOAPCrowdSharedFragment& Shared = Context.GetConstSharedFragment<FGOAPCrowdSharedFragment>();
+        if (!Shared.Domain) return;
+
+        const FGOAPDomain& Domain = *Shared.Domain;
+        const TArrayView<FGOAPWorldStateFragment> States = Context.GetMutableFragmentView<FGOAPWorldStateFragment>();
+        const TArrayView<FGOAPPlanFragment> Plans = Context.GetMutableFragmentView<FGOAPPlanFragment>();
+        const TArrayView<FGOAPPatrolFragment> Patrols = Context.GetMutableFragmentView<FGOAPPatrolFragment>();
+
+        for (int32 Index = 0; Index < Context.GetNumEntities(); ++Index)
+        {
+            FGOAPPlanFragment& Plan = Plans[Index];
+            if (Plan.IsDone()) continue;
+
+            FGOAPWorldState& State = States[Index].State;
+            FGOAPPatrolFragment& Patrol = Patrols[Index];
+            const FGOAPCompiledAction& Action = Domain.Actions[Plan.Actions[Plan.CurrentStep]];
+
+            if (Plan.bStepStarted)
+            {
+                // Walk finished. Movement effects come from perception on full actors; crowd agents have none,
+                // so the plan runs out and the agent replans and keeps patrolling.
+                if (!Patrol.bMoving)
+                {
+                    ++Plan.CurrentStep;
+                    Plan.bStepStarted = false;
+                }
+                continue;
+            }
+
+            if (!State.Satisfies(Action.Preconditions))
+            {
+                // Drop the rest of the plan; the planning processor picks the agent up next frame
+                Plan.CurrentStep = Plan.NumActions;
+                continue;
+            }
+
+            switch (Action.CrowdBehavior)
+            {
+            case EGOAPCrowdBehavior::Patrol:
+                if (Shared.RouteLocations.Num() > 0)
+                {
+                    Patrol.bMoving = true;
+                    Plan.bStepStarted = true;
+                    break;
+                }
+                // No route to walk; treat as instant
+                [[fallthrough]];
+            case EGOAPCrowdBehavior::Instant:
+            default:
+                State = State.WithEffects(Action.Effects);
+                ++Plan.CurrentStep;
+                break;
+            }
+        }
+    });
+}
+
+//----------------------------------------------------------------------//
+// Movement
+//----------------------------------------------------------------------//
+
+UGOAPCrowdMovementProcessor::UGOAPCrowdMovementProcessor()
+    : EntityQuery(*this)
+{
+    ExecutionFlags = (int32)EProcessorExecutionFlags::All;
+    ExecutionOrder.ExecuteInGroup = GOAPCrowd::ProcessorGroup;
+    ExecutionOrder.ExecuteAfter.Add(UGOAPCrowdExecutionProcessor::StaticClass()->GetFName());
+}
+
+void UGOAPCrowdMovementProcessor::ConfigureQueries()
+{
+    EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadWrite);
+    EntityQuery.AddRequirement<FGOAPPatrolFragment>(EMassFragmentAccess::ReadWrite);
+    EntityQuery.AddConstSharedRequirement<FGOAPCrowdSharedFragment>();
+    EntityQuery.AddTagRequirement<FGOAPCrowdAgentTag>(EMassFragmentPresence::All);
+}
+
+void UGOAPCrowdMovementProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+    EntityQuery.ForEachEntityChunk(EntityManager, Context, [](FMassExecutionContext& Context)
+    {
+        const FGOAPCrowdSharedFragment& Shared = Context.GetConstSharedFragment<FGOAPCrowdSharedFragment>();
+        const int32 RouteLength = Shared.RouteLocations.Num();
+        if (RouteLength == 0) return;
+
+        const float Step = Shared.MoveSpeed * Context.GetDeltaTimeSeconds();
+        const TArrayView<FTransformFragment> Transforms = Context.GetMutableFragmentView<FTransformFragment>();
+        const TArrayView<FGOAPPatrolFragment> Patrols = Context.GetMutableFragmentView<FGOAPPatrolFragment>();
+
+        // Background agents walk straight between route nodes without collision
+        for (int32 Index = 0; Index < Context.GetNumEntities(); ++Index)
+        {
+            FGOAPPatrolFragment& Patrol = Patrols[Index];
+            if (!Patrol.bMoving) continue;
+
+            FTransform& Transform = Transforms[Index].GetMutableTransform();
+            const FVector Location = Transform.GetLocation();
+            const FVector Target = Shared.RouteLocations[Patrol.PatrolIndex % RouteLength];
+            const FVector Delta = Target - Location;
+            const double Distance = Delta.Size();
+
+            if (Distance <= Step)
+            {
+                Transform.SetLocation(Target);
+                Patrol.PatrolIndex = (Patrol.PatrolIndex + 1) % RouteLength;
+                Patrol.bMoving = false;
+                continue;
+            }
+
+            const FVector Direction = Delta / Distance;
+            Transform.SetLocation(Location + Direction * Step);
+            Transform.SetRotation(Direction.GetSafeNormal2D().ToOrientationQuat());
+        }
+    });
+}
+
+//----------------------------------------------------------------------//
+// Promotion
+//----------------------------------------------------------------------//
+
+UGOAPCrowdPromotionProcessor::UGOAPCrowdPromotionProcessor()
+    : EntityQuery(*this)
+{
+    ExecutionFlags = (int32)EProcessorExecutionFlags::All;
+    ExecutionOrder.ExecuteInGroup = GOAPCrowd::ProcessorGroup;
+    ExecutionOrder.ExecuteAfter.Add(UGOAPCrowdMovementProcessor::StaticClass()->GetFName());
+
+    // Reads player views and talks to a world subsystem
+    bRequiresGameThreadExecution = true;
+}
+
+void UGOAPCrowdPromotionProcessor::ConfigureQueries()
+{
+    EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+    EntityQuery.AddTagRequirement<FGOAPCrowdAgentTag>(EMassFragmentPresence::All);
+}
+
+void UGOAPCrowdPromotionProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+    UWorld* World = Context.GetWorld();
+    UGOAPCrowdSubsystem* Crowd = UGOAPCrowdSubsystem::Get(World);
+    if (!Crowd) return;
+
+    UGOAPCrowdSubsystem::GatherPlayerViews(*World, ViewLocations);
+    if (ViewLocations.Num() == 0) return;
+
+    const double PromoteDistanceSq = FMath::Square(UGOAPCrowdSubsystem::GetPromoteDistance());
+    EntityQuery.ForEachEntityChunk(EntityManager, Context, [this, Crowd, PromoteDistanceSq](FMassExecutionContext& Context)
+    {
+        const TConstArrayView<FTransformFragment> Transforms = Context.GetFragmentView<FTransformFragment>();
+        for (int32 Index = 0; Index < Context.GetNumEntities(); ++Index)
+        {
+            const FVector Location = Transforms[Index].GetTransform().GetLocation();
+            for (const FVector& View : ViewLocations)
+            {
+                if (FVector::DistSquared(View, Location) < PromoteDistanceSq)
+                {
+                    Crowd->QueuePromotion(Context.GetEntity(Index));
+                    break;
+                }
+            }
+        }
+    });
+}
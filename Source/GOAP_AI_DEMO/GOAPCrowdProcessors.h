@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "MassEntityQuery.h"
+#include "GOAPPlanner.h"
+#include "GOAPCrowdProcessors.generated.h"
+
+// Plans for crowd agents whose plan ran out, at most ai.GOAPCrowd.MaxPlansPerFrame per frame
+UCLASS()
+class GOAP_AI_DEMO_API UGOAPCrowdPlanningProcessor : public UMassProcessor
+{
+    GENERATED_BODY()
+
+public:
+    UGOAPCrowdPlanningProcessor();
+
+protected:
+    virtual void ConfigureQueries() override;
+    virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+    FMassEntityQuery EntityQuery;
+    FGOAPPlanner Planner;
+    TArray<int32> PlanScratch;
+};
+
+// Steps through crowd agents' plans: instant actions apply their effects, patrol actions start a walk
+UCLASS()
+class GOAP_AI_DEMO_API UGOAPCrowdExecutionProcessor : public UMassProcessor
+{
+    GENERATED_BODY()
+
+public:
+    UGOAPCrowdExecutionProcessor();
+
+protected:
+    virtual void ConfigureQueries() override;
+    virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+    FMassEntityQuery EntityQuery;
+};
+
+// Walks crowd agents between the nodes of their patrol route
+UCLASS()
+class GOAP_AI_DEMO_API UGOAPCrowdMovementProcessor : public UMassProcessor
+{
+    GENERATED_BODY()
+
+public:
+    UGOAPCrowdMovementProcessor();
+
+protected:
+    virtual void ConfigureQueries() override;
+    virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+    FMassEntityQuery EntityQuery;
+};
+
+// Hands crowd agents near a player to UGOAPCrowdSubsystem to be promoted to full actors
+UCLASS()
+class GOAP_AI_DEMO_API UGOAPCrowdPromotionProcessor : public UMassProcessor
+{
+    GENERATED_BODY()
+
+public:
+    UGOAPCrowdPromotionProcessor();
+
+protected:
+    virtual void ConfigureQueries() override;
+    virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+private:
+    FMassEntityQuery EntityQuery;
+    TArray<FVector> ViewLocations;
+};
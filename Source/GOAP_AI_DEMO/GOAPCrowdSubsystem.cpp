@@ -0,0 +1,286 @@
+#include "GOAPCrowdSubsystem.h"
+#include "AIMemory.h"
+#include "GOAPCrowdFragments.h"
+#include "GOAPPlannerSubsystem.h"
+#include "AI_Character.h"
+#include "Node.h"
+#include "MassCommonFragments.h"
+#include "MassEntityManager.h"
+#include "MassEntityUtils.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/OutputDevice.h"
+
+static TAutoConsoleVariable<float> CVarCrowdPromoteDistance(
+    TEXT("ai.GOAPCrowd.PromoteDistance"),
+    3000.0f,
+    TEXT("Crowd agents closer than this to a player view become full actors."));
+
+static TAutoConsoleVariable<float> CVarCrowdDemoteDistance(
+    TEXT("ai.GOAPCrowd.DemoteDistance"),
+    4000.0f,
+    TEXT("Promoted actors farther than this from every player view go back to the crowd."));
+
+static TAutoConsoleVariable<int32> CVarCrowdMaxTransitionsPerFrame(
+    TEXT("ai.GOAPCrowd.MaxTransitionsPerFrame"),
+    4,
+    TEXT("Maximum promotions, and separately demotions, per frame."));
+
+namespace GOAPCrowd
+{
+    static void SpawnCommand(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+    {
+        UGOAPCrowdSubsystem* Crowd = UGOAPCrowdSubsystem::Get(World);
+        if (!Crowd) return;
+
+        const int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 100;
+
+        for (TActorIterator<AAI_Character> It(World); It; ++It)
+        {
+            if (It->PatrolPath.Num() == 0 || !It->GOAPAgentComponent) continue;
+
+            Ar.Logf(TEXT("Spawned %d crowd agents like %s."), Crowd->SpawnAgentsLike(**It, Count), *It->GetName());
+            return;
+        }
+        Ar.Logf(TEXT("No AI_Character with a patrol path to copy; no crowd agents spawned."));
+    }
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdGOAPCrowdSpawn(
+    TEXT("ai.GOAPCrowd.Spawn"),
+    TEXT("Spawns crowd agents with the actions, goal and patrol path of the first placed AI_Character that has one. Optional argument: number of agents (default 100)."),
+    FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&GOAPCrowd::SpawnCommand));
+
+UGOAPCrowdSubsystem* UGOAPCrowdSubsystem::Get(const UWorld* World)
+{
+    return World ? World->GetSubsystem<UGOAPCrowdSubsystem>() : nullptr;
+}
+
+float UGOAPCrowdSubsystem::GetPromoteDistance()
+{
+    return CVarCrowdPromoteDistance.GetValueOnGameThread();
+}
+
+void UGOAPCrowdSubsystem::GatherPlayerViews(const UWorld& World, TArray<FVector>& OutLocations)
+{
+    OutLocations.Reset();
+    for (FConstPlayerControllerIterator It = World.GetPlayerControllerIterator(); It; ++It)
+    {
+        if (const APlayerController* PlayerController = It->Get())
+        {
+            FVector Location;
+            FRotator Rotation;
+            PlayerController->GetPlayerViewPoint(Location, Rotation);
+            OutLocations.Add(Location);
+        }
+    }
+}
+
+void UGOAPCrowdSubsystem::Deinitialize()
+{
+    PendingPromotions.Empty();
+    Promoted.Empty();
+    Super::Deinitialize();
+}
+
+TStatId UGOAPCrowdSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UGOAPCrowdSubsystem, STATGROUP_Tickables);
+}
+
+void UGOAPCrowdSubsystem::CreateEntities(const FConstSharedStruct& SharedFragment, int32 Count, TArray<FMassEntityHandle>& OutEntities)
+{
+    FMassEntityManager& EntityManager = UE::Mass::Utils::GetEntityManagerChecked(*GetWorld());
+    if (!Archetype.IsValid())
+    {
+        Archetype = EntityManager.CreateArchetype({
+            FTransformFragment::StaticStruct(),
+            FGOAPWorldStateFragment::StaticStruct(),
+            FGOAPPlanFragment::StaticStruct(),
+            FGOAPPatrolFragment::StaticStruct(),
+            FGOAPCrowdAgentTag::StaticStruct() });
+    }
+
+    FMassArchetypeSharedFragmentValues SharedValues;
+    SharedValues.AddConstSharedFragment(SharedFragment);
+    SharedValues.Sort();
+
+    OutEntities.Reset();
+    EntityManager.BatchCreateEntities(Archetype, SharedValues, Count, OutEntities);
+}
+
+int32 UGOAPCrowdSubsystem::SpawnAgents(const FGOAPCrowdSpawnParams& Params)
+{
+    LLM_SCOPE_BYTAG(AIGOAP);
+
+    UGOAPPlannerSubsystem* PlannerSubsystem = UGOAPPlannerSubsystem::Get(GetWorld());
+    if (!PlannerSubsystem || Params.Count <= 0) return 0;
+
+    FGOAPCrowdSharedFragment Shared;
+    Shared.Domain = PlannerSubsystem->GetDomain(Params.ActionClasses, &Shared.DomainId);
+    if (!Shared.Domain) return 0;
+
+    FGOAPWorldState Goal;
+    if (!Shared.Domain->MakeGoal(Params.Goal, Params.InitialWorldState, Goal))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Crowd goal needs a fact no action can change; no agents spawned."));
+        return 0;
+    }
+    Shared.GoalKnown = Goal.Known;
+    Shared.GoalValues = Goal.Values;
+
+    for (ANode* Node : Params.Route)
+    {
+        if (!Node) continue;
+        Shared.Route.Add(Node);
+        Shared.RouteLocations.Add(Node->GetActorLocation());
+    }
+    if (Shared.Route.Num() == 0) return 0;
+
+    Shared.MoveSpeed = Params.MoveSpeed;
+    Shared.ActorClass = Params.ActorClass;
+
+    FMassEntityManager& EntityManager = UE::Mass::Utils::GetEntityManagerChecked(*GetWorld());
+    const FConstSharedStruct SharedFragment = EntityManager.GetOrCreateConstSharedFragment(Shared);
+
+    TArray<FMassEntityHandle> Entities;
+    CreateEntities(SharedFragment, Params.Count, Entities);
+
+    // Spread agents along the route so they do not walk in lockstep
+    const FGOAPWorldState InitialState = Shared.Domain->MakeState(Params.InitialWorldState);
+    const int32 RouteLength = Shared.RouteLocations.Num();
+    for (int32 Index = 0; Index < Entities.Num(); ++Index)
+    {
+        const int32 Segment = Index % RouteLength;
+        const float Alpha = FMath::Frac(Index * 0.618034f);
+        const FVector Location = FMath::Lerp(Shared.RouteLocations[Segment], Shared.RouteLocations[(Segment + 1) % RouteLength], Alpha);
+
+        EntityManager.GetFragmentDataChecked<FTransformFragment>(Entities[Index]).SetTransform(FTransform(Location));
+        EntityManager.GetFragmentDataChecked<FGOAPWorldStateFragment>(Entities[Index]).State = InitialState;
+        EntityManager.GetFragmentDataChecked<FGOAPPatrolFragment>(Entities[Index]).PatrolIndex = (Segment + 1) % RouteLength;
+    }
+    return Entities.Num();
+}
+
+int32 UGOAPCrowdSubsystem::SpawnAgentsLike(const AAI_Character& Template, int32 Count, TConstArrayView<ANode*> Route)
+{
+    const UGOAPAgentComponent* GOAPAgent = Template.GOAPAgentComponent;
+    if (!GOAPAgent) return 0;
+
+    FGOAPCrowdSpawnParams Params;
+    Params.ActionClasses = GOAPAgent->AvailableActionTypes;
+    Params.Goal = GOAPAgent->CurrentGoal;
+    Params.InitialWorldState = GOAPAgent->WorldState;
+    Params.Route = Route.Num() > 0 ? TArray<ANode*>(Route) : Template.PatrolPath;
+    Params.ActorClass = Template.GetClass();
+    Params.Count = Count;
+    if (const UCharacterMovementComponent* Movement = Template.GetCharacterMovement())
+    {
+        Params.MoveSpeed = Movement->MaxWalkSpeed;
+    }
+    return SpawnAgents(Params);
+}
+
+void UGOAPCrowdSubsystem::QueuePromotion(FMassEntityHandle Entity)
+{
+    PendingPromotions.Add(Entity);
+}
+
+void UGOAPCrowdSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+    LLM_SCOPE_BYTAG(AIGOAP);
+
+    const int32 MaxTransitions = FMath::Max(CVarCrowdMaxTransitionsPerFrame.GetValueOnGameThread(), 1);
+
+    // Agents still near a player are queued again next frame
+    int32 Promotions = 0;
+    for (const FMassEntityHandle Entity : PendingPromotions)
+    {
+        if (Promotions++ >= MaxTransitions) break;
+        Promote(Entity);
+    }
+    PendingPromotions.Reset();
+
+    Promoted.RemoveAllSwap([](const FPromotedAgent& Agent) { return !Agent.Actor.IsValid(); });
+    if (Promoted.Num() == 0) return;
+
+    GatherPlayerViews(*GetWorld(), ViewLocations);
+    if (ViewLocations.Num() == 0) return;
+
+    const double DemoteDistanceSq = FMath::Square(FMath::Max(CVarCrowdDemoteDistance.GetValueOnGameThread(), GetPromoteDistance()));
+    int32 Demotions = 0;
+    for (int32 Index = Promoted.Num() - 1; Index >= 0 && Demotions < MaxTransitions; --Index)
+    {
+        const FVector Location = Promoted[Index].Actor->GetActorLocation();
+        const bool bNearPlayer = ViewLocations.ContainsByPredicate([&Location, DemoteDistanceSq](const FVector& View)
+        {
+            return FVector::DistSquared(View, Location) < DemoteDistanceSq;
+        });
+        if (bNearPlayer) continue;
+
+        Demote(Promoted[Index]);
+        Promoted.RemoveAtSwap(Index, EAllowShrinking::No);
+        ++Demotions;
+    }
+}
+
+void UGOAPCrowdSubsystem::Promote(FMassEntityHandle Entity)
+{
+    UWorld* World = GetWorld();
+    FMassEntityManager& EntityManager = UE::Mass::Utils::GetEntityManagerChecked(*World);
+    if (!EntityManager.IsEntityValid(Entity)) return;
+
+    const FGOAPCrowdSharedFragment& Shared = EntityManager.GetConstSharedFragmentDataChecked<FGOAPCrowdSharedFragment>(Entity);
+    const FTransform Transform = EntityManager.GetFragmentDataChecked<FTransformFragment>(Entity).GetTransform();
+    const FGOAPWorldState State = EntityManager.GetFragmentDataChecked<FGOAPWorldStateFragment>(Entity).State;
+    const int32 PatrolIndex = EntityManager.GetFragmentDataChecked<FGOAPPatrolFragment>(Entity).PatrolIndex;
+
+    UClass* ActorClass = Shared.ActorClass ? *Shared.ActorClass : AAI_Character::StaticClass();
+    AAI_Character* Actor = World->SpawnActorDeferred<AAI_Character>(ActorClass, Transform, nullptr, nullptr,
+        ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+    if (!Actor) return;
+
+    Actor->AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
+    for (ANode* Node : Shared.Route)
+    {
+        Actor->PatrolPath.Add(Node);
+    }
+    Actor->FinishSpawning(Transform);
+    Actor->SetPatrolIndex(PatrolIndex);
+
+    // Pick up where the entity left off. BeginPlay already planned against the
+    // template state, so drop that plan along with its monitor and any
+    // anytime search; the agent replans on its next tick
+    if (UGOAPAgentComponent* GOAPAgent = Actor->GOAPAgentComponent)
+    {
+        Shared.Domain->ExportState(State, GOAPAgent->WorldState);
+        GOAPAgent->InvalidatePlan();
+    }
+
+    Promoted.Add({ Actor, EntityManager.GetOrCreateConstSharedFragment(Shared) });
+    EntityManager.DestroyEntity(Entity);
+}
+
+void UGOAPCrowdSubsystem::Demote(const FPromotedAgent& Agent)
+{
+    AAI_Character* Actor = Agent.Actor.Get();
+    const FGOAPCrowdSharedFragment& Shared = Agent.SharedFragment.Get<const FGOAPCrowdSharedFragment>();
+
+    TArray<FMassEntityHandle> Entities;
+    CreateEntities(Agent.SharedFragment, 1, Entities);
+    if (Entities.Num() == 0) return;
+
+    FMassEntityManager& EntityManager = UE::Mass::Utils::GetEntityManagerChecked(*GetWorld());
+    EntityManager.GetFragmentDataChecked<FTransformFragment>(Entities[0]).SetTransform(Actor->GetActorTransform());
+    EntityManager.GetFragmentDataChecked<FGOAPPatrolFragment>(Entities[0]).PatrolIndex = Actor->GetPatrolIndex();
+    if (Actor->GOAPAgentComponent)
+    {
+        EntityManager.GetFragmentDataChecked<FGOAPWorldStateFragment>(Entities[0]).State = Shared.Domain->MakeState(Actor->GOAPAgentComponent->WorldState);
+    }
+
+    Actor->Destroy();
+}
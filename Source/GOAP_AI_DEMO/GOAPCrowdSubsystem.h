@@ -0,0 +1,80 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MassEntityTypes.h"
+#include "MassArchetypeTypes.h"
+#include "StructUtils/SharedStruct.h"
+#include "GOAPTypes.h"
+#include "GOAPCrowdSubsystem.generated.h"
+
+class ANode;
+class AAI_Character;
+class UGOAPAction;
+
+struct FGOAPCrowdSpawnParams
+{
+    // Same action classes as the full actors use, so both run the same domain
+    TArray<TSubclassOf<UGOAPAction>> ActionClasses;
+    FGOAPGoal Goal;
+    TMap<FName, bool> InitialWorldState;
+
+    TArray<ANode*> Route;
+    float MoveSpeed = 300.f;
+
+    // Spawned when an agent comes near a player
+    TSubclassOf<AAI_Character> ActorClass;
+
+    int32 Count = 0;
+};
+
+// Background GOAP agents as Mass entities. World state, plan and patrol progress live in fragments,
+// and the GOAPCrowd processors plan, execute and walk the patrol route for whole chunks at once.
+// Agents within ai.GOAPCrowd.PromoteDistance of a player become full AAI_Character actors. Promoted
+// actors that fall back beyond ai.GOAPCrowd.DemoteDistance go back to being entities.
+// "ai.GOAPCrowd.Spawn <Count>" adds Count entities modelled on the first placed agent with a patrol path.
+UCLASS()
+class GOAP_AI_DEMO_API UGOAPCrowdSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static UGOAPCrowdSubsystem* Get(const UWorld* World);
+
+    static float GetPromoteDistance();
+    static void GatherPlayerViews(const UWorld& World, TArray<FVector>& OutLocations);
+
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    virtual void Deinitialize() override;
+
+    // Spawns Params.Count entities spread along the route. Returns the number spawned.
+    int32 SpawnAgents(const FGOAPCrowdSpawnParams& Params);
+
+    // Spawns Count entities with Template's actions, goal, world state and class, on Route or else Template's
+    // patrol path. Returns the number spawned.
+    int32 SpawnAgentsLike(const AAI_Character& Template, int32 Count, TConstArrayView<ANode*> Route = {});
+
+    // Called by the promotion processor; the actor is spawned on the next tick
+    void QueuePromotion(FMassEntityHandle Entity);
+
+    int32 GetNumPromoted() const { return Promoted.Num(); }
+
+private:
+    struct FPromotedAgent
+    {
+        TWeakObjectPtr<AAI_Character> Actor;
+        FConstSharedStruct SharedFragment;
+    };
+
+    void Promote(FMassEntityHandle Entity);
+    void Demote(const FPromotedAgent& Agent);
+
+    // Creates Count entities sharing SharedFragment; fragments are left at their defaults
+    void CreateEntities(const FConstSharedStruct& SharedFragment, int32 Count, TArray<FMassEntityHandle>& OutEntities);
+
+    FMassArchetypeHandle Archetype;
+    TSet<FMassEntityHandle> PendingPromotions;
+    TArray<FPromotedAgent> Promoted;
+    TArray<FVector> ViewLocations;
+};
@@ -0,0 +1,606 @@
+#include "GOAPPlanner.h"
+#include "AIMemory.h"
+#include "GOAPStats.h"
+#include "Algo/Reverse.h"
+#include "Misc/ScopeExit.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarGOAPPruneOrderings(
+    TEXT("ai.GOAP.PruneOrderings"),
+    1,
+    TEXT("Search only one order of actions that do not interfere with each other."));
+
+static TAutoConsoleVariable<int32> CVarGOAPRelaxedHeuristic(
+    TEXT("ai.GOAP.RelaxedHeuristic"),
+    1,
+    TEXT("Guide plan searches with the FF relaxed-plan heuristic; 0 counts unsatisfied goal facts instead."));
+
+TSharedPtr<FGOAPDomain> FGOAPDomain::Compile(TConstArrayView<TSubclassOf<UGOAPAction>> ActionClasses)
+{
+    LLM_SCOPE_BYTAG(AIGOAP);
+
+    TSharedPtr<FGOAPDomain> Domain = MakeShared<FGOAPDomain>();
+
+    auto AddStates = [&Domain](const TArray<FGOAPState>& States, FGOAPWorldState& OutState)
+    {
+        for (const FGOAPState& State : States)
+        {
+            int32 Fact = Domain->FactNames.IndexOfByKey(State.Key);
+            if (Fact == INDEX_NONE)
+            {
+                if (Domain->FactNames.Num() >= MaxFacts) return false;
+                Fact = Domain->FactNames.Add(State.Key);
+            }
+
+            const uint64 Bit = uint64(1) << Fact;
+            OutState.Known |= Bit;
+            OutState.Values = State.Value ? OutState.Values | Bit : OutState.Values & ~Bit;
+        }
+        return true;
+    };
+
+    // Crowd plan fragments store action indices as uint16
+    if (ActionClasses.Num() > MAX_uint16)
+    {
+        UE_LOG(LogTemp, Error, TEXT("GOAP domain has %d actions; at most %d can be compiled."), ActionClasses.Num(), MAX_uint16);
+        return nullptr;
+    }
+
+    for (const TSubclassOf<UGOAPAction>& ActionClass : ActionClasses)
+    {
+        if (!ActionClass) continue;
+
+        const UGOAPAction* Defaults = ActionClass->GetDefaultObject<UGOAPAction>();
+        FGOAPCompiledAction& Action = Domain->Actions.AddDefaulted_GetRef();
+        Action.ActionClass = ActionClass;
+        Action.Cost = Defaults->Cost;
+        Action.CrowdBehavior = Defaults->CrowdBehavior;
+
+        if (!AddStates(Defaults->Preconditions, Action.Preconditions) || !AddStates(Defaults->Effects, Action.Effects))
+        {
+            UE_LOG(LogTemp, Error, TEXT("GOAP domain uses more than %d facts; %s cannot be compiled."), MaxFacts, *ActionClass->GetName());
+            return nullptr;
+        }
+    }
+
+    Domain->RelaxedActions.Reserve(Domain->Actions.Num());
+    for (const FGOAPCompiledAction& Action : Domain->Actions)
+    {
+        FRelaxedAction& Relaxed = Domain->RelaxedActions.AddDefaulted_GetRef();
+        Relaxed.NeedTrue = Action.Preconditions.Known & Action.Preconditions.Values;
+        Relaxed.NeedFalse = Action.Preconditions.Known & ~Action.Preconditions.Values;
+        Relaxed.AddTrue = Action.Effects.Known & Action.Effects.Values;
+        Relaxed.AddFalse = Action.Effects.Known & ~Action.Effects.Values;
+    }
+
+    // Two actions interfere when either one's effects touch a fact the other needs, or both set a fact to different values
+    const int32 NumActions = Domain->Actions.Num();
+    Domain->Interference.Init(true, NumActions * NumActions);
+    for (int32 A = 0; A < NumActions; ++A)
+    {
+        const FGOAPCompiledAction& First = Domain->Actions[A];
+        for (int32 B = 0; B < NumActions; ++B)
+        {
+            const FGOAPCompiledAction& Second = Domain->Actions[B];
+            const uint64 Enables = (First.Effects.Known & Second.Preconditions.Known) | (Second.Effects.Known & First.Preconditions.Known);
+            const uint64 Clobbers = First.Effects.Known & Second.Effects.Known & (First.Effects.Values ^ Second.Effects.Values);
+            Domain->Interference[A * NumActions + B] = A == B || Enables != 0 || Clobbers != 0;
+        }
+    }
+    return Domain;
+}
+
+int32 FGOAPDomain::FindFact(FName Fact) const
+{
+    return FactNames.IndexOfByKey(Fact);
+}
+
+FGOAPWorldState FGOAPDomain::MakeState(const TMap<FName, bool>& WorldState) const
+{
+    FGOAPWorldState State;
+    for (int32 Fact = 0; Fact < FactNames.Num(); ++Fact)
+    {
+        if (const bool* Value = WorldState.Find(FactNames[Fact]))
+        {
+            const uint64 Bit = uint64(1) << Fact;
+            State.Known |= Bit;
+            State.Values |= *Value ? Bit : 0;
+        }
+    }
+    return State;
+}
+
+bool FGOAPDomain::MakeGoal(const FGOAPGoal& Goal, const TMap<FName, bool>& WorldState, FGOAPWorldState& OutGoal) const
+{
+    OutGoal = FGOAPWorldState();
+    for (const FGOAPState& Desired : Goal.DesiredStates)
+    {
+        const int32 Fact = FindFact(Desired.Key);
+        if (Fact == INDEX_NONE)
+        {
+            // No action can change it, so it has to hold already
+            const bool* Value = WorldState.Find(Desired.Key);
+            if (!Value || *Value != Desired.Value) return false;
+            continue;
+        }
+
+        const uint64 Bit = uint64(1) << Fact;
+        OutGoal.Known |= Bit;
+        OutGoal.Values |= Desired.Value ? Bit : 0;
+    }
+    return true;
+}
+
+void FGOAPDomain::ExportState(const FGOAPWorldState& State, TMap<FName, bool>& WorldState) const
+{
+    for (int32 Fact = 0; Fact < FactNames.Num(); ++Fact)
+    {
+        const uint64 Bit = uint64(1) << Fact;
+        if (State.Known & Bit)
+        {
+            WorldState.Add(FactNames[Fact], (State.Values & Bit) != 0);
+        }
+    }
+}
+
+float FGOAPDomain::RelaxedPlanCost(const FGOAPWorldState& State, const FGOAPWorldState& Goal, const TBitArray<>* AllowedActions) const
+{
+    const uint64 GoalTrue = Goal.Known & Goal.Values;
+    const uint64 GoalFalse = Goal.Known & ~Goal.Values;
+    const uint64 InitialTrue = State.Known & State.Values;
+    const uint64 InitialFalse = State.Known & ~State.Values;
+
+    // Fact values are literals: index 0 holds the true value of each fact, index 1 the false one.
+    // A literal's layer is the graph layer it first appears in; its achiever is the action that first adds it.
+    uint8 Layer[2][MaxFacts];
+    int32 Achiever[2][MaxFacts];
+
+    TArray<int32, TInlineAllocator<64>> Pending;
+    for (int32 ActionIndex = 0; ActionIndex < RelaxedActions.Num(); ++ActionIndex)
+    {
+        if (!AllowedActions || (*AllowedActions)[ActionIndex]) Pending.Add(ActionIndex);
+    }
+
+    // Grow the graph a layer at a time until every goal literal is in it
+    uint64 True = InitialTrue;
+    uint64 False = InitialFalse;
+    int32 NumLayers = 0;
+    while ((GoalTrue & ~True) || (GoalFalse & ~False))
+    {
+        uint64 NewTrue = 0;
+        uint64 NewFalse = 0;
+        for (int32 Index = Pending.Num() - 1; Index >= 0; --Index)
+        {
+            const int32 ActionIndex = Pending[Index];
+            const FRelaxedAction& Action = RelaxedActions[ActionIndex];
+            if ((Action.NeedTrue & ~True) || (Action.NeedFalse & ~False)) continue;
+
+            for (uint64 Bits = Action.AddTrue & ~(True | NewTrue); Bits; Bits &= Bits - 1)
+            {
+                const int32 Fact = FMath::CountTrailingZeros64(Bits);
+                Layer[0][Fact] = NumLayers + 1;
+                Achiever[0][Fact] = ActionIndex;
+            }
+            for (uint64 Bits = Action.AddFalse & ~(False | NewFalse); Bits; Bits &= Bits - 1)
+            {
+                const int32 Fact = FMath::CountTrailingZeros64(Bits);
+                Layer[1][Fact] = NumLayers + 1;
+                Achiever[1][Fact] = ActionIndex;
+            }
+            NewTrue |= Action.AddTrue;
+            NewFalse |= Action.AddFalse;
+            Pending.RemoveAtSwap(Index, EAllowShrinking::No);
+        }
+
+        // Nothing new: the goal is out of reach
+        if (!(NewTrue & ~True) && !(NewFalse & ~False)) return UE_BIG_NUMBER;
+
+        True |= NewTrue;
+        False |= NewFalse;
+        ++NumLayers;
+    }
+
+    // Walk back from the goal, choosing each missing literal's achiever once and asking for its preconditions
+    TArray<bool, TInlineAllocator<64>> Chosen;
+    Chosen.SetNumZeroed(RelaxedActions.Num());
+
+    uint64 OpenTrue = GoalTrue & ~InitialTrue;
+    uint64 OpenFalse = GoalFalse & ~InitialFalse;
+    uint64 AddedTrue = 0;
+    uint64 AddedFalse = 0;
+    float Cost = 0.f;
+    for (int32 CurrentLayer = NumLayers; CurrentLayer > 0; --CurrentLayer)
+    {
+        for (int32 Value = 0; Value < 2; ++Value)
+        {
+            for (uint64 Bits = Value == 0 ? OpenTrue : OpenFalse; Bits; Bits &= Bits - 1)
+            {
+                const int32 Fact = FMath::CountTrailingZeros64(Bits);
+                if (Layer[Value][Fact] != CurrentLayer) continue;
+
+                const int32 ActionIndex = Achiever[Value][Fact];
+                if (Chosen[ActionIndex]) continue;
+                Chosen[ActionIndex] = true;
+                Cost += Actions[ActionIndex].Cost;
+
+                // Its preconditions all sit in earlier layers, so this layer's loop is unaffected
+                const FRelaxedAction& Action = RelaxedActions[ActionIndex];
+                AddedTrue |= Action.AddTrue;
+                AddedFalse |= Action.AddFalse;
+                OpenTrue |= Action.NeedTrue & ~InitialTrue;
+                OpenFalse |= Action.NeedFalse & ~InitialFalse;
+            }
+        }
+        OpenTrue &= ~AddedTrue;
+        OpenFalse &= ~AddedFalse;
+    }
+    return Cost;
+}
+
+TBitArray<> FGOAPDomain::FindRelevantActions(const FGOAPWorldState& Goal, const TBitArray<>* AllowedActions) const
+{
+    TBitArray<> Relevant(false, RelaxedActions.Num());
+    uint64 NeededTrue = Goal.Known & Goal.Values;
+    uint64 NeededFalse = Goal.Known & ~Goal.Values;
+
+    // Each pass can only add actions, and needs grow with them, so this settles within Actions.Num() passes
+    for (bool bChanged = true; bChanged;)
+    {
+        bChanged = false;
+        for (int32 ActionIndex = 0; ActionIndex < RelaxedActions.Num(); ++ActionIndex)
+        {
+            if (Relevant[ActionIndex] || (AllowedActions && !(*AllowedActions)[ActionIndex])) continue;
+
+            const FRelaxedAction& Action = RelaxedActions[ActionIndex];
+            if (!(Action.AddTrue & NeededTrue) && !(Action.AddFalse & NeededFalse)) continue;
+
+            Relevant[ActionIndex] = true;
+            NeededTrue |= Action.NeedTrue;
+            NeededFalse |= Action.NeedFalse;
+            bChanged = true;
+        }
+    }
+    return Relevant;
+}
+
+bool FGOAPPlanner::UsePartialOrderPruning()
+{
+    return CVarGOAPPruneOrderings.GetValueOnAnyThread() != 0;
+}
+
+bool FGOAPPlanner::UseRelaxedHeuristic()
+{
+    return CVarGOAPRelaxedHeuristic.GetValueOnAnyThread() != 0;
+}
+
+float FGOAPPlanner::EstimateCost(const FGOAPDomain& Domain, const FGOAPWorldState& State, const FGOAPWorldState& Goal,
+    const TBitArray<>* AllowedActions, bool bRelaxed)
+{
+    return bRelaxed ? Domain.RelaxedPlanCost(State, Goal, AllowedActions) : (float)State.CountUnsatisfied(Goal);
+}
+
+bool FGOAPPlanner::FindPlan(const FGOAPDomain& Domain, const FGOAPWorldState& Start, const FGOAPWorldState& Goal,
+    int32 MaxExpansions, const TBitArray<>* AllowedActions, TArray<int32>& OutPlan)
+{
+    LLM_SCOPE_BYTAG(AIGOAP);
+
+    SCOPE_CYCLE_COUNTER(STAT_GOAP_Planning);
+    CSV_SCOPED_TIMING_STAT(GOAP, Planning);
+    const uint64 StartCycles = FPlatformTime::Cycles64();
+
+    OutPlan.Reset();
+    LastExpansions = 0;
+
+    // Each state's heuristic is worked out once, when the state is first generated, over the actions relevant to Goal
+    const bool bRelaxed = UseRelaxedHeuristic();
+    if (bRelaxed)
+    {
+        HeuristicActions = Domain.FindRelevantActions(Goal, AllowedActions);
+    }
+    const float StartHeuristic = EstimateCost(Domain, Start, Goal, &HeuristicActions, bRelaxed);
+    if (StartHeuristic >= UE_BIG_NUMBER)
+    {
+        GOAPStats::RecordSearch(0, FPlatformTime::Cycles64() - StartCycles);
+        return false;
+    }
+
+    bool bPruneOrderings = UsePartialOrderPruning();
+    int32 GoalNode = INDEX_NONE;
+    for (;;)
+    {
+        Nodes.Reset();
+        Open.Reset();
+        BestNode.Reset();
+        Nodes.Add({ Start, 0.f, StartHeuristic, INDEX_NONE, INDEX_NONE });
+        BestNode.Add(Start, 0);
+        Open.HeapPush({ StartHeuristic, 0 });
+
+        bool bPruned = false;
+        while (Open.Num() > 0)
+        {
+            FOpenEntry Entry;
+            Open.HeapPop(Entry, EAllowShrinking::No);
+
+            // Skip entries superseded by a cheaper route to the same state
+            const FSearchNode Node = Nodes[Entry.Node];
+            if (BestNode.FindChecked(Node.State) != Entry.Node) continue;
+
+            if (Node.State.Satisfies(Goal))
+            {
+                GoalNode = Entry.Node;
+                break;
+            }
+
+            if (MaxExpansions > 0 && LastExpansions >= MaxExpansions) break;
+            ++LastExpansions;
+
+            for (int32 ActionIndex = 0; ActionIndex < Domain.Actions.Num(); ++ActionIndex)
+            {
+                if (AllowedActions && !(*AllowedActions)[ActionIndex]) continue;
+
+                const FGOAPCompiledAction& Action = Domain.Actions[ActionIndex];
+                if (!Node.State.Satisfies(Action.Preconditions)) continue;
+
+                // Independent actions are only tried in increasing index order; the other order reaches the same state for the same cost
+                if (bPruneOrderings && ActionIndex < Node.Action && !Domain.Interferes(ActionIndex, Node.Action))
+                {
+                    bPruned = true;
+                    continue;
+                }
+
+                const FGOAPWorldState Next = Node.State.WithEffects(Action.Effects);
+                if (Next == Node.State) continue;
+
+                const float NextCost = Node.Cost + Action.Cost;
+                int32* Existing = BestNode.Find(Next);
+                if (Existing && Nodes[*Existing].Cost <= NextCost) continue;
+
+                // Dead ends, where not even the relaxed graph reaches the goal, are never stored
+                const float Heuristic = Existing ? Nodes[*Existing].Heuristic : EstimateCost(Domain, Next, Goal, &HeuristicActions, bRelaxed);
+                if (Heuristic >= UE_BIG_NUMBER) continue;
+
+                const int32 NodeIndex = Nodes.Add({ Next, NextCost, Heuristic, Entry.Node, ActionIndex });
+                BestNode.Add(Next, NodeIndex);
+                Open.HeapPush({ NextCost + Heuristic, NodeIndex });
+            }
+        }
+
+        // Duplicate detection can keep a state whose route rules out the one order left open, so a pruned
+        // search that fails is run again in full. Expansions carry over, so MaxExpansions still holds.
+        if (GoalNode != INDEX_NONE || !bPruned) break;
+        bPruneOrderings = false;
+    }
+
+    GOAPStats::RecordSearch(LastExpansions, FPlatformTime::Cycles64() - StartCycles);
+    if (GoalNode == INDEX_NONE) return false;
+
+    for (int32 Node = GoalNode; Nodes[Node].Parent != INDEX_NONE; Node = Nodes[Node].Parent)
+    {
+        OutPlan.Add(Nodes[Node].Action);
+    }
+    Algo::Reverse(OutPlan);
+    return true;
+}
+
+void FGOAPPlanMonitor::Build(const FGOAPDomain& Domain, TConstArrayView<int32> Plan, const FGOAPWorldState& Goal)
+{
+    Conditions.SetNumUninitialized(Plan.Num() + 1);
+    Reachable.Init(true, Plan.Num() + 1);
+
+    // Regress the goal back through the plan, last step first
+    Conditions[Plan.Num()] = { Goal.Known, Goal.Values & Goal.Known };
+    for (int32 Step = Plan.Num() - 1; Step >= 0; --Step)
+    {
+        const FGOAPCompiledAction& Action = Domain.Actions[Plan[Step]];
+        const FGOAPWorldState& Later = Conditions[Step + 1];
+
+        const uint64 Carried = Later.Known & ~Action.Effects.Known;
+        const uint64 Conflict = Carried & Action.Preconditions.Known & (Later.Values ^ Action.Preconditions.Values);
+
+        Conditions[Step].Known = Action.Preconditions.Known | Carried;
+        Conditions[Step].Values = (Action.Preconditions.Values & Action.Preconditions.Known) | (Later.Values & Carried);
+        Reachable[Step] = Conflict == 0 && Reachable[Step + 1];
+    }
+}
+
+int32 FGOAPPlanMonitor::FindResumeStep(const FGOAPWorldState& State, int32 FirstStep) const
+{
+    for (int32 Step = NumSteps(); Step >= FMath::Max(FirstStep, 0); --Step)
+    {
+        if (Reachable[Step] && State.Satisfies(Conditions[Step])) return Step;
+    }
+    return INDEX_NONE;
+}
+
+namespace GOAPAnytime
+{
+    constexpr float InitialWeight = 3.f;
+    constexpr float MaxWeight = 12.f;
+}
+
+void FGOAPAnytimePlanner::Begin(const FGOAPDomain& InDomain, const FGOAPWorldState& InStart, const FGOAPWorldState& InGoal,
+    const TBitArray<>* InAllowedActions, int32 InMaxNodes)
+{
+    LLM_SCOPE_BYTAG(AIGOAP);
+
+    Domain = &InDomain;
+    Start = InStart;
+    Goal = InGoal;
+    AllowedActions = InAllowedActions ? *InAllowedActions : TBitArray<>(true, InDomain.Actions.Num());
+    MaxNodes = FMath::Max(InMaxNodes, 1);
+
+    Incumbent.Reset();
+    IncumbentCost = UE_BIG_NUMBER;
+    TotalExpansions = 0;
+    TotalCycles = 0;
+    Weight = GOAPAnytime::InitialWeight;
+    bRelaxedHeuristic = FGOAPPlanner::UseRelaxedHeuristic();
+    bPruneOrderings = FGOAPPlanner::UsePartialOrderPruning();
+    HeuristicActions = bRelaxedHeuristic ? InDomain.FindRelevantActions(Goal, &AllowedActions) : AllowedActions;
+
+    // Everything the search will ever use, so memory stays flat however it goes
+    Nodes.Reserve(MaxNodes);
+    Open.Reserve(MaxNodes);
+    BestNode.Reserve(MaxNodes);
+
+    StartRound();
+}
+
+void FGOAPAnytimePlanner::Reset()
+{
+    Domain = nullptr;
+    Nodes.Empty();
+    Open.Empty();
+    BestNode.Empty();
+    AllowedActions.Empty();
+    HeuristicActions.Empty();
+    Incumbent.Empty();
+    IncumbentCost = UE_BIG_NUMBER;
+}
+
+SIZE_T FGOAPAnytimePlanner::GetAllocatedSize() const
+{
+    return Nodes.GetAllocatedSize() + Open.GetAllocatedSize() + BestNode.GetAllocatedSize()
+        + AllowedActions.GetAllocatedSize() + HeuristicActions.GetAllocatedSize() + Incumbent.GetAllocatedSize();
+}
+
+void FGOAPAnytimePlanner::StartRound()
+{
+    Nodes.Reset();
+    Open.Reset();
+    BestNode.Reset();
+    bHitNodeCap = false;
+    bPruned = false;
+
+    const float Heuristic = FGOAPPlanner::EstimateCost(*Domain, Start, Goal, &HeuristicActions, bRelaxedHeuristic);
+    Nodes.Add({ Start, 0.f, Heuristic, INDEX_NONE, INDEX_NONE });
+    BestNode.Add(Start, 0);
+    if (Heuristic < UE_BIG_NUMBER)
+    {
+        Open.HeapPush({ Weight * Heuristic, 0.f, 0 });
+    }
+}
+
+bool FGOAPAnytimePlanner::FinishRound(bool bFoundPlan)
+{
+    if (bFoundPlan)
+    {
+        // Weight 1 is as good as this heuristic gets
+        if (Weight <= 1.f) return false;
+        Weight = FMath::Max(Weight - 1.f, 1.f);
+    }
+    else if (bHitNodeCap && !HasPlan() && Weight < GOAPAnytime::MaxWeight)
+    {
+        // Out of memory before any plan: search more greedily
+        Weight = FMath::Min(Weight * 2.f, GOAPAnytime::MaxWeight);
+    }
+    else if (bPruned && !bHitNodeCap)
+    {
+        // As in FGOAPPlanner::FindPlan, pruned orderings may have hidden the only better route
+        bPruneOrderings = false;
+    }
+    else
+    {
+        // Either nothing beats the incumbent, or the cap stops us from looking further
+        return false;
+    }
+
+    StartRound();
+    return true;
+}
+
+FGOAPAnytimePlanner::EStatus FGOAPAnytimePlanner::Step(int32 MaxExpansions)
+{
+    if (!Domain) return EStatus::Finished;
+
+    SCOPE_CYCLE_COUNTER(STAT_GOAP_Planning);
+    CSV_SCOPED_TIMING_STAT(GOAP, Planning);
+    LLM_SCOPE_BYTAG(AIGOAP);
+    const uint64 StartCycles = FPlatformTime::Cycles64();
+    ON_SCOPE_EXIT { TotalCycles += FPlatformTime::Cycles64() - StartCycles; };
+
+    for (int32 Expanded = 0; MaxExpansions <= 0 || Expanded < MaxExpansions;)
+    {
+        if (Open.Num() == 0)
+        {
+            if (!FinishRound(false)) return EStatus::Finished;
+            continue;
+        }
+
+        FOpenEntry Entry;
+        Open.HeapPop(Entry, EAllowShrinking::No);
+
+        // Superseded by a cheaper route to the same state, or unable to beat the incumbent
+        const FSearchNode Node = Nodes[Entry.Node];
+        if (Entry.Cost > Node.Cost || Node.Cost >= IncumbentCost) continue;
+
+        if (Node.State.Satisfies(Goal))
+        {
+            Incumbent.Reset();
+            for (int32 Index = Entry.Node; Nodes[Index].Parent != INDEX_NONE && Incumbent.Num() < Nodes.Num(); Index = Nodes[Index].Parent)
+            {
+                Incumbent.Add(Nodes[Index].Action);
+            }
+            Algo::Reverse(Incumbent);
+            IncumbentCost = Node.Cost;
+
+            if (!FinishRound(true)) return EStatus::Finished;
+            continue;
+        }
+
+        ++Expanded;
+        ++TotalExpansions;
+
+        for (int32 ActionIndex = 0; ActionIndex < Domain->Actions.Num(); ++ActionIndex)
+        {
+            if (!AllowedActions[ActionIndex]) continue;
+
+            const FGOAPCompiledAction& Action = Domain->Actions[ActionIndex];
+            if (!Node.State.Satisfies(Action.Preconditions)) continue;
+
+            if (bPruneOrderings && ActionIndex < Node.Action && !Domain->Interferes(ActionIndex, Node.Action))
+            {
+                bPruned = true;
+                continue;
+            }
+
+            const FGOAPWorldState Next = Node.State.WithEffects(Action.Effects);
+            const float NextCost = Node.Cost + Action.Cost;
+            if (Next == Node.State || NextCost >= IncumbentCost) continue;
+
+            // States seen before are updated in place, so only new states cost memory
+            int32 NextIndex;
+            if (int32* Existing = BestNode.Find(Next))
+            {
+                if (Nodes[*Existing].Cost <= NextCost) continue;
+                NextIndex = *Existing;
+                Nodes[NextIndex].Cost = NextCost;
+                Nodes[NextIndex].Parent = Entry.Node;
+                Nodes[NextIndex].Action = ActionIndex;
+            }
+            else
+            {
+                if (Nodes.Num() >= MaxNodes)
+                {
+                    bHitNodeCap = true;
+                    continue;
+                }
+
+                // Dead ends are never stored
+                const float Heuristic = FGOAPPlanner::EstimateCost(*Domain, Next, Goal, &HeuristicActions, bRelaxedHeuristic);
+                if (Heuristic >= UE_BIG_NUMBER) continue;
+
+                NextIndex = Nodes.Add({ Next, NextCost, Heuristic, Entry.Node, ActionIndex });
+                BestNode.Add(Next, NextIndex);
+            }
+
+            if (Open.Num() >= MaxNodes)
+            {
+                bHitNodeCap = true;
+                continue;
+            }
+            Open.HeapPush({ NextCost + Weight * Nodes[NextIndex].Heuristic, NextCost, NextIndex });
+        }
+    }
+    return EStatus::Searching;
+}
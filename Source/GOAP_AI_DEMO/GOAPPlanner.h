@@ -0,0 +1,257 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GOAPTypes.h"
+#include "GOAPAction.h"
+
+// Partial world state over at most 64 facts: a fact is set when its Known bit is, and true when its Values bit is
+struct FGOAPWorldState
+{
+    uint64 Known = 0;
+    uint64 Values = 0;
+
+    // Every fact known in Required is known here with the same value
+    bool Satisfies(const FGOAPWorldState& Required) const
+    {
+        return (Known & Required.Known) == Required.Known && ((Values ^ Required.Values) & Required.Known) == 0;
+    }
+
+    // Number of facts in Required that are unknown or different here
+    int32 CountUnsatisfied(const FGOAPWorldState& Required) const
+    {
+        return FMath::CountBits(((Values ^ Required.Values) | ~Known) & Required.Known);
+    }
+
+    FGOAPWorldState WithEffects(const FGOAPWorldState& Effects) const
+    {
+        return { Known | Effects.Known, (Values & ~Effects.Known) | (Effects.Values & Effects.Known) };
+    }
+
+    bool operator==(const FGOAPWorldState& Other) const { return Known == Other.Known && Values == Other.Values; }
+
+    friend uint32 GetTypeHash(const FGOAPWorldState& State)
+    {
+        return HashCombineFast(GetTypeHash(State.Known), GetTypeHash(State.Values));
+    }
+};
+
+struct FGOAPCompiledAction
+{
+    FGOAPWorldState Preconditions;
+    FGOAPWorldState Effects;
+    float Cost = 1.f;
+    TSubclassOf<UGOAPAction> ActionClass;
+    EGOAPCrowdBehavior CrowdBehavior = EGOAPCrowdBehavior::Instant;
+};
+
+// Action set compiled from UGOAPAction defaults, with fact names mapped to bits.
+// Shared read-only by every agent, actor or Mass entity, that uses the same action classes.
+struct GOAP_AI_DEMO_API FGOAPDomain
+{
+    static constexpr int32 MaxFacts = 64;
+
+    // Compiles ActionClasses in order, skipping null entries. Returns null if the actions use more than MaxFacts facts.
+    static TSharedPtr<FGOAPDomain> Compile(TConstArrayView<TSubclassOf<UGOAPAction>> ActionClasses);
+
+    int32 FindFact(FName Fact) const;
+
+    // Facts the domain does not use are dropped
+    FGOAPWorldState MakeState(const TMap<FName, bool>& WorldState) const;
+
+    // False if the goal needs a fact no action touches and WorldState does not already satisfy it
+    bool MakeGoal(const FGOAPGoal& Goal, const TMap<FName, bool>& WorldState, FGOAPWorldState& OutGoal) const;
+
+    // Writes every known fact of State into WorldState
+    void ExportState(const FGOAPWorldState& State, TMap<FName, bool>& WorldState) const;
+
+    // Cost of an FF relaxed plan from State to Goal: actions chosen backwards through a planning graph
+    // in which effects never undo anything. UE_BIG_NUMBER when even that graph cannot reach Goal, in which
+    // case no real plan can either. Not admissible, but tracks how many actions are really needed.
+    float RelaxedPlanCost(const FGOAPWorldState& State, const FGOAPWorldState& Goal, const TBitArray<>* AllowedActions) const;
+
+    // Allowed actions that add a Goal literal or a precondition of another such action. Only these can
+    // reach the goal's part of a relaxed graph, so RelaxedPlanCost over them gives the same cost with less
+    // to grow. Worked out once per search rather than once per state.
+    TBitArray<> FindRelevantActions(const FGOAPWorldState& Goal, const TBitArray<>* AllowedActions) const;
+
+    // False when A and B can run in either order from any state that allows both, with the same result
+    bool Interferes(int32 A, int32 B) const { return Interference[A * Actions.Num() + B]; }
+
+    SIZE_T GetAllocatedSize() const
+    {
+        return FactNames.GetAllocatedSize() + Actions.GetAllocatedSize() + RelaxedActions.GetAllocatedSize() + Interference.GetAllocatedSize();
+    }
+
+    // An action's preconditions and effects as the fact values they need and add, for the relaxed planning graph
+    struct FRelaxedAction
+    {
+        uint64 NeedTrue = 0;
+        uint64 NeedFalse = 0;
+        uint64 AddTrue = 0;
+        uint64 AddFalse = 0;
+    };
+
+    TArray<FName> FactNames;
+    TArray<FGOAPCompiledAction> Actions;
+
+    // Parallel to Actions, built by Compile
+    TArray<FRelaxedAction> RelaxedActions;
+
+    // Actions.Num() squared bits, row-major, built by Compile
+    TBitArray<> Interference;
+};
+
+// Anytime planning in fixed memory: restarting weighted A* over at most MaxNodes states.
+// The first round searches greedily (g + 3h) and stops at the first plan. Each later round restarts
+// with a lower weight, pruning anything that cannot beat the best plan so far, until a round at
+// weight 1 ends or the node cap stops a round. Rounds that hit the cap before any plan is found
+// retry with a higher weight. Step can be called over several frames; buffers are reserved up front
+// and never grow past the cap.
+class GOAP_AI_DEMO_API FGOAPAnytimePlanner
+{
+public:
+    enum class EStatus : uint8
+    {
+        Searching,
+        Finished
+    };
+
+    // Domain must outlive the search
+    void Begin(const FGOAPDomain& Domain, const FGOAPWorldState& Start, const FGOAPWorldState& Goal,
+        const TBitArray<>* AllowedActions, int32 MaxNodes);
+
+    // Expands up to MaxExpansions states (0 means no limit)
+    EStatus Step(int32 MaxExpansions);
+
+    // Frees the search buffers
+    void Reset();
+
+    bool IsActive() const { return Domain != nullptr; }
+    bool HasPlan() const { return IncumbentCost < UE_BIG_NUMBER; }
+
+    // Best plan so far, as indices into Domain.Actions
+    const TArray<int32>& GetPlan() const { return Incumbent; }
+    float GetPlanCost() const { return IncumbentCost; }
+
+    int32 GetTotalExpansions() const { return TotalExpansions; }
+    uint64 GetTotalCycles() const { return TotalCycles; }
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    struct FSearchNode
+    {
+        FGOAPWorldState State;
+        float Cost;
+        float Heuristic;
+        int32 Parent;
+        int32 Action;
+    };
+
+    struct FOpenEntry
+    {
+        float Priority;
+        float Cost;
+        int32 Node;
+        bool operator<(const FOpenEntry& Other) const { return Priority < Other.Priority; }
+    };
+
+    void StartRound();
+
+    // Picks the next round's weight; false when the search is over
+    bool FinishRound(bool bFoundPlan);
+
+    const FGOAPDomain* Domain = nullptr;
+    FGOAPWorldState Start;
+    FGOAPWorldState Goal;
+    TBitArray<> AllowedActions;
+    TBitArray<> HeuristicActions;
+    int32 MaxNodes = 0;
+
+    float Weight = 1.f;
+    bool bHitNodeCap = false;
+    bool bRelaxedHeuristic = true;
+    bool bPruneOrderings = true;
+    bool bPruned = false;
+
+    TArray<FSearchNode> Nodes;
+    TArray<FOpenEntry> Open;
+    TMap<FGOAPWorldState, int32> BestNode;
+
+    TArray<int32> Incumbent;
+    float IncumbentCost = UE_BIG_NUMBER;
+
+    int32 TotalExpansions = 0;
+    uint64 TotalCycles = 0;
+};
+
+// Regression conditions of a plan, as in a STRIPS triangle table. Condition i is the partial state
+// from which steps i.. still reach the goal: step i's preconditions plus whatever later steps and
+// the goal need that step i does not itself provide. The last condition is the goal.
+struct GOAP_AI_DEMO_API FGOAPPlanMonitor
+{
+    void Build(const FGOAPDomain& Domain, TConstArrayView<int32> Plan, const FGOAPWorldState& Goal);
+    void Reset() { Conditions.Reset(); Reachable.Reset(); }
+
+    // Furthest step at or after FirstStep whose condition State satisfies. NumSteps() when the goal
+    // already holds, INDEX_NONE when no remaining step can reach it.
+    int32 FindResumeStep(const FGOAPWorldState& State, int32 FirstStep) const;
+
+    int32 NumSteps() const { return Conditions.Num() - 1; }
+    bool IsValid() const { return Conditions.Num() > 0; }
+
+private:
+    TArray<FGOAPWorldState> Conditions;
+
+    // False where a step's preconditions contradict what the rest of the plan needs
+    TBitArray<> Reachable;
+};
+
+// A* over compiled world states. Keeps its buffers between searches; use one per thread.
+class GOAP_AI_DEMO_API FGOAPPlanner
+{
+public:
+    // A low-cost action sequence from Start to a state satisfying Goal (not guaranteed optimal with
+    // ai.GOAP.RelaxedHeuristic), as indices into Domain.Actions.
+    // AllowedActions, if given, masks out actions whose procedural preconditions failed.
+    // Gives up after MaxExpansions expanded states; 0 means no limit.
+    bool FindPlan(const FGOAPDomain& Domain, const FGOAPWorldState& Start, const FGOAPWorldState& Goal,
+        int32 MaxExpansions, const TBitArray<>* AllowedActions, TArray<int32>& OutPlan);
+
+    int32 GetLastExpansions() const { return LastExpansions; }
+
+    // Heuristic the next search uses, ai.GOAP.RelaxedHeuristic picks between them
+    static float EstimateCost(const FGOAPDomain& Domain, const FGOAPWorldState& State, const FGOAPWorldState& Goal,
+        const TBitArray<>* AllowedActions, bool bRelaxed);
+    static bool UseRelaxedHeuristic();
+
+    // ai.GOAP.PruneOrderings: expand only one order of actions that do not interfere
+    static bool UsePartialOrderPruning();
+
+    // Search buffers kept between calls
+    SIZE_T GetAllocatedSize() const { return Nodes.GetAllocatedSize() + Open.GetAllocatedSize() + BestNode.GetAllocatedSize() + HeuristicActions.GetAllocatedSize(); }
+
+private:
+    struct FSearchNode
+    {
+        FGOAPWorldState State;
+        float Cost;
+        float Heuristic;
+        int32 Parent;
+        int32 Action;
+    };
+
+    struct FOpenEntry
+    {
+        float Priority;
+        int32 Node;
+        bool operator<(const FOpenEntry& Other) const { return Priority < Other.Priority; }
+    };
+
+    TArray<FSearchNode> Nodes;
+    TArray<FOpenEntry> Open;
+    TMap<FGOAPWorldState, int32> BestNode;
+    int32 LastExpansions = 0;
+
+    // Actions the relaxed heuristic grows its graph from during the current search
+    TBitArray<> HeuristicActions;
+};
@@ -0,0 +1,106 @@
+#include "GOAPPlannerSubsystem.h"
+#include "AIMemory.h"
+#include "GOAPStats.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarGOAPPlanCacheSize(
+    TEXT("ai.GOAP.PlanCacheSize"),
+    256,
+    TEXT("Plans kept per world before the plan cache is emptied; 0 disables the cache."));
+
+UGOAPPlannerSubsystem* UGOAPPlannerSubsystem::Get(const UWorld* World)
+{
+    return World ? World->GetSubsystem<UGOAPPlannerSubsystem>() : nullptr;
+}
+
+void UGOAPPlannerSubsystem::Deinitialize()
+{
+    PlanCache.Empty();
+    Domains.Empty();
+    Super::Deinitialize();
+}
+
+void UGOAPPlannerSubsystem::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+    Super::GetResourceSizeEx(CumulativeResourceSize);
+
+    SIZE_T Bytes = Domains.GetAllocatedSize() + Planner.GetAllocatedSize() + PlanCache.GetAllocatedSize();
+    for (const FDomainEntry& Entry : Domains)
+    {
+        Bytes += Entry.ActionClasses.GetAllocatedSize();
+        if (Entry.Domain) Bytes += sizeof(FGOAPDomain) + Entry.Domain->GetAllocatedSize();
+    }
+    for (const TPair<FPlanCacheKey, FCachedPlan>& Cached : PlanCache)
+    {
+        Bytes += Cached.Key.AllowedActions.GetAllocatedSize() + Cached.Value.Plan.GetAllocatedSize();
+    }
+    CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Bytes);
+}
+
+TStatId UGOAPPlannerSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UGOAPPlannerSubsystem, STATGROUP_Tickables);
+}
+
+void UGOAPPlannerSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    // Tickables run after every tick group, so the frame's agent ticks are all counted
+    GOAPStats::PublishFrame();
+}
+
+TSharedPtr<const FGOAPDomain> UGOAPPlannerSubsystem::GetDomain(const TArray<TSubclassOf<UGOAPAction>>& ActionClasses, int32* OutDomainId)
+{
+    LLM_SCOPE_BYTAG(AIGOAP);
+
+    int32 Index = Domains.IndexOfByPredicate([&ActionClasses](const FDomainEntry& Entry) { return Entry.ActionClasses == ActionClasses; });
+    if (Index == INDEX_NONE)
+    {
+        // Failed compiles are cached too, so they are only reported once
+        Index = Domains.Add({ ActionClasses, FGOAPDomain::Compile(ActionClasses) });
+    }
+
+    if (OutDomainId) *OutDomainId = Index;
+    return Domains[Index].Domain;
+}
+
+bool UGOAPPlannerSubsystem::FindPlan(const FGOAPDomain& Domain, const FGOAPWorldState& Start, const FGOAPWorldState& Goal,
+    int32 MaxExpansions, const TBitArray<>* AllowedActions, TArray<int32>& OutPlan)
+{
+    LLM_SCOPE_BYTAG(AIGOAP);
+
+    bLastSearchCutShort = false;
+
+    const int32 CacheSize = CVarGOAPPlanCacheSize.GetValueOnGameThread();
+    if (CacheSize <= 0)
+    {
+        const bool bFound = Planner.FindPlan(Domain, Start, Goal, MaxExpansions, AllowedActions, OutPlan);
+        bLastSearchCutShort = !bFound && MaxExpansions > 0 && Planner.GetLastExpansions() >= MaxExpansions;
+        return bFound;
+    }
+
+    FPlanCacheKey Key{ &Domain, Start, Goal, AllowedActions ? *AllowedActions : TBitArray<>(),
+        FGOAPPlanner::UseRelaxedHeuristic(), FGOAPPlanner::UsePartialOrderPruning() };
+    const FCachedPlan* Cached = PlanCache.Find(Key);
+    GOAPStats::RecordCacheLookup(Cached != nullptr);
+    if (Cached)
+    {
+        OutPlan = Cached->Plan;
+        return Cached->bFound;
+    }
+
+    const bool bFound = Planner.FindPlan(Domain, Start, Goal, MaxExpansions, AllowedActions, OutPlan);
+
+    // A longer search might still find a plan
+    bLastSearchCutShort = !bFound && MaxExpansions > 0 && Planner.GetLastExpansions() >= MaxExpansions;
+    if (bLastSearchCutShort) return false;
+
+    if (PlanCache.Num() >= CacheSize)
+    {
+        PlanCache.Reset();
+    }
+    PlanCache.Add(MoveTemp(Key), { OutPlan, bFound });
+    return bFound;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GOAPPlanner.h"
+#include "GOAPPlannerSubsystem.generated.h"
+
+// Compiled GOAP domains for the world, shared by every agent with the same action classes,
+// plus the planner game thread callers search with.
+// Plans are cached by domain, start state, goal and allowed actions, so agents in the same situation
+// share one search. The subsystem also publishes the GOAP stats once per frame.
+UCLASS()
+class GOAP_AI_DEMO_API UGOAPPlannerSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static UGOAPPlannerSubsystem* Get(const UWorld* World);
+
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    virtual void Deinitialize() override;
+    virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+    // Domain for ActionClasses, compiled on first use. Null if it needs more than FGOAPDomain::MaxFacts facts.
+    // OutDomainId, if given, receives a small id unique to the domain within this world.
+    TSharedPtr<const FGOAPDomain> GetDomain(const TArray<TSubclassOf<UGOAPAction>>& ActionClasses, int32* OutDomainId = nullptr);
+
+    // FGOAPPlanner::FindPlan through the plan cache. Searches cut short by MaxExpansions are not cached.
+    bool FindPlan(const FGOAPDomain& Domain, const FGOAPWorldState& Start, const FGOAPWorldState& Goal,
+        int32 MaxExpansions, const TBitArray<>* AllowedActions, TArray<int32>& OutPlan);
+
+    // Whether the last FindPlan failed because it ran out of MaxExpansions, so a larger limit might still succeed
+    bool WasLastSearchCutShort() const { return bLastSearchCutShort; }
+
+    // Game thread only
+    FGOAPPlanner& GetPlanner() { return Planner; }
+
+private:
+    struct FDomainEntry
+    {
+        TArray<TSubclassOf<UGOAPAction>> ActionClasses;
+        TSharedPtr<const FGOAPDomain> Domain;
+    };
+
+    struct FPlanCacheKey
+    {
+        const FGOAPDomain* Domain = nullptr;
+        FGOAPWorldState Start;
+        FGOAPWorldState Goal;
+        TBitArray<> AllowedActions;
+
+        // Search settings that change which plan is found: ai.GOAP.RelaxedHeuristic and ai.GOAP.PruneOrderings
+        bool bRelaxedHeuristic = false;
+        bool bPruneOrderings = false;
+
+        bool operator==(const FPlanCacheKey& Other) const
+        {
+            return Domain == Other.Domain && Start == Other.Start && Goal == Other.Goal && AllowedActions == Other.AllowedActions
+                && bRelaxedHeuristic == Other.bRelaxedHeuristic && bPruneOrderings == Other.bPruneOrderings;
+        }
+
+        friend uint32 GetTypeHash(const FPlanCacheKey& Key)
+        {
+            uint32 Hash = HashCombineFast(PointerHash(Key.Domain), HashCombineFast(GetTypeHash(Key.Start), GetTypeHash(Key.Goal)));
+            Hash = HashCombineFast(Hash, (Key.bRelaxedHeuristic ? 1u : 0u) | (Key.bPruneOrderings ? 2u : 0u));
+            if (Key.AllowedActions.Num() > 0)
+            {
+                Hash = FCrc::MemCrc32(Key.AllowedActions.GetData(), FMath::DivideAndRoundUp(Key.AllowedActions.Num(), NumBitsPerDWORD) * sizeof(uint32), Hash);
+            }
+            return Hash;
+        }
+    };
+
+    struct FCachedPlan
+    {
+        TArray<int32> Plan;
+        bool bFound = false;
+    };
+
+    TArray<FDomainEntry> Domains;
+    FGOAPPlanner Planner;
+
+    // Emptied when it reaches ai.GOAP.PlanCacheSize entries
+    TMap<FPlanCacheKey, FCachedPlan> PlanCache;
+
+    bool bLastSearchCutShort = false;
+};
@@ -0,0 +1,331 @@
+#include "GOAPSquadSubsystem.h"
+#include "AIMemory.h"
+#include "GOAPAgentComponent.h"
+#include "GOAPPlannerSubsystem.h"
+#include "AIManager.h"
+#include "ChaseAction.h"
+#include "SearchAction.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarSquadMaxFlankers(
+    TEXT("ai.Squad.MaxFlankers"),
+    2,
+    TEXT("Squad members sent to flank when the squad plan chases; the rest search."));
+
+namespace GOAPSquad
+{
+    // Sideways offset from the target flankers run to
+    constexpr float FlankDistance = 600.f;
+
+    int32 FindActionOfClass(const FGOAPDomain& Domain, const UClass* Class)
+    {
+        return Domain.Actions.IndexOfByPredicate([Class](const FGOAPCompiledAction& Action) { return Action.ActionClass && Action.ActionClass->IsChildOf(Class); });
+    }
+
+    // A squad plan only reaches the leader's goal, so members must share both its actions and its goal
+    bool FollowsLeader(const UGOAPAgentComponent& Member, const UGOAPAgentComponent& Leader)
+    {
+        if (Member.Domain != Leader.Domain) return false;
+
+        const TArray<FGOAPState>& Desired = Member.CurrentGoal.DesiredStates;
+        const TArray<FGOAPState>& LeaderDesired = Leader.CurrentGoal.DesiredStates;
+        if (Desired.Num() != LeaderDesired.Num()) return false;
+
+        for (const FGOAPState& State : Desired)
+        {
+            if (!LeaderDesired.ContainsByPredicate([&State](const FGOAPState& Other) { return Other.Key == State.Key && Other.Value == State.Value; }))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+UGOAPSquadSubsystem* UGOAPSquadSubsystem::Get(const UWorld* World)
+{
+    return World ? World->GetSubsystem<UGOAPSquadSubsystem>() : nullptr;
+}
+
+void UGOAPSquadSubsystem::Deinitialize()
+{
+    Squads.Empty();
+    Super::Deinitialize();
+}
+
+void UGOAPSquadSubsystem::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+    Super::GetResourceSizeEx(CumulativeResourceSize);
+
+    SIZE_T Bytes = Squads.GetAllocatedSize();
+    for (const FSquad& Squad : Squads)
+    {
+        Bytes += Squad.Members.GetAllocatedSize() + Squad.Plan.GetAllocatedSize();
+    }
+    CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Bytes);
+}
+
+TStatId UGOAPSquadSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UGOAPSquadSubsystem, STATGROUP_Tickables);
+}
+
+UGOAPSquadSubsystem::FSquad* UGOAPSquadSubsystem::FindSquad(FName Name)
+{
+    return Squads.FindByPredicate([Name](const FSquad& Squad) { return Squad.Name == Name; });
+}
+
+const UGOAPSquadSubsystem::FSquadMember* UGOAPSquadSubsystem::FindMember(const UGOAPAgentComponent* Member) const
+{
+    for (const FSquad& Squad : Squads)
+    {
+        if (const FSquadMember* Found = Squad.Members.FindByPredicate([Member](const FSquadMember& Entry) { return Entry.Agent.Get() == Member; }))
+        {
+            return Found;
+        }
+    }
+    return nullptr;
+}
+
+void UGOAPSquadSubsystem::RegisterMember(UGOAPAgentComponent* Member)
+{
+    LLM_SCOPE_BYTAG(AIGOAP);
+
+    if (!Member || Member->SquadName.IsNone() || FindMember(Member)) return;
+
+    FSquad* Squad = FindSquad(Member->SquadName);
+    if (!Squad)
+    {
+        Squad = &Squads.AddDefaulted_GetRef();
+        Squad->Name = Member->SquadName;
+    }
+    Squad->Members.Add({ Member, EGOAPSquadRole::None });
+
+    // The newcomer needs its part of a plan
+    Squad->bHasPlan = false;
+}
+
+void UGOAPSquadSubsystem::UnregisterMember(UGOAPAgentComponent* Member)
+{
+    for (FSquad& Squad : Squads)
+    {
+        if (Squad.Members.RemoveAll([Member](const FSquadMember& Entry) { return Entry.Agent.Get() == Member; }) > 0)
+        {
+            Squad.bHasPlan = false;
+        }
+    }
+}
+
+EGOAPSquadRole UGOAPSquadSubsystem::GetRole(const UGOAPAgentComponent* Member) const
+{
+    const FSquadMember* Found = FindMember(Member);
+    return Found ? Found->Role : EGOAPSquadRole::None;
+}
+
+bool UGOAPSquadSubsystem::RequestPlan(UGOAPAgentComponent* Member)
+{
+    if (!Member || !Member->Domain) return false;
+
+    FSquad* Squad = FindSquad(Member->SquadName);
+    if (!Squad) return false;
+
+    // Members with other actions or another goal plan alone
+    const FSquadMember* Leader = Squad->Members.FindByPredicate([](const FSquadMember& Entry) { return Entry.Agent.IsValid() && Entry.Agent->Domain; });
+    if (!Leader || !GOAPSquad::FollowsLeader(*Member, *Leader->Agent)) return false;
+
+    // Handed out on the next squad tick
+    Squad->bPlanRequested = true;
+    return true;
+}
+
+void UGOAPSquadSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+    LLM_SCOPE_BYTAG(AIGOAP);
+
+    for (int32 SquadIndex = Squads.Num() - 1; SquadIndex >= 0; --SquadIndex)
+    {
+        FSquad& Squad = Squads[SquadIndex];
+        Squad.Members.RemoveAll([](const FSquadMember& Entry) { return !Entry.Agent.IsValid(); });
+        if (Squad.Members.Num() == 0)
+        {
+            Squads.RemoveAtSwap(SquadIndex, EAllowShrinking::No);
+            continue;
+        }
+
+        const FSquadMember* LeaderEntry = Squad.Members.FindByPredicate([](const FSquadMember& Entry) { return Entry.Agent->Domain.IsValid(); });
+        if (!LeaderEntry) continue;
+
+        UGOAPAgentComponent& Leader = *LeaderEntry->Agent;
+        const FGOAPDomain& Domain = *Leader.Domain;
+
+        // Known if any member knows it, true if any member has it true
+        FGOAPWorldState SquadState;
+        for (const FSquadMember& Member : Squad.Members)
+        {
+            if (!GOAPSquad::FollowsLeader(*Member.Agent, Leader)) continue;
+
+            const FGOAPWorldState MemberState = Domain.MakeState(Member.Agent->WorldState);
+            SquadState.Known |= MemberState.Known;
+            SquadState.Values |= MemberState.Values & MemberState.Known;
+        }
+
+        if (Squad.bHasPlan && !Squad.bPlanRequested && SquadState == Squad.PlannedState) continue;
+
+        // A member asking again with nothing changed gets the same plan back without a search.
+        // No plan at all is searched for again, with the leader's limit raised if it cut the last one short.
+        if (Squad.bHasPlan && SquadState == Squad.PlannedState && Squad.Plan.Num() > 0)
+        {
+            AssignRoles(Squad, Leader, Squad.Plan, true);
+        }
+        else
+        {
+            PlanForSquad(Squad, Leader, SquadState);
+        }
+        Squad.bPlanRequested = false;
+    }
+}
+
+void UGOAPSquadSubsystem::PlanForSquad(FSquad& Squad, UGOAPAgentComponent& Leader, const FGOAPWorldState& SquadState)
+{
+    const FGOAPDomain& Domain = *Leader.Domain;
+    UGOAPPlannerSubsystem* PlannerSubsystem = UGOAPPlannerSubsystem::Get(GetWorld());
+    if (!PlannerSubsystem) return;
+
+    Squad.PlannedState = SquadState;
+    Squad.bHasPlan = true;
+    Squad.Plan.Reset();
+
+    TMap<FName, bool> SquadFacts;
+    Domain.ExportState(SquadState, SquadFacts);
+
+    FGOAPWorldState& Goal = Squad.Goal;
+    Goal = FGOAPWorldState();
+    if (Domain.MakeGoal(Leader.CurrentGoal, SquadFacts, Goal))
+    {
+        // The leader's action instances stand in for the squad's procedural preconditions
+        TBitArray<> AllowedActions(false, Leader.ActionInstances.Num());
+        for (int32 Index = 0; Index < Leader.ActionInstances.Num(); ++Index)
+        {
+            AllowedActions[Index] = Leader.ActionInstances[Index] && Leader.ActionInstances[Index]->CheckProceduralPrecondition(SquadFacts);
+        }
+
+        // The leader's search limit grows the same way it would if the leader planned alone
+        const bool bFoundPlan = PlannerSubsystem->FindPlan(Domain, SquadState, Goal, Leader.GetPlanExpansionLimit(), &AllowedActions, Squad.Plan);
+        Leader.RecordPlanSearch(bFoundPlan, PlannerSubsystem->WasLastSearchCutShort());
+        ++NumSquadPlans;
+    }
+
+    AssignRoles(Squad, Leader, Squad.Plan, false);
+}
+
+void UGOAPSquadSubsystem::AssignRoles(FSquad& Squad, const UGOAPAgentComponent& Leader, TConstArrayView<int32> SquadPlan, bool bIdleMembersOnly)
+{
+    const FGOAPDomain& Domain = *Leader.Domain;
+    const int32 ChaseAction = GOAPSquad::FindActionOfClass(Domain, UChaseAction::StaticClass());
+    const int32 SearchAction = GOAPSquad::FindActionOfClass(Domain, USearchAction::StaticClass());
+    // Roles are picked by distance to the target, so only once the squad has seen it and is about to chase
+    const bool bPlanChases = ChaseAction != INDEX_NONE && SquadPlan.Num() > 0 && SquadPlan[0] == ChaseAction;
+
+    // Searchers do not chase, so their part of the plan cannot reach what only the chase achieves
+    FGOAPWorldState SearchGoal = Squad.Goal;
+    if (ChaseAction != INDEX_NONE)
+    {
+        SearchGoal.Known &= ~Domain.Actions[ChaseAction].Effects.Known;
+    }
+
+    if (bPlanChases)
+    {
+        // Nearest to the most recently seen character chases
+        FVector TargetLocation = FVector::ZeroVector;
+        double LatestSeen = -UE_BIG_NUMBER;
+        if (const UAIManager* Manager = UAIManager::Get(GetWorld()))
+        {
+            for (const FVisibilityRecord& Record : Manager->GetVisibilityRecords())
+            {
+                if (Record.LastSeenTime > LatestSeen)
+                {
+                    LatestSeen = Record.LastSeenTime;
+                    TargetLocation = Record.LastKnownLocation;
+                }
+            }
+        }
+        if (LatestSeen == -UE_BIG_NUMBER)
+        {
+            if (const APawn* Player = UGameplayStatics::GetPlayerPawn(GetWorld(), 0))
+            {
+                TargetLocation = Player->GetActorLocation();
+            }
+        }
+
+        // Followers stay ahead of the rest, so the squad keeps a leader with the same goal
+        Squad.Members.Sort([&TargetLocation, &Leader](const FSquadMember& A, const FSquadMember& B)
+        {
+            const bool bAFollows = GOAPSquad::FollowsLeader(*A.Agent, Leader);
+            if (bAFollows != GOAPSquad::FollowsLeader(*B.Agent, Leader)) return bAFollows;
+
+            return FVector::DistSquared(A.Agent->GetOwner()->GetActorLocation(), TargetLocation)
+                < FVector::DistSquared(B.Agent->GetOwner()->GetActorLocation(), TargetLocation);
+        });
+    }
+
+    const int32 MaxFlankers = FMath::Max(CVarSquadMaxFlankers.GetValueOnGameThread(), 0);
+    int32 MemberIndex = 0;
+    TArray<int32, TInlineAllocator<16>> MemberPlan;
+    for (FSquadMember& Member : Squad.Members)
+    {
+        UGOAPAgentComponent& Agent = *Member.Agent;
+        if (!GOAPSquad::FollowsLeader(Agent, Leader)) continue;
+
+        Member.Role = EGOAPSquadRole::None;
+        int32 ReplaceChaseWith = ChaseAction;
+        if (bPlanChases)
+        {
+            if (MemberIndex == 0)
+            {
+                Member.Role = EGOAPSquadRole::Chase;
+            }
+            else if (MemberIndex <= MaxFlankers)
+            {
+                Member.Role = EGOAPSquadRole::Flank;
+            }
+            else
+            {
+                Member.Role = EGOAPSquadRole::Search;
+                ReplaceChaseWith = SearchAction != INDEX_NONE ? SearchAction : ChaseAction;
+            }
+        }
+
+        // Flankers alternate sides; everyone else chases straight at the target
+        if (ChaseAction != INDEX_NONE)
+        {
+            if (UChaseAction* Chase = Cast<UChaseAction>(Agent.ActionInstances[ChaseAction]))
+            {
+                Chase->FlankOffset = Member.Role == EGOAPSquadRole::Flank
+                    ? (MemberIndex % 2 ? 1.f : -1.f) * GOAPSquad::FlankDistance
+                    : 0.f;
+            }
+        }
+        ++MemberIndex;
+
+        if (bIdleMembersOnly && Agent.CurrentPlan.Num() > 0) continue;
+
+        // No plan reaches the goal; keep everyone doing what the baseline planner would
+        if (SquadPlan.Num() == 0)
+        {
+            Agent.BuildFallbackPlan();
+            continue;
+        }
+
+        MemberPlan.Reset();
+        for (const int32 Step : SquadPlan)
+        {
+            MemberPlan.Add(Step == ChaseAction ? ReplaceChaseWith : Step);
+        }
+
+        // Squad plans rely on what other members know, so they are checked against the squad state
+        Agent.SetPlan(MemberPlan, ReplaceChaseWith == ChaseAction ? &Squad.Goal : &SearchGoal, &Squad.PlannedState);
+    }
+}
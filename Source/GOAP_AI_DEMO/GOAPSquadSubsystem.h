@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GOAPPlanner.h"
+#include "GOAPSquadSubsystem.generated.h"
+
+class UGOAPAgentComponent;
+
+UENUM(BlueprintType)
+enum class EGOAPSquadRole : uint8
+{
+    None,
+    Chase,
+    Flank,
+    Search
+};
+
+// Plans once per squad instead of once per member.
+// Agents with the same UGOAPAgentComponent::SquadName share a squad world state: a fact is known if
+// any member knows it and true if any member has it true. The squad plans against that state whenever
+// it changes or a member runs out of plan. Members get their plans from the squad plan, by role:
+// once the plan's next step is a chase, the member nearest the target chases, up to ai.Squad.MaxFlankers
+// flank either side and the rest search. Members check their part against the squad state, so a fact
+// only one of them sensed keeps everyone's plan valid. The first member with a domain leads; members
+// whose actions or goal differ from the leader's plan alone. A squad with no plan falls back to each
+// member's UGOAPAgentComponent::BuildFallbackPlan.
+UCLASS()
+class GOAP_AI_DEMO_API UGOAPSquadSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static UGOAPSquadSubsystem* Get(const UWorld* World);
+
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    virtual void Deinitialize() override;
+    virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+    void RegisterMember(UGOAPAgentComponent* Member);
+    void UnregisterMember(UGOAPAgentComponent* Member);
+
+    // Called instead of planning alone. False if Member is not in a squad whose leader shares its domain and goal.
+    bool RequestPlan(UGOAPAgentComponent* Member);
+
+    EGOAPSquadRole GetRole(const UGOAPAgentComponent* Member) const;
+
+    int32 GetNumSquadPlans() const { return NumSquadPlans; }
+
+private:
+    struct FSquadMember
+    {
+        TWeakObjectPtr<UGOAPAgentComponent> Agent;
+        EGOAPSquadRole Role = EGOAPSquadRole::None;
+    };
+
+    struct FSquad
+    {
+        FName Name;
+        TArray<FSquadMember> Members;
+
+        // Squad plan as domain action indices, the state it was made for and the goal it reaches
+        TArray<int32> Plan;
+        FGOAPWorldState PlannedState;
+        FGOAPWorldState Goal;
+        bool bHasPlan = false;
+        bool bPlanRequested = false;
+    };
+
+    FSquad* FindSquad(FName Name);
+    const FSquadMember* FindMember(const UGOAPAgentComponent* Member) const;
+
+    // Plans for the squad and hands every member its part
+    void PlanForSquad(FSquad& Squad, UGOAPAgentComponent& Leader, const FGOAPWorldState& SquadState);
+
+    // Picks roles and derives plans from SquadPlan for the members following Leader; bIdleMembersOnly leaves busy members' plans alone
+    void AssignRoles(FSquad& Squad, const UGOAPAgentComponent& Leader, TConstArrayView<int32> SquadPlan, bool bIdleMembersOnly);
+
+    TArray<FSquad> Squads;
+    int32 NumSquadPlans = 0;
+};
@@ -0,0 +1,140 @@
+#include "GOAPStats.h"
+#include <atomic>
+
+DEFINE_STAT(STAT_GOAP_Planning);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Plans Built"), STAT_GOAP_PlansBuilt, STATGROUP_GOAP);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Avg Nodes Expanded"), STAT_GOAP_AvgExpansions, STATGROUP_GOAP);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Max Nodes Expanded"), STAT_GOAP_MaxExpansions, STATGROUP_GOAP);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Plan Cache Hit Rate %"), STAT_GOAP_CacheHitRate, STATGROUP_GOAP);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Perception Replans"), STAT_GOAP_PerceptionReplans, STATGROUP_GOAP);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Actions Executed"), STAT_GOAP_ActionsExecuted, STATGROUP_GOAP);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Chase Moves"), STAT_GOAP_ChaseMoves, STATGROUP_GOAP);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Agents Awake"), STAT_GOAP_AgentsAwake, STATGROUP_GOAP);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Agents Sleeping"), STAT_GOAP_AgentsSleeping, STATGROUP_GOAP);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Sight ms"), STAT_GOAP_SightMs, STATGROUP_GOAP);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Flow Field ms"), STAT_GOAP_FlowFieldMs, STATGROUP_GOAP);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Async Paths ms"), STAT_GOAP_AsyncPathsMs, STATGROUP_GOAP);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Significance ms"), STAT_GOAP_SignificanceMs, STATGROUP_GOAP);
+
+CSV_DEFINE_CATEGORY_MODULE(GOAP_AI_DEMO_API, GOAP, true);
+
+namespace GOAPStats
+{
+    // This frame's counters
+    static std::atomic<int32> Searches{ 0 };
+    static std::atomic<int32> Expansions{ 0 };
+    static std::atomic<uint64> PlanningCycles{ 0 };
+    static std::atomic<int32> MaxExpansions{ 0 };
+    static std::atomic<int32> CacheLookups{ 0 };
+    static std::atomic<int32> CacheHits{ 0 };
+    static std::atomic<int32> PerceptionReplans{ 0 };
+    static std::atomic<int32> ActionsExecuted{ 0 };
+    static std::atomic<int32> ChaseMoves{ 0 };
+    static std::atomic<int32> AgentsAwake{ 0 };
+    static std::atomic<uint64> SubsystemCycles[(int32)EGOAPTimedSubsystem::Num];
+
+    // Not reset per frame
+    static std::atomic<int32> NumAgents{ 0 };
+    static uint64 LastPublishedFrame = 0;
+    static FGOAPFrameCounters LastFrame;
+
+    void RecordSearch(int32 NodesExpanded, uint64 Cycles)
+    {
+        ++Searches;
+        Expansions += NodesExpanded;
+        PlanningCycles += Cycles;
+
+        int32 Max = MaxExpansions.load();
+        while (NodesExpanded > Max && !MaxExpansions.compare_exchange_weak(Max, NodesExpanded)) {}
+    }
+
+    void RecordCacheLookup(bool bHit)
+    {
+        ++CacheLookups;
+        if (bHit) ++CacheHits;
+    }
+
+    void RecordPerceptionReplan() { ++PerceptionReplans; }
+    void RecordActionExecuted() { ++ActionsExecuted; }
+    void RecordChaseMove() { ++ChaseMoves; }
+    void RecordAgentAwake() { ++AgentsAwake; }
+    void AddAgent() { ++NumAgents; }
+    void RemoveAgent() { --NumAgents; }
+
+    void RecordSubsystemTime(EGOAPTimedSubsystem Subsystem, uint64 Cycles)
+    {
+        SubsystemCycles[(int32)Subsystem] += Cycles;
+    }
+
+    void PublishFrame()
+    {
+        check(IsInGameThread());
+        if (LastPublishedFrame == GFrameCounter) return;
+        LastPublishedFrame = GFrameCounter;
+
+        const int32 FrameSearches = Searches.exchange(0);
+        const int32 FrameExpansions = Expansions.exchange(0);
+        const uint64 FrameCycles = PlanningCycles.exchange(0);
+        const int32 FrameMaxExpansions = MaxExpansions.exchange(0);
+        const int32 FrameLookups = CacheLookups.exchange(0);
+        const int32 FrameHits = CacheHits.exchange(0);
+        const int32 FramePerceptionReplans = PerceptionReplans.exchange(0);
+        const int32 FrameActions = ActionsExecuted.exchange(0);
+        const int32 FrameChaseMoves = ChaseMoves.exchange(0);
+        const int32 Awake = AgentsAwake.exchange(0);
+        const int32 Sleeping = FMath::Max(NumAgents.load() - Awake, 0);
+
+        const float AvgExpansions = FrameSearches > 0 ? (float)FrameExpansions / FrameSearches : 0.f;
+        const float CacheHitRate = FrameLookups > 0 ? 100.f * FrameHits / FrameLookups : 0.f;
+
+        LastFrame.PlansBuilt = FrameSearches;
+        LastFrame.PlanningMs = (float)FPlatformTime::ToMilliseconds64(FrameCycles);
+        LastFrame.AvgExpansions = AvgExpansions;
+        LastFrame.MaxExpansions = FrameMaxExpansions;
+        LastFrame.CacheHitRate = CacheHitRate;
+        LastFrame.PerceptionReplans = FramePerceptionReplans;
+        LastFrame.ActionsExecuted = FrameActions;
+        LastFrame.ChaseMoves = FrameChaseMoves;
+        LastFrame.AgentsAwake = Awake;
+        LastFrame.AgentsSleeping = Sleeping;
+        for (int32 Index = 0; Index < (int32)EGOAPTimedSubsystem::Num; ++Index)
+        {
+            LastFrame.SubsystemMs[Index] = (float)FPlatformTime::ToMilliseconds64(SubsystemCycles[Index].exchange(0));
+        }
+        const float* SubsystemMs = LastFrame.SubsystemMs;
+
+        SET_DWORD_STAT(STAT_GOAP_PlansBuilt, FrameSearches);
+        SET_FLOAT_STAT(STAT_GOAP_AvgExpansions, AvgExpansions);
+        SET_DWORD_STAT(STAT_GOAP_MaxExpansions, FrameMaxExpansions);
+        SET_FLOAT_STAT(STAT_GOAP_CacheHitRate, CacheHitRate);
+        SET_DWORD_STAT(STAT_GOAP_PerceptionReplans, FramePerceptionReplans);
+        SET_DWORD_STAT(STAT_GOAP_ActionsExecuted, FrameActions);
+        SET_DWORD_STAT(STAT_GOAP_ChaseMoves, FrameChaseMoves);
+        SET_DWORD_STAT(STAT_GOAP_AgentsAwake, Awake);
+        SET_DWORD_STAT(STAT_GOAP_AgentsSleeping, Sleeping);
+        SET_FLOAT_STAT(STAT_GOAP_SightMs, SubsystemMs[(int32)EGOAPTimedSubsystem::Sight]);
+        SET_FLOAT_STAT(STAT_GOAP_FlowFieldMs, SubsystemMs[(int32)EGOAPTimedSubsystem::FlowField]);
+        SET_FLOAT_STAT(STAT_GOAP_AsyncPathsMs, SubsystemMs[(int32)EGOAPTimedSubsystem::AsyncPaths]);
+        SET_FLOAT_STAT(STAT_GOAP_SignificanceMs, SubsystemMs[(int32)EGOAPTimedSubsystem::Significance]);
+
+        CSV_CUSTOM_STAT(GOAP, PlansBuilt, FrameSearches, ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(GOAP, AvgNodesExpanded, AvgExpansions, ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(GOAP, MaxNodesExpanded, FrameMaxExpansions, ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(GOAP, PlanCacheHitRate, CacheHitRate, ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(GOAP, PerceptionReplans, FramePerceptionReplans, ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(GOAP, ActionsExecuted, FrameActions, ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(GOAP, ChaseMoves, FrameChaseMoves, ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(GOAP, AgentsAwake, Awake, ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(GOAP, AgentsSleeping, Sleeping, ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(GOAP, SightMs, SubsystemMs[(int32)EGOAPTimedSubsystem::Sight], ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(GOAP, FlowFieldMs, SubsystemMs[(int32)EGOAPTimedSubsystem::FlowField], ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(GOAP, AsyncPathsMs, SubsystemMs[(int32)EGOAPTimedSubsystem::AsyncPaths], ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(GOAP, SignificanceMs, SubsystemMs[(int32)EGOAPTimedSubsystem::Significance], ECsvCustomStatOp::Set);
+    }
+
+    const FGOAPFrameCounters& GetLastFrame()
+    {
+        return LastFrame;
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+// "stat goap" and the GOAP CSV profiler category. Counters are gathered from planners, the plan cache,
+// agent components and the other AI subsystems during the frame and published once per frame by UGOAPPlannerSubsystem.
+DECLARE_STATS_GROUP(TEXT("GOAP"), STATGROUP_GOAP, STATCAT_Advanced);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Planning"), STAT_GOAP_Planning, STATGROUP_GOAP, GOAP_AI_DEMO_API);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(GOAP_AI_DEMO_API, GOAP);
+
+// AI subsystems whose game thread time is published with the GOAP counters
+enum class EGOAPTimedSubsystem : uint8
+{
+    Sight,
+    FlowField,
+    AsyncPaths,
+    Significance,
+    Num
+};
+
+// Counters as last published
+struct FGOAPFrameCounters
+{
+    int32 PlansBuilt = 0;
+    float PlanningMs = 0.f;
+    float AvgExpansions = 0.f;
+    int32 MaxExpansions = 0;
+    float CacheHitRate = 0.f;
+    int32 PerceptionReplans = 0;
+    int32 ActionsExecuted = 0;
+    int32 ChaseMoves = 0;
+    int32 AgentsAwake = 0;
+    int32 AgentsSleeping = 0;
+
+    // Indexed by EGOAPTimedSubsystem
+    float SubsystemMs[(int32)EGOAPTimedSubsystem::Num] = {};
+};
+
+// Thread safe; Mass crowd processors plan off the game thread
+namespace GOAPStats
+{
+    // One search, whether it found a plan or not. Cycles is its FPlatformTime::Cycles64 duration.
+    GOAP_AI_DEMO_API void RecordSearch(int32 Expansions, uint64 Cycles);
+
+    GOAP_AI_DEMO_API void RecordCacheLookup(bool bHit);
+    GOAP_AI_DEMO_API void RecordPerceptionReplan();
+    GOAP_AI_DEMO_API void RecordActionExecuted();
+
+    // One move issued by a chasing agent: a flow field hop, a flank or the final approach
+    GOAP_AI_DEMO_API void RecordChaseMove();
+
+    // Agents that ticked this frame with a goal still to reach; every other registered agent is asleep
+    GOAP_AI_DEMO_API void RecordAgentAwake();
+    GOAP_AI_DEMO_API void AddAgent();
+    GOAP_AI_DEMO_API void RemoveAgent();
+
+    // Cycles is an FPlatformTime::Cycles64 duration spent in Subsystem this frame
+    GOAP_AI_DEMO_API void RecordSubsystemTime(EGOAPTimedSubsystem Subsystem, uint64 Cycles);
+
+    // Records the time until the end of the scope against Subsystem
+    struct FScopedSubsystemTimer
+    {
+        explicit FScopedSubsystemTimer(EGOAPTimedSubsystem InSubsystem)
+            : Subsystem(InSubsystem), StartCycles(FPlatformTime::Cycles64()) {}
+        ~FScopedSubsystemTimer() { RecordSubsystemTime(Subsystem, FPlatformTime::Cycles64() - StartCycles); }
+
+        EGOAPTimedSubsystem Subsystem;
+        uint64 StartCycles;
+    };
+
+    // Pushes this frame's counters to the stat group and CSV profiler, then resets them.
+    // Only the first call in a frame publishes.
+    GOAP_AI_DEMO_API void PublishFrame();
+
+    GOAP_AI_DEMO_API const FGOAPFrameCounters& GetLastFrame();
+}
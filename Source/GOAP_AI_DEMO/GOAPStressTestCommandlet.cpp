@@ -0,0 +1,429 @@
+#include "GOAPStressTestCommandlet.h"
+#include "AI_Character.h"
+#include "GOAP_AI_DEMOCharacter.h"
+#include "GOAPAgentComponent.h"
+#include "GOAPCrowdSubsystem.h"
+#include "GOAPStats.h"
+#include "ChaseAction.h"
+#include "PatrolAreaAction.h"
+#include "SearchAction.h"
+#include "SightSubsystem.h"
+#include "Node.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerStart.h"
+#include "Containers/Ticker.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGOAPStressTest, Log, All);
+
+namespace GOAPStressTest
+{
+    // Metrics compared against the baseline; lower is better for all of them
+    static const TCHAR* GatedMetrics[] =
+    {
+        TEXT("frame_ms.p50"),
+        TEXT("frame_ms.p90"),
+        TEXT("frame_ms.p99"),
+        TEXT("planning_ms.p50"),
+        TEXT("planning_ms.p99"),
+    };
+
+    // Run settings that must match the baseline's for its numbers to mean anything
+    static const TCHAR* ConfigFields[] =
+    {
+        TEXT("agents"),
+        TEXT("crowd_agents"),
+        TEXT("grid"),
+        TEXT("spacing"),
+        TEXT("step"),
+    };
+
+    // JSON group for each EGOAPTimedSubsystem
+    static const TCHAR* SubsystemFields[] =
+    {
+        TEXT("sight_ms"),
+        TEXT("flow_field_ms"),
+        TEXT("async_paths_ms"),
+        TEXT("significance_ms"),
+    };
+    static_assert(UE_ARRAY_COUNT(SubsystemFields) == (int32)EGOAPTimedSubsystem::Num, "One JSON field per timed subsystem");
+
+    static double Percentile(TArray<double>& SortedSamples, double Fraction)
+    {
+        if (SortedSamples.Num() == 0) return 0.0;
+        const int32 Index = FMath::Clamp(FMath::CeilToInt(Fraction * SortedSamples.Num()) - 1, 0, SortedSamples.Num() - 1);
+        return SortedSamples[Index];
+    }
+
+    // {"p50", "p90", "p99", "max", "mean"} for Samples
+    static TSharedRef<FJsonObject> Summarize(TArray<double> Samples)
+    {
+        Samples.Sort();
+        double Sum = 0.0;
+        for (const double Sample : Samples) Sum += Sample;
+
+        TSharedRef<FJsonObject> Summary = MakeShared<FJsonObject>();
+        Summary->SetNumberField(TEXT("p50"), Percentile(Samples, 0.5));
+        Summary->SetNumberField(TEXT("p90"), Percentile(Samples, 0.9));
+        Summary->SetNumberField(TEXT("p99"), Percentile(Samples, 0.99));
+        Summary->SetNumberField(TEXT("max"), Samples.Num() > 0 ? Samples.Last() : 0.0);
+        Summary->SetNumberField(TEXT("mean"), Samples.Num() > 0 ? Sum / Samples.Num() : 0.0);
+        return Summary;
+    }
+
+    // "group.field" lookup; false if either is missing
+    static bool FindMetric(const FJsonObject& Results, const FString& Path, double& OutValue)
+    {
+        FString Group, Field;
+        if (!Path.Split(TEXT("."), &Group, &Field)) return false;
+
+        const TSharedPtr<FJsonObject>* GroupObject = nullptr;
+        return Results.TryGetObjectField(Group, GroupObject) && (*GroupObject)->TryGetNumberField(Field, OutValue);
+    }
+}
+
+UGOAPStressTestCommandlet::UGOAPStressTestCommandlet()
+{
+    IsClient = false;
+    IsEditor = true;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+void UGOAPStressTestCommandlet::SpawnNodeGrid(UWorld& World, const FVector& Center, int32 GridSize, float Spacing, TArray<ANode*>& OutNodes) const
+{
+    const FVector Origin = Center - FVector(Spacing * (GridSize - 1) * 0.5f, Spacing * (GridSize - 1) * 0.5f, 0.f);
+    for (int32 Y = 0; Y < GridSize; ++Y)
+    {
+        for (int32 X = 0; X < GridSize; ++X)
+        {
+            OutNodes.Add(World.SpawnActor<ANode>(Origin + FVector(X * Spacing, Y * Spacing, 0.f), FRotator::ZeroRotator));
+        }
+    }
+
+    for (int32 Y = 0; Y < GridSize; ++Y)
+    {
+        for (int32 X = 0; X < GridSize; ++X)
+        {
+            ANode* Node = OutNodes[Y * GridSize + X];
+            if (!Node) continue;
+
+            if (X > 0 && OutNodes[Y * GridSize + X - 1]) Node->LinkedNodes.Add(OutNodes[Y * GridSize + X - 1], ENodeConnectionType::Walking);
+            if (X + 1 < GridSize && OutNodes[Y * GridSize + X + 1]) Node->LinkedNodes.Add(OutNodes[Y * GridSize + X + 1], ENodeConnectionType::Walking);
+            if (Y > 0 && OutNodes[(Y - 1) * GridSize + X]) Node->LinkedNodes.Add(OutNodes[(Y - 1) * GridSize + X], ENodeConnectionType::Walking);
+            if (Y + 1 < GridSize && OutNodes[(Y + 1) * GridSize + X]) Node->LinkedNodes.Add(OutNodes[(Y + 1) * GridSize + X], ENodeConnectionType::Walking);
+        }
+    }
+}
+
+AAI_Character* UGOAPStressTestCommandlet::SpawnAgent(UWorld& World, UClass* AgentClass, const TArray<ANode*>& Route) const
+{
+    const FTransform Transform(Route[0]->GetActorLocation() + FVector(0.f, 0.f, 100.f));
+    AAI_Character* Agent = World.SpawnActorDeferred<AAI_Character>(AgentClass, Transform, nullptr, nullptr,
+        ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+    if (!Agent) return nullptr;
+
+    Agent->AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
+    Agent->PatrolPath = Route;
+
+    // The native class leaves its agent component to Blueprints; give it the demo's patrol/chase setup
+    if (!Agent->GOAPAgentComponent)
+    {
+        UGOAPAgentComponent* GOAPAgent = NewObject<UGOAPAgentComponent>(Agent, TEXT("GOAPAgentComponent"));
+        GOAPAgent->AvailableActionTypes = { UPatrolAreaAction::StaticClass(), UChaseAction::StaticClass(), USearchAction::StaticClass() };
+        GOAPAgent->WorldState.Add("IsIdle", true);
+        Agent->AddInstanceComponent(GOAPAgent);
+        GOAPAgent->RegisterComponent();
+        Agent->GOAPAgentComponent = GOAPAgent;
+    }
+
+    Agent->FinishSpawning(Transform);
+    return Agent;
+}
+
+int32 UGOAPStressTestCommandlet::Main(const FString& Params)
+{
+    int32 NumAgents = 200;
+    int32 NumCrowdAgents = 0;
+    int32 GridSize = 8;
+    float Spacing = 400.f;
+    float Seconds = 60.f;
+    float Warmup = 2.f;
+    float Step = 1.f / 60.f;
+    float Threshold = 0.1f;
+    FString MapName = TEXT("/Game/FirstPerson/Maps/FirstPersonMap");
+    FString AgentClassPath;
+    FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Profiling") / TEXT("GOAPStressTest.json");
+    FString BaselinePath = FPaths::ProjectDir() / TEXT("Build") / TEXT("GOAPStressTestBaseline.json");
+
+    FParse::Value(*Params, TEXT("Agents="), NumAgents);
+    FParse::Value(*Params, TEXT("CrowdAgents="), NumCrowdAgents);
+    FParse::Value(*Params, TEXT("Grid="), GridSize);
+    FParse::Value(*Params, TEXT("Spacing="), Spacing);
+    FParse::Value(*Params, TEXT("Seconds="), Seconds);
+    FParse::Value(*Params, TEXT("Warmup="), Warmup);
+    FParse::Value(*Params, TEXT("Step="), Step);
+    FParse::Value(*Params, TEXT("Threshold="), Threshold);
+    FParse::Value(*Params, TEXT("Map="), MapName);
+    FParse::Value(*Params, TEXT("AgentClass="), AgentClassPath);
+    FParse::Value(*Params, TEXT("Output="), OutputPath);
+    FParse::Value(*Params, TEXT("Baseline="), BaselinePath);
+    if (FParse::Param(*Params, TEXT("NoBaseline")))
+    {
+        BaselinePath.Reset();
+    }
+    const bool bUpdateBaseline = FParse::Param(*Params, TEXT("UpdateBaseline"));
+
+    GridSize = FMath::Max(GridSize, 2);
+    Step = FMath::Max(Step, KINDA_SMALL_NUMBER);
+
+    UClass* AgentClass = AAI_Character::StaticClass();
+    if (!AgentClassPath.IsEmpty())
+    {
+        AgentClass = LoadClass<AAI_Character>(nullptr, *AgentClassPath);
+        if (!AgentClass)
+        {
+            UE_LOG(LogGOAPStressTest, Error, TEXT("Could not load agent class %s."), *AgentClassPath);
+            return 1;
+        }
+    }
+
+    // A standalone game instance gives the map a game mode, world subsystems and Mass, as in a packaged game
+    UGameInstance* GameInstance = NewObject<UGameInstance>(GEngine);
+    GameInstance->AddToRoot();
+    GameInstance->InitializeStandalone();
+
+    FWorldContext& Context = *GameInstance->GetWorldContext();
+    FString Error;
+    if (!GEngine->LoadMap(Context, FURL(*MapName), nullptr, Error))
+    {
+        UE_LOG(LogGOAPStressTest, Error, TEXT("Could not load %s: %s"), *MapName, *Error);
+        GameInstance->RemoveFromRoot();
+        return 1;
+    }
+    UWorld* World = Context.World();
+
+    FVector Center = FVector::ZeroVector;
+    for (TActorIterator<APlayerStart> It(World); It; ++It)
+    {
+        Center = It->GetActorLocation();
+        break;
+    }
+
+    TArray<ANode*> Nodes;
+    SpawnNodeGrid(*World, Center, GridSize, Spacing, Nodes);
+
+    // Square loops of four nodes, one per agent, spread over the grid
+    const int32 NumRouteStarts = (GridSize - 1) * (GridSize - 1);
+    int32 NumSpawned = 0;
+    AAI_Character* FirstAgent = nullptr;
+    for (int32 Index = 0; Index < NumAgents; ++Index)
+    {
+        const int32 Start = Index % NumRouteStarts;
+        const int32 X = Start % (GridSize - 1);
+        const int32 Y = Start / (GridSize - 1);
+        const TArray<ANode*> Route = {
+            Nodes[Y * GridSize + X], Nodes[Y * GridSize + X + 1],
+            Nodes[(Y + 1) * GridSize + X + 1], Nodes[(Y + 1) * GridSize + X] };
+        if (Route.Contains(nullptr)) continue;
+
+        AAI_Character* Agent = SpawnAgent(*World, AgentClass, Route);
+        if (!Agent) continue;
+
+        FirstAgent = FirstAgent ? FirstAgent : Agent;
+        ++NumSpawned;
+    }
+
+    // Crowd entities run the first agent's setup around the edge of the grid
+    int32 NumCrowdSpawned = 0;
+    UGOAPCrowdSubsystem* Crowd = UGOAPCrowdSubsystem::Get(World);
+    if (NumCrowdAgents > 0 && Crowd && FirstAgent)
+    {
+        const TArray<ANode*> Route = {
+            Nodes[0], Nodes[GridSize - 1], Nodes[GridSize * GridSize - 1], Nodes[(GridSize - 1) * GridSize] };
+        NumCrowdSpawned = Crowd->SpawnAgentsLike(*FirstAgent, NumCrowdAgents, Route);
+    }
+    else if (NumCrowdAgents > 0)
+    {
+        UE_LOG(LogGOAPStressTest, Warning, TEXT("Crowd agents need the crowd subsystem and at least one agent to copy; none spawned."));
+    }
+
+    // Stands in for the player: circles the grid so agents keep seeing and losing it
+    const float TargetRadius = Spacing * (GridSize - 1) * 0.4f;
+    APawn* Target = World->SpawnActor<AGOAP_AI_DEMOCharacter>(AGOAP_AI_DEMOCharacter::StaticClass(), Center + FVector(TargetRadius, 0.f, 100.f), FRotator::ZeroRotator);
+    if (Target)
+    {
+        if (USightSubsystem* Sight = USightSubsystem::Get(World))
+        {
+            Sight->RegisterTarget(Target);
+        }
+    }
+
+    UE_LOG(LogGOAPStressTest, Display, TEXT("Running %d agents and %d crowd agents on a %dx%d grid for %.1fs (+%.1fs warmup) at %.4fs steps."),
+        NumSpawned, NumCrowdSpawned, GridSize, GridSize, Seconds, Warmup, Step);
+
+    FApp::SetUseFixedTimeStep(true);
+    FApp::SetFixedDeltaTime(Step);
+
+    const int32 NumWarmupFrames = FMath::CeilToInt(Warmup / Step);
+    const int32 NumFrames = FMath::CeilToInt(Seconds / Step);
+    TArray<double> FrameMs, PlanningMs, PlansBuilt, ActionsExecuted, ChaseMoves, AgentsAwake, SightTraces;
+    int32 TotalChaseMoves = 0;
+    TArray<double> SubsystemMs[(int32)EGOAPTimedSubsystem::Num];
+    FrameMs.Reserve(NumFrames);
+
+    for (int32 Frame = 0; Frame < NumWarmupFrames + NumFrames; ++Frame)
+    {
+        const float SimTime = Frame * Step;
+        if (Target)
+        {
+            Target->SetActorLocation(Center + FVector(FMath::Cos(SimTime * 0.5f) * TargetRadius, FMath::Sin(SimTime * 0.5f) * TargetRadius, 100.f));
+        }
+
+        ++GFrameCounter;
+        FApp::SetDeltaTime(Step);
+        FApp::SetCurrentTime(FApp::GetCurrentTime() + Step);
+
+        const double StartTime = FPlatformTime::Seconds();
+        World->Tick(LEVELTICK_All, Step);
+        FTSTicker::GetCoreTicker().Tick(Step);
+        FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+        const double EndTime = FPlatformTime::Seconds();
+
+        if (Frame < NumWarmupFrames) continue;
+
+        const FGOAPFrameCounters& Counters = GOAPStats::GetLastFrame();
+        FrameMs.Add((EndTime - StartTime) * 1000.0);
+        PlanningMs.Add(Counters.PlanningMs);
+        PlansBuilt.Add(Counters.PlansBuilt);
+        ActionsExecuted.Add(Counters.ActionsExecuted);
+        ChaseMoves.Add(Counters.ChaseMoves);
+        TotalChaseMoves += Counters.ChaseMoves;
+        AgentsAwake.Add(Counters.AgentsAwake);
+        for (int32 Index = 0; Index < (int32)EGOAPTimedSubsystem::Num; ++Index)
+        {
+            SubsystemMs[Index].Add(Counters.SubsystemMs[Index]);
+        }
+        if (const USightSubsystem* Sight = USightSubsystem::Get(World))
+        {
+            SightTraces.Add(Sight->GetNumTracesLastFrame());
+        }
+    }
+
+    TSharedRef<FJsonObject> Results = MakeShared<FJsonObject>();
+    Results->SetStringField(TEXT("map"), MapName);
+    Results->SetNumberField(TEXT("agents"), NumSpawned);
+    Results->SetNumberField(TEXT("crowd_agents"), NumCrowdSpawned);
+    Results->SetNumberField(TEXT("grid"), GridSize);
+    Results->SetNumberField(TEXT("spacing"), Spacing);
+    Results->SetNumberField(TEXT("frames"), FrameMs.Num());
+    Results->SetNumberField(TEXT("step"), Step);
+    Results->SetObjectField(TEXT("frame_ms"), GOAPStressTest::Summarize(FrameMs));
+    Results->SetObjectField(TEXT("planning_ms"), GOAPStressTest::Summarize(PlanningMs));
+    Results->SetObjectField(TEXT("plans_per_frame"), GOAPStressTest::Summarize(PlansBuilt));
+    Results->SetObjectField(TEXT("actions_per_frame"), GOAPStressTest::Summarize(ActionsExecuted));
+    Results->SetObjectField(TEXT("chase_moves_per_frame"), GOAPStressTest::Summarize(ChaseMoves));
+    Results->SetObjectField(TEXT("agents_awake"), GOAPStressTest::Summarize(AgentsAwake));
+    Results->SetObjectField(TEXT("sight_traces_per_frame"), GOAPStressTest::Summarize(SightTraces));
+    for (int32 Index = 0; Index < (int32)EGOAPTimedSubsystem::Num; ++Index)
+    {
+        Results->SetObjectField(GOAPStressTest::SubsystemFields[Index], GOAPStressTest::Summarize(SubsystemMs[Index]));
+    }
+
+    FString Json;
+    FJsonSerializer::Serialize(Results, TJsonWriterFactory<>::Create(&Json));
+    FFileHelper::SaveStringToFile(Json, *OutputPath);
+    UE_LOG(LogGOAPStressTest, Display, TEXT("Results written to %s:\n%s"), *OutputPath, *Json);
+
+    GEngine->DestroyWorldContext(World);
+    World->DestroyWorld(false);
+    GameInstance->RemoveFromRoot();
+
+    // The target passes every agent's route, so a run in which nobody chased it measured the wrong thing
+    if (NumSpawned > 0 && Target && TotalChaseMoves == 0)
+    {
+        UE_LOG(LogGOAPStressTest, Error, TEXT("No agent chased the target; the chase and flow field code went unmeasured."));
+        return 1;
+    }
+
+    if (BaselinePath.IsEmpty()) return 0;
+
+    if (bUpdateBaseline)
+    {
+        // Measured on this machine; commit it to gate later runs against it
+        if (!FFileHelper::SaveStringToFile(Json, *BaselinePath))
+        {
+            UE_LOG(LogGOAPStressTest, Error, TEXT("Could not write baseline %s."), *BaselinePath);
+            return 1;
+        }
+        UE_LOG(LogGOAPStressTest, Display, TEXT("Baseline %s updated from this run."), *BaselinePath);
+        return 0;
+    }
+
+    FString BaselineJson;
+    TSharedPtr<FJsonObject> Baseline;
+    if (!FFileHelper::LoadFileToString(BaselineJson, *BaselinePath) || !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(BaselineJson), Baseline) || !Baseline)
+    {
+        UE_LOG(LogGOAPStressTest, Error, TEXT("Could not read baseline %s."), *BaselinePath);
+        return 1;
+    }
+
+    // Numbers from another agent count, grid or step would gate against the wrong workload
+    bool bConfigMatches = true;
+    for (const TCHAR* Field : GOAPStressTest::ConfigFields)
+    {
+        double Current = 0.0, Reference = 0.0;
+        if (!Results->TryGetNumberField(Field, Current) || !Baseline->TryGetNumberField(Field, Reference))
+        {
+            UE_LOG(LogGOAPStressTest, Error, TEXT("%s is missing from the results or from baseline %s."), Field, *BaselinePath);
+            bConfigMatches = false;
+        }
+        else if (!FMath::IsNearlyEqual(Current, Reference, 1e-4 * FMath::Max(FMath::Abs(Reference), 1.0)))
+        {
+            UE_LOG(LogGOAPStressTest, Error, TEXT("This run has %s = %g but baseline %s was measured with %g."), Field, Current, *BaselinePath, Reference);
+            bConfigMatches = false;
+        }
+    }
+    FString BaselineMap;
+    if (!Baseline->TryGetStringField(TEXT("map"), BaselineMap) || BaselineMap != MapName)
+    {
+        UE_LOG(LogGOAPStressTest, Error, TEXT("This run used map %s but baseline %s was measured on %s."), *MapName, *BaselinePath, *BaselineMap);
+        bConfigMatches = false;
+    }
+    if (!bConfigMatches) return 1;
+
+    int32 NumRegressions = 0;
+    for (const TCHAR* Metric : GOAPStressTest::GatedMetrics)
+    {
+        double Current = 0.0, Reference = 0.0;
+        if (!GOAPStressTest::FindMetric(*Results, Metric, Current) || !GOAPStressTest::FindMetric(*Baseline, Metric, Reference))
+        {
+            // A gate that cannot be checked must not pass silently
+            UE_LOG(LogGOAPStressTest, Error, TEXT("%s is missing from the results or from baseline %s."), Metric, *BaselinePath);
+            ++NumRegressions;
+            continue;
+        }
+
+        const double Limit = Reference * (1.0 + Threshold);
+        if (Current > Limit)
+        {
+            UE_LOG(LogGOAPStressTest, Error, TEXT("%s regressed: %.3f against a baseline of %.3f (limit %.3f)."), Metric, Current, Reference, Limit);
+            ++NumRegressions;
+        }
+    }
+
+    if (NumRegressions > 0) return 1;
+
+    UE_LOG(LogGOAPStressTest, Display, TEXT("No regressions against %s."), *BaselinePath);
+    return 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "GOAPStressTestCommandlet.generated.h"
+
+class AAI_Character;
+class ANode;
+
+// Headless AI performance run with a regression gate:
+//   UnrealEditor-Cmd GOAP_AI_DEMO -run=GOAPStressTest -nullrhi -unattended [-Agents=200] [-CrowdAgents=0] [-Seconds=60]
+//     [-Warmup=2] [-Step=0.0166667] [-Map=/Game/...] [-Grid=8] [-Spacing=400] [-AgentClass=/Game/...]
+//     [-Output=file.json] [-Baseline=file.json | -NoBaseline] [-UpdateBaseline] [-Threshold=0.1]
+// Loads Map, lays a Grid x Grid patrol node grid around its player start, spawns Agents characters on
+// square routes through it, plus CrowdAgents Mass entities patrolling the edge of the grid with the same
+// actions, and walks a scripted player target in a circle over the grid for them to spot and chase.
+// The world is then ticked at a fixed Step for Seconds after Warmup. Frame time, GOAP counter and AI
+// subsystem time percentiles are written as JSON. The run fails if no agent ever chased the target, if its
+// map, agents, crowd agents, grid, spacing or step differ from the baseline's, or when a gated metric is more
+// than Threshold above the baseline, Build/GOAPStressTestBaseline.json unless -Baseline is given, or is
+// missing from either file. -UpdateBaseline overwrites the baseline with this run's results instead.
+UCLASS()
+class UGOAPStressTestCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UGOAPStressTestCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+
+private:
+    // Nodes row by row, linked to their four neighbours
+    void SpawnNodeGrid(UWorld& World, const FVector& Center, int32 GridSize, float Spacing, TArray<ANode*>& OutNodes) const;
+
+    AAI_Character* SpawnAgent(UWorld& World, UClass* AgentClass, const TArray<ANode*>& Route) const;
+};
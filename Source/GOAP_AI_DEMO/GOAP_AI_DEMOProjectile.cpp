@@ -3,6 +3,7 @@
 #include "GOAP_AI_DEMOProjectile.h"
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "Components/SphereComponent.h"
+#include "ProjectilePoolSubsystem.h"
 
 AGOAP_AI_DEMOProjectile::AGOAP_AI_DEMOProjectile() 
 {
@@ -38,6 +39,52 @@ void AGOAP_AI_DEMOProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherA
 	{
 		OtherComp->AddImpulseAtLocation(GetVelocity() * 100.0f, GetActorLocation());
 
+		Recycle();
+	}
+}
+
+void AGOAP_AI_DEMOProjectile::LifeSpanExpired()
+{
+	Recycle();
+}
+
+void AGOAP_AI_DEMOProjectile::Recycle()
+{
+	UProjectilePoolSubsystem* Pool = UProjectilePoolSubsystem::Get(GetWorld());
+	if (Pool != nullptr && bActiveInPool)
+	{
+		Pool->Release(this);
+	}
+	else
+	{
 		Destroy();
 	}
+}
+
+void AGOAP_AI_DEMOProjectile::ActivateFromPool(const FVector& Location, const FRotator& Rotation)
+{
+	bActiveInPool = true;
+	SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::ResetPhysics);
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+
+	// A bounce to a stop clears the updated component, so hook it up again every launch
+	ProjectileMovement->SetUpdatedComponent(CollisionComp);
+	ProjectileMovement->Velocity = Rotation.Vector() * ProjectileMovement->InitialSpeed;
+	ProjectileMovement->UpdateComponentVelocity();
+	ProjectileMovement->Activate(true);
+
+	SetLifeSpan(GetDefault<AGOAP_AI_DEMOProjectile>(GetClass())->InitialLifeSpan);
+}
+
+void AGOAP_AI_DEMOProjectile::DeactivateForPool()
+{
+	bActiveInPool = false;
+	SetLifeSpan(0.0f);
+
+	ProjectileMovement->StopMovementImmediately();
+	ProjectileMovement->Deactivate();
+
+	SetActorEnableCollision(false);
+	SetActorHiddenInGame(true);
 }
\ No newline at end of file
@@ -33,5 +33,22 @@ public:
 	USphereComponent* GetCollisionComp() const { return CollisionComp; }
 	/** Returns ProjectileMovement subobject **/
 	UProjectileMovementComponent* GetProjectileMovement() const { return ProjectileMovement; }
+
+	/** Shows the projectile and launches it from Location along Rotation with a fresh lifetime */
+	void ActivateFromPool(const FVector& Location, const FRotator& Rotation);
+	/** Hides the projectile and stops its movement, collision and lifetime */
+	void DeactivateForPool();
+	/** Returns true while the projectile is in flight **/
+	bool IsActiveInPool() const { return bActiveInPool; }
+
+protected:
+	/** Goes back to the pool instead of being destroyed */
+	virtual void LifeSpanExpired() override;
+
+private:
+	/** Returns to the projectile pool, or destroys the projectile if there is none */
+	void Recycle();
+
+	bool bActiveInPool = false;
 };
 
@@ -4,6 +4,8 @@
 #include "GOAP_AI_DEMOWeaponComponent.h"
 #include "GOAP_AI_DEMOCharacter.h"
 #include "GOAP_AI_DEMOProjectile.h"
+#include "ProjectilePoolSubsystem.h"
+#include "ProjectileSimulationSubsystem.h"
 #include "GameFramework/PlayerController.h"
 #include "Camera/PlayerCameraManager.h"
 #include "Kismet/GameplayStatics.h"
@@ -39,12 +41,25 @@ void UGOAP_AI_DEMOWeaponComponent::Fire()
 			// MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
 			const FVector SpawnLocation = GetOwner()->GetActorLocation() + SpawnRotation.RotateVector(MuzzleOffset);
 	
-			//Set Spawn Collision Handling Override
-			FActorSpawnParameters ActorSpawnParams;
-			ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
-	
-			// Spawn the projectile at the muzzle
-			World->SpawnActor<AGOAP_AI_DEMOProjectile>(ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
+			// Launch a simulated round, or a recycled projectile actor, from the muzzle
+			UProjectileSimulationSubsystem* Simulation = UProjectileSimulationSubsystem::Get(World);
+			if (Simulation != nullptr && UProjectileSimulationSubsystem::IsSimulationEnabled())
+			{
+				Simulation->Launch(ProjectileClass, SpawnLocation, SpawnRotation, Character);
+			}
+			else if (UProjectilePoolSubsystem* Pool = UProjectilePoolSubsystem::Get(World))
+			{
+				Pool->Acquire(ProjectileClass, SpawnLocation, SpawnRotation);
+			}
+			else
+			{
+				//Set Spawn Collision Handling Override
+				FActorSpawnParameters ActorSpawnParams;
+				ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+
+				// Spawn the projectile at the muzzle
+				World->SpawnActor<AGOAP_AI_DEMOProjectile>(ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
+			}
 		}
 	}
 	
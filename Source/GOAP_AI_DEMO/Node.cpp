@@ -1,20 +1,43 @@
 #include "Node.h"
 #include "Components/StaticMeshComponent.h"
-#include "Components/SplineComponent.h"
-#include "Components/SplineMeshComponent.h"
 #include "Materials/MaterialInstanceDynamic.h"
 #include "UObject/ConstructorHelpers.h"
+#include "NodeGraphSubsystem.h"
+#include "NodeLinkRendererSubsystem.h"
+#include "NodeMeshRendererSubsystem.h"
 
 ANode::ANode()
 {
     MeshComponent = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("MeshComponent"));
     RootComponent = MeshComponent;
-    UpdateLinkSplines();
 }
 
 void ANode::BeginPlay()
 {
     Super::BeginPlay();
+
+    // Attach to the cooked graph slot saved with the level
+    if (UNodeGraphSubsystem* GraphSubsystem = UNodeGraphSubsystem::Get(GetWorld()))
+    {
+        GraphSubsystem->RegisterNode(this);
+    }
+
+    // Draw through the shared instanced mesh; the own mesh keeps its collision but stops rendering
+    UNodeMeshRendererSubsystem* MeshRenderer = UNodeMeshRendererSubsystem::Get(GetWorld());
+    if (MeshRenderer && MeshRenderer->AddNode(this))
+    {
+        MeshComponent->SetVisibility(false);
+    }
+}
+
+void ANode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UNodeMeshRendererSubsystem* MeshRenderer = UNodeMeshRendererSubsystem::Get(GetWorld()))
+    {
+        MeshRenderer->RemoveNode(this);
+    }
+
+    Super::EndPlay(EndPlayReason);
 }
 
 void ANode::OnConstruction(const FTransform& Transform)
@@ -25,19 +48,55 @@ void ANode::OnConstruction(const FTransform& Transform)
     Location.Z += 0.01f;
     SetActorLocation(Location);
 
-    UpdateLinkSplines();
+    UpdateLinkLines();
+}
+
+void ANode::Destroyed()
+{
+    if (UNodeLinkRendererSubsystem* LinkRenderer = UNodeLinkRendererSubsystem::Get(GetWorld()))
+    {
+        LinkRenderer->RemoveNode(this);
+    }
+
+    Super::Destroyed();
+}
+
+void ANode::SetNodeType(ENodeType NewType)
+{
+    if (NodeType == NewType) return;
+
+    NodeType = NewType;
+    UpdateNodeColor();
+
+    if (UNodeGraphSubsystem* GraphSubsystem = UNodeGraphSubsystem::Get(GetWorld()))
+    {
+        GraphSubsystem->NotifyNodeTypeChanged(this);
+    }
 }
 
 void ANode::UpdateNodeColor()
 {
     if (!MeshComponent) return;
 
+    // Instanced nodes carry their colour in per-instance data or their batch material instead
+    UNodeMeshRendererSubsystem* MeshRenderer = UNodeMeshRendererSubsystem::Get(GetWorld());
+    if (MeshRenderer && MeshRenderer->IsInstanced(this))
+    {
+        MeshRenderer->UpdateNode(this);
+        return;
+    }
+
     UMaterialInstanceDynamic* DynMat = MeshComponent->CreateAndSetMaterialInstanceDynamic(0);
     if (!DynMat) return;
 
+    DynMat->SetVectorParameterValue("BaseColor", GetNodeTypeColor(NodeType));
+}
+
+FLinearColor ANode::GetNodeTypeColor(ENodeType Type)
+{
     FLinearColor Color = FLinearColor::Blue; // Default for None
 
-    switch (NodeType)
+    switch (Type)
     {
         case ENodeType::Walk:
             Color = FLinearColor::Blue;
@@ -58,41 +117,15 @@ void ANode::UpdateNodeColor()
             break;
     }
 
-    DynMat->SetVectorParameterValue("BaseColor", Color);
+    return Color;
 }
 
-void ANode::UpdateLinkSplines()
+void ANode::UpdateLinkLines()
 {
-#if WITH_EDITOR
-    // Destroy old splines
-    for (USplineComponent* Spline : DebugSplines)
-    {
-        if (Spline) Spline->DestroyComponent();
-    }
-    DebugSplines.Empty();
-
-    // Create a spline for each connection
-    for (const TPair<ANode*, ENodeConnectionType>& Pair : LinkedNodes)
+    if (UNodeLinkRendererSubsystem* LinkRenderer = UNodeLinkRendererSubsystem::Get(GetWorld()))
     {
-        ANode* LinkedNode = Pair.Key;
-        if (LinkedNode)
-        {
-            USplineComponent* Spline = NewObject<USplineComponent>(this, NAME_None, RF_Transient);
-            Spline->bIsEditorOnly = true;
-            Spline->RegisterComponent();
-            Spline->SetMobility(EComponentMobility::Movable);
-            Spline->AttachToComponent(RootComponent, FAttachmentTransformRules::KeepRelativeTransform);
-
-            Spline->ClearSplinePoints(false);
-            Spline->AddSplinePoint(GetActorLocation(), ESplineCoordinateSpace::World, false);
-            Spline->AddSplinePoint(LinkedNode->GetActorLocation(), ESplineCoordinateSpace::World, false);
-            Spline->SetClosedLoop(false);
-            Spline->UpdateSpline();
-
-            DebugSplines.Add(Spline);
-        }
+        LinkRenderer->UpdateNode(this);
     }
-#endif
 }
 
 #if WITH_EDITOR
@@ -3,10 +3,10 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "NodeTypes.h"
-#include "Components/SplineComponent.h"
-#include "Components/SplineMeshComponent.h"
 #include "Node.generated.h"
 
+class UMaterialInterface;
+
 UCLASS()
 class GOAP_AI_DEMO_API ANode : public AActor
 {
@@ -27,9 +27,14 @@ public:
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Node")
     UStaticMeshComponent* MeshComponent;
 
-    // Debug splines for visualization
-    UPROPERTY(Transient)
-    TArray<USplineComponent*> DebugSplines;
+    // Material used when the node is drawn as an instance in game worlds. It should read the type colour
+    // from PerInstanceCustomData 0-2. Left empty, instances use the mesh's own material, one batch per node type.
+    UPROPERTY(EditDefaultsOnly, Category = "Node|Rendering")
+    TObjectPtr<UMaterialInterface> InstancedMaterial;
+
+    // Index in the cooked node graph, written when the level is saved
+    UPROPERTY(VisibleAnywhere, Category = "Node", AdvancedDisplay)
+    int32 GraphIndex = INDEX_NONE;
 
     // A* Search costs
     UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "AStar")
@@ -42,11 +47,18 @@ public:
     float FCost = 0.0f;
 
 public:
+    // Changes the node type at runtime and lets the compiled graph re-cost links into this node
+    UFUNCTION(BlueprintCallable, Category = "Node")
+    void SetNodeType(ENodeType NewType);
+
     // Call this to update the node's color based on its type
     void UpdateNodeColor();
 
-    // Call this to update the spline visualization for linked nodes
-    void UpdateLinkSplines();
+    // Display colour for a node type
+    static FLinearColor GetNodeTypeColor(ENodeType Type);
+
+    // Redraws this node's links in the shared link renderer
+    void UpdateLinkLines();
 
     // Optionally, override PostEditChangeProperty for editor changes
 #if WITH_EDITOR
@@ -56,4 +68,8 @@ public:
     virtual void OnConstruction(const FTransform& Transform) override;
 
     virtual void BeginPlay() override;
+
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    virtual void Destroyed() override;
 };
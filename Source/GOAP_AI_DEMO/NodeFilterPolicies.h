@@ -0,0 +1,115 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Tuple.h"
+#include "NodeGraph.h"
+#include "UNavFilter.h"
+
+// Compile-time node filters for searches over FNodeGraph.
+//
+// A policy is a small value type with two non-virtual checks:
+//   bool AcceptEdge(const FNodeGraph& Graph, int32 Edge) const   - may the agent traverse this link?
+//   bool AcceptNode(const FNodeGraph& Graph, int32 Node) const   - may the agent enter this node?
+// Policies derive from FNodeFilterPolicy for the checks they do not care about.
+// TNodeFilterChain ANDs any number of them with a fold expression, so the whole chain inlines into
+// the search loop, e.g.
+//
+//   auto Filter = MakeNodeFilterChain(FConnectionMaskPolicy(AgentConnections), FNodeTypeMaskPolicy(AllowedTypes));
+//   Graph.Dijkstra(Source, MaxCost, Filter, Costs);
+struct FNodeFilterPolicy
+{
+    FORCEINLINE bool AcceptEdge(const FNodeGraph& Graph, int32 Edge) const { return true; }
+    FORCEINLINE bool AcceptNode(const FNodeGraph& Graph, int32 Node) const { return true; }
+};
+
+// Agent capabilities: bit N set = links of ENodeConnectionType N can be used
+struct FConnectionMaskPolicy : FNodeFilterPolicy
+{
+    explicit FConnectionMaskPolicy(int32 InConnectionMask) : ConnectionMask(InConnectionMask) {}
+
+    FORCEINLINE bool AcceptEdge(const FNodeGraph& Graph, int32 Edge) const
+    {
+        return (ConnectionMask & (1 << (int32)Graph.GetEdgeType(Edge))) != 0;
+    }
+
+    int32 ConnectionMask;
+};
+
+// Bit N set = nodes of ENodeType N can be entered
+struct FNodeTypeMaskPolicy : FNodeFilterPolicy
+{
+    explicit FNodeTypeMaskPolicy(int32 InNodeTypeMask) : NodeTypeMask(InNodeTypeMask) {}
+
+    FORCEINLINE bool AcceptNode(const FNodeGraph& Graph, int32 Node) const
+    {
+        return (NodeTypeMask & (1 << (int32)Graph.GetType(Node))) != 0;
+    }
+
+    int32 NodeTypeMask;
+};
+
+// Rejects nodes whose bit is set, e.g. nodes in player LOS gathered with UUPlayerLOSFilter::BuildLOSMask.
+// The mask is indexed by graph node and must outlive the search.
+struct FNodeMaskPolicy : FNodeFilterPolicy
+{
+    explicit FNodeMaskPolicy(const TBitArray<>& InRejected) : Rejected(InRejected) {}
+
+    FORCEINLINE bool AcceptNode(const FNodeGraph& Graph, int32 Node) const
+    {
+        return !Rejected.IsValidIndex(Node) || !Rejected[Node];
+    }
+
+    const TBitArray<>& Rejected;
+};
+
+// Fallback for UObject filters: one virtual IsNodeValid call per node. A null filter accepts everything.
+struct FUObjectFilterPolicy : FNodeFilterPolicy
+{
+    explicit FUObjectFilterPolicy(const UUNavFilter* InFilter) : Filter(InFilter) {}
+
+    FORCEINLINE bool AcceptNode(const FNodeGraph& Graph, int32 Node) const
+    {
+        return !Filter || Filter->IsNodeValid(Graph.GetNode(Node));
+    }
+
+    const UUNavFilter* Filter;
+};
+
+// Conjunction of policies, evaluated left to right with short-circuiting. Put the cheapest first.
+template <typename... PolicyTypes>
+struct TNodeFilterChain
+{
+    TNodeFilterChain() = default;
+    explicit TNodeFilterChain(PolicyTypes... InPolicies) : Policies(MoveTemp(InPolicies)...) {}
+
+    FORCEINLINE bool AcceptEdge(const FNodeGraph& Graph, int32 Edge) const
+    {
+        return AcceptEdgeImpl(Graph, Edge, TMakeIntegerSequence<uint32, sizeof...(PolicyTypes)>());
+    }
+
+    FORCEINLINE bool AcceptNode(const FNodeGraph& Graph, int32 Node) const
+    {
+        return AcceptNodeImpl(Graph, Node, TMakeIntegerSequence<uint32, sizeof...(PolicyTypes)>());
+    }
+
+private:
+    template <uint32... Indices>
+    FORCEINLINE bool AcceptEdgeImpl(const FNodeGraph& Graph, int32 Edge, TIntegerSequence<uint32, Indices...>) const
+    {
+        return (true && ... && Policies.template Get<Indices>().AcceptEdge(Graph, Edge));
+    }
+
+    template <uint32... Indices>
+    FORCEINLINE bool AcceptNodeImpl(const FNodeGraph& Graph, int32 Node, TIntegerSequence<uint32, Indices...>) const
+    {
+        return (true && ... && Policies.template Get<Indices>().AcceptNode(Graph, Node));
+    }
+
+    TTuple<PolicyTypes...> Policies;
+};
+
+template <typename... PolicyTypes>
+FORCEINLINE TNodeFilterChain<PolicyTypes...> MakeNodeFilterChain(PolicyTypes... Policies)
+{
+    return TNodeFilterChain<PolicyTypes...>(MoveTemp(Policies)...);
+}
@@ -0,0 +1,380 @@
+#include "NodeGraph.h"
+#include "NodeGraphBlob.h"
+#include "NodeFilterPolicies.h"
+#include "Node.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/FileHelper.h"
+
+namespace NodeGraphBlob
+{
+    // Appends Data at the next aligned offset and returns that offset
+    template <typename T>
+    static uint32 WriteSection(TArray<uint8>& Blob, const TArray<T>& Data)
+    {
+        const int32 Offset = Align(Blob.Num(), FNodeGraphBlobHeader::SectionAlignment);
+        Blob.SetNumZeroed(Offset + Data.NumBytes());
+        FMemory::Memcpy(Blob.GetData() + Offset, Data.GetData(), Data.NumBytes());
+        return Offset;
+    }
+
+    // View of a section inside the blob; clears bOutValid if it does not fit
+    template <typename T>
+    static TConstArrayView<T> ReadSection(const uint8* Data, int64 Size, uint32 Offset, uint32 Num, bool& bOutValid)
+    {
+        if (Offset % alignof(T) != 0 || (int64)Offset + (int64)Num * (int64)sizeof(T) > Size)
+        {
+            bOutValid = false;
+            return TConstArrayView<T>();
+        }
+        return TConstArrayView<T>(reinterpret_cast<const T*>(Data + Offset), Num);
+    }
+
+    // Links are summed so their order does not matter; only node indices do
+    static uint32 HashEdge(int32 Target, uint8 Type)
+    {
+        return HashCombineFast(GetTypeHash(Target), GetTypeHash(Type));
+    }
+
+    // CSR offsets must start at 0, never decrease and end at the edge count
+    static bool AreOffsetsValid(TConstArrayView<int32> Offsets, uint32 NumEdges)
+    {
+        if (Offsets.Num() == 0 || Offsets[0] != 0 || Offsets.Last() != (int32)NumEdges) return false;
+        for (int32 Index = 1; Index < Offsets.Num(); ++Index)
+        {
+            if (Offsets[Index] < Offsets[Index - 1]) return false;
+        }
+        return true;
+    }
+
+    static bool AreIndicesValid(TConstArrayView<int32> Indices, uint32 Num)
+    {
+        for (const int32 Index : Indices)
+        {
+            if ((uint32)Index >= Num) return false;
+        }
+        return true;
+    }
+
+    static uint32 HashNode(uint32 Hash, float X, float Y, float Z, uint8 Type, uint32 EdgeHash)
+    {
+        Hash = HashCombineFast(Hash, HashCombineFast(GetTypeHash(X), GetTypeHash(Y)));
+        Hash = HashCombineFast(Hash, HashCombineFast(GetTypeHash(Z), GetTypeHash(Type)));
+        return HashCombineFast(Hash, EdgeHash);
+    }
+}
+
+FNodeGraph::FNodeGraph() = default;
+
+FNodeGraph::~FNodeGraph()
+{
+    Reset();
+}
+
+void FNodeGraph::Reset()
+{
+    PosX = {};
+    PosY = {};
+    PosZ = {};
+    EdgeOffsets = {};
+    EdgeSources = {};
+    EdgeTargets = {};
+    EdgeTypes = {};
+    EdgeCosts = {};
+    InEdgeOffsets = {};
+    InEdges = {};
+    Types.Reset();
+    NodeCostScales.Reset();
+    Actors.Reset();
+    NodeIndices.Reset();
+    LayoutHash = 0;
+
+    // Views are gone; release the memory behind them (region before its file)
+    OwnedBlob.Empty();
+    MappedRegion.Reset();
+    MappedFile.Reset();
+}
+
+void FNodeGraph::Build(const UWorld* World, bool bAssignGraphIndices)
+{
+    Reset();
+    if (!World) return;
+
+    TArray<ANode*> Nodes;
+    TMap<const ANode*, int32> Indices;
+    TArray<float> BuildPosX;
+    TArray<float> BuildPosY;
+    TArray<float> BuildPosZ;
+    TArray<uint8> BuildTypes;
+
+    // Pass 1: assign indices
+    for (TActorIterator<ANode> It(World); It; ++It)
+    {
+        ANode* Node = *It;
+        const FVector Location = Node->GetActorLocation();
+
+        Indices.Add(Node, Nodes.Num());
+        Nodes.Add(Node);
+        BuildPosX.Add(Location.X);
+        BuildPosY.Add(Location.Y);
+        BuildPosZ.Add(Location.Z);
+        BuildTypes.Add((uint8)Node->NodeType);
+    }
+
+    // Pass 2: flatten links into CSR arrays
+    TArray<int32> BuildEdgeOffsets;
+    TArray<int32> BuildEdgeSources;
+    TArray<int32> BuildEdgeTargets;
+    TArray<uint8> BuildEdgeTypes;
+    TArray<float> BuildEdgeCosts;
+    BuildEdgeOffsets.Reserve(Nodes.Num() + 1);
+    for (int32 Index = 0; Index < Nodes.Num(); ++Index)
+    {
+        BuildEdgeOffsets.Add(BuildEdgeTargets.Num());
+
+        for (const TPair<ANode*, ENodeConnectionType>& Pair : Nodes[Index]->LinkedNodes)
+        {
+            const int32* Target = Indices.Find(Pair.Key);
+            if (!Target) continue;
+
+            BuildEdgeSources.Add(Index);
+            BuildEdgeTargets.Add(*Target);
+            BuildEdgeTypes.Add((uint8)Pair.Value);
+            BuildEdgeCosts.Add(FVector::Dist(Nodes[Index]->GetActorLocation(), Nodes[*Target]->GetActorLocation()));
+        }
+    }
+    BuildEdgeOffsets.Add(BuildEdgeTargets.Num());
+
+    // Pass 3: bucket edges by target for the incoming index
+    TArray<int32> BuildInEdgeOffsets;
+    BuildInEdgeOffsets.SetNumZeroed(Nodes.Num() + 1);
+    for (int32 Target : BuildEdgeTargets)
+    {
+        ++BuildInEdgeOffsets[Target + 1];
+    }
+    for (int32 Index = 0; Index < Nodes.Num(); ++Index)
+    {
+        BuildInEdgeOffsets[Index + 1] += BuildInEdgeOffsets[Index];
+    }
+
+    TArray<int32> Fill(BuildInEdgeOffsets.GetData(), Nodes.Num());
+    TArray<int32> BuildInEdges;
+    BuildInEdges.SetNumUninitialized(BuildEdgeTargets.Num());
+    for (int32 Edge = 0; Edge < BuildEdgeTargets.Num(); ++Edge)
+    {
+        BuildInEdges[Fill[BuildEdgeTargets[Edge]]++] = Edge;
+    }
+
+    uint32 BuildLayoutHash = 0;
+    for (int32 Index = 0; Index < Nodes.Num(); ++Index)
+    {
+        uint32 EdgeHash = 0;
+        for (int32 Edge = BuildEdgeOffsets[Index]; Edge < BuildEdgeOffsets[Index + 1]; ++Edge)
+        {
+            EdgeHash += NodeGraphBlob::HashEdge(BuildEdgeTargets[Edge], BuildEdgeTypes[Edge]);
+        }
+        BuildLayoutHash = NodeGraphBlob::HashNode(BuildLayoutHash, BuildPosX[Index], BuildPosY[Index], BuildPosZ[Index], BuildTypes[Index], EdgeHash);
+    }
+
+    // Pass 4: lay everything out as a blob, the same format that gets cooked
+    FNodeGraphBlobHeader Header;
+    FMemory::Memzero(Header);
+    OwnedBlob.SetNumZeroed(sizeof(FNodeGraphBlobHeader));
+    Header.PosXOffset = NodeGraphBlob::WriteSection(OwnedBlob, BuildPosX);
+    Header.PosYOffset = NodeGraphBlob::WriteSection(OwnedBlob, BuildPosY);
+    Header.PosZOffset = NodeGraphBlob::WriteSection(OwnedBlob, BuildPosZ);
+    Header.TypesOffset = NodeGraphBlob::WriteSection(OwnedBlob, BuildTypes);
+    Header.EdgeOffsetsOffset = NodeGraphBlob::WriteSection(OwnedBlob, BuildEdgeOffsets);
+    Header.InEdgeOffsetsOffset = NodeGraphBlob::WriteSection(OwnedBlob, BuildInEdgeOffsets);
+    Header.EdgeSourcesOffset = NodeGraphBlob::WriteSection(OwnedBlob, BuildEdgeSources);
+    Header.EdgeTargetsOffset = NodeGraphBlob::WriteSection(OwnedBlob, BuildEdgeTargets);
+    Header.EdgeTypesOffset = NodeGraphBlob::WriteSection(OwnedBlob, BuildEdgeTypes);
+    Header.EdgeCostsOffset = NodeGraphBlob::WriteSection(OwnedBlob, BuildEdgeCosts);
+    Header.InEdgesOffset = NodeGraphBlob::WriteSection(OwnedBlob, BuildInEdges);
+    Header.Magic = FNodeGraphBlobHeader::ExpectedMagic;
+    Header.Version = FNodeGraphBlobHeader::CurrentVersion;
+    Header.TotalSize = OwnedBlob.Num();
+    Header.NumNodes = Nodes.Num();
+    Header.NumEdges = BuildEdgeTargets.Num();
+    Header.LayoutHash = BuildLayoutHash;
+    FMemory::Memcpy(OwnedBlob.GetData(), &Header, sizeof(Header));
+
+    verify(InitFromBlob(OwnedBlob.GetData(), OwnedBlob.Num()));
+
+    for (int32 Index = 0; Index < Nodes.Num(); ++Index)
+    {
+        if (bAssignGraphIndices)
+        {
+            Nodes[Index]->GraphIndex = Index;
+        }
+        RegisterActor(Nodes[Index], Index);
+    }
+}
+
+bool FNodeGraph::LoadMapped(const FString& Filename)
+{
+    Reset();
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    TUniquePtr<IMappedFileHandle> Handle(PlatformFile.OpenMapped(*Filename));
+    if (!Handle) return false;
+
+    TUniquePtr<IMappedFileRegion> Region(Handle->MapRegion(0, Handle->GetFileSize()));
+    if (!Region) return false;
+
+    MappedFile = MoveTemp(Handle);
+    MappedRegion = MoveTemp(Region);
+    if (!InitFromBlob(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize()))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("%s is not a valid node graph blob (version %u expected, or corrupt links); compiling from actors."), *Filename, FNodeGraphBlobHeader::CurrentVersion);
+        Reset();
+        return false;
+    }
+    return true;
+}
+
+bool FNodeGraph::SaveBlob(const FString& Filename) const
+{
+    if (IsMapped())
+    {
+        return FFileHelper::SaveArrayToFile(TArrayView<const uint8>(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize()), *Filename);
+    }
+    return OwnedBlob.Num() > 0 && FFileHelper::SaveArrayToFile(OwnedBlob, *Filename);
+}
+
+bool FNodeGraph::InitFromBlob(const uint8* Data, int64 Size)
+{
+    if (!Data || Size < (int64)sizeof(FNodeGraphBlobHeader)) return false;
+
+    const FNodeGraphBlobHeader& Header = *reinterpret_cast<const FNodeGraphBlobHeader*>(Data);
+    if (Header.Magic != FNodeGraphBlobHeader::ExpectedMagic || Header.Version != FNodeGraphBlobHeader::CurrentVersion || Header.TotalSize > Size)
+    {
+        return false;
+    }
+
+    const uint32 NumBlobNodes = Header.NumNodes;
+    const uint32 NumBlobEdges = Header.NumEdges;
+
+    bool bValid = true;
+    PosX = NodeGraphBlob::ReadSection<float>(Data, Size, Header.PosXOffset, NumBlobNodes, bValid);
+    PosY = NodeGraphBlob::ReadSection<float>(Data, Size, Header.PosYOffset, NumBlobNodes, bValid);
+    PosZ = NodeGraphBlob::ReadSection<float>(Data, Size, Header.PosZOffset, NumBlobNodes, bValid);
+    TConstArrayView<uint8> BlobTypes = NodeGraphBlob::ReadSection<uint8>(Data, Size, Header.TypesOffset, NumBlobNodes, bValid);
+    EdgeOffsets = NodeGraphBlob::ReadSection<int32>(Data, Size, Header.EdgeOffsetsOffset, NumBlobNodes + 1, bValid);
+    InEdgeOffsets = NodeGraphBlob::ReadSection<int32>(Data, Size, Header.InEdgeOffsetsOffset, NumBlobNodes + 1, bValid);
+    EdgeSources = NodeGraphBlob::ReadSection<int32>(Data, Size, Header.EdgeSourcesOffset, NumBlobEdges, bValid);
+    EdgeTargets = NodeGraphBlob::ReadSection<int32>(Data, Size, Header.EdgeTargetsOffset, NumBlobEdges, bValid);
+    EdgeTypes = NodeGraphBlob::ReadSection<uint8>(Data, Size, Header.EdgeTypesOffset, NumBlobEdges, bValid);
+    EdgeCosts = NodeGraphBlob::ReadSection<float>(Data, Size, Header.EdgeCostsOffset, NumBlobEdges, bValid);
+    InEdges = NodeGraphBlob::ReadSection<int32>(Data, Size, Header.InEdgesOffset, NumBlobEdges, bValid);
+    if (!bValid) return false;
+
+    // Queries index straight into the blob, so a corrupt one must not get past here
+    if (!NodeGraphBlob::AreOffsetsValid(EdgeOffsets, NumBlobEdges) || !NodeGraphBlob::AreOffsetsValid(InEdgeOffsets, NumBlobEdges)
+        || !NodeGraphBlob::AreIndicesValid(EdgeSources, NumBlobNodes) || !NodeGraphBlob::AreIndicesValid(EdgeTargets, NumBlobNodes)
+        || !NodeGraphBlob::AreIndicesValid(InEdges, NumBlobEdges))
+    {
+        return false;
+    }
+
+    // Only the small mutable per-node arrays are copied
+    Types = TArray<uint8>(BlobTypes.GetData(), BlobTypes.Num());
+    NodeCostScales.Init(1.f, NumBlobNodes);
+    Actors.SetNum(NumBlobNodes);
+    LayoutHash = Header.LayoutHash;
+    return true;
+}
+
+bool FNodeGraph::ComputeActorLayoutHash(const UWorld* World, uint32& OutHash, int32& OutNumNodes)
+{
+    OutHash = 0;
+    OutNumNodes = 0;
+    if (!World) return false;
+
+    TArray<const ANode*> Nodes;
+    for (TActorIterator<ANode> It(World); It; ++It)
+    {
+        Nodes.Add(*It);
+    }
+    OutNumNodes = Nodes.Num();
+
+    // Place every actor at its cooked index; gaps and collisions mean the indices are stale
+    TArray<const ANode*> ByIndex;
+    ByIndex.SetNumZeroed(Nodes.Num());
+    for (const ANode* Node : Nodes)
+    {
+        if (!ByIndex.IsValidIndex(Node->GraphIndex) || ByIndex[Node->GraphIndex]) return false;
+        ByIndex[Node->GraphIndex] = Node;
+    }
+
+    for (const ANode* Node : ByIndex)
+    {
+        // Build only keeps links to nodes in the same world
+        uint32 EdgeHash = 0;
+        for (const TPair<ANode*, ENodeConnectionType>& Pair : Node->LinkedNodes)
+        {
+            const ANode* Target = Pair.Key;
+            if (Target && ByIndex.IsValidIndex(Target->GraphIndex) && ByIndex[Target->GraphIndex] == Target)
+            {
+                EdgeHash += NodeGraphBlob::HashEdge(Target->GraphIndex, (uint8)Pair.Value);
+            }
+        }
+
+        const FVector Location = Node->GetActorLocation();
+        OutHash = NodeGraphBlob::HashNode(OutHash, (float)Location.X, (float)Location.Y, (float)Location.Z, (uint8)Node->NodeType, EdgeHash);
+    }
+    return true;
+}
+
+bool FNodeGraph::RegisterActor(ANode* Node, int32 Index)
+{
+    if (!Node || !IsValidNode(Index)) return false;
+
+    Actors[Index] = Node;
+    NodeIndices.Add(Node, Index);
+    return true;
+}
+
+SIZE_T FNodeGraph::GetAllocatedSize() const
+{
+    return Types.GetAllocatedSize() + NodeCostScales.GetAllocatedSize() + OwnedBlob.GetAllocatedSize()
+        + Actors.GetAllocatedSize() + NodeIndices.GetAllocatedSize();
+}
+
+int32 FNodeGraph::GetNodeIndex(const ANode* Node) const
+{
+    const int32* Index = NodeIndices.Find(Node);
+    return Index ? *Index : INDEX_NONE;
+}
+
+ANode* FNodeGraph::GetNode(int32 Index) const
+{
+    return Actors.IsValidIndex(Index) ? Actors[Index].Get() : nullptr;
+}
+
+int32 FNodeGraph::FindNearestNode(const FVector& Location, float MaxDistance) const
+{
+    int32 BestIndex = INDEX_NONE;
+    float BestDistSq = MaxDistance < UE_MAX_FLT ? FMath::Square(MaxDistance) : UE_MAX_FLT;
+
+    const float X = Location.X;
+    const float Y = Location.Y;
+    const float Z = Location.Z;
+    for (int32 Index = 0; Index < NumNodes(); ++Index)
+    {
+        const float DistSq = FMath::Square(PosX[Index] - X) + FMath::Square(PosY[Index] - Y) + FMath::Square(PosZ[Index] - Z);
+        if (DistSq < BestDistSq)
+        {
+            BestDistSq = DistSq;
+            BestIndex = Index;
+        }
+    }
+    return BestIndex;
+}
+
+void FNodeGraph::Dijkstra(int32 Source, float MaxCost, TArray<float>& OutCosts, TArray<int32>* OutReached) const
+{
+    Dijkstra(Source, MaxCost, TNodeFilterChain<>(), OutCosts, OutReached);
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NodeTypes.h"
+#include "Algo/Reverse.h"
+
+class ANode;
+class UWorld;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// Compiled, index-based copy of the ANode graph.
+// Node data is stored as structure-of-arrays so tests can run over contiguous floats,
+// and links are stored in CSR form: the edges of node N are [EdgeBegin(N), EdgeEnd(N)).
+// Incoming links are indexed too, so incremental searches can walk predecessors.
+// Edge costs are the link length scaled by the target node's cost scale, which can change at runtime.
+//
+// The static data is a single blob (see FNodeGraphBlobHeader). Build produces it in memory;
+// LoadMapped uses a cooked .ngraph file in place without parsing or touching any actor.
+struct GOAP_AI_DEMO_API FNodeGraph
+{
+    FNodeGraph();
+    ~FNodeGraph();
+
+    FNodeGraph(const FNodeGraph&) = delete;
+    FNodeGraph& operator=(const FNodeGraph&) = delete;
+
+    // Rebuilds the graph from every ANode in World. Writes each node's GraphIndex when bAssignGraphIndices is set.
+    void Build(const UWorld* World, bool bAssignGraphIndices = false);
+
+    // Maps a cooked blob. Actors are attached afterwards through RegisterActor.
+    bool LoadMapped(const FString& Filename);
+
+    // Writes the current blob to disk
+    bool SaveBlob(const FString& Filename) const;
+
+    void Reset();
+
+    // True when the data comes from a mapped file rather than a runtime build
+    bool IsMapped() const { return MappedRegion.IsValid(); }
+
+    // Hash of the layout the blob was built from; see ComputeActorLayoutHash
+    uint32 GetLayoutHash() const { return LayoutHash; }
+
+    // Hashes the ANode actors in World the way Build hashes its blob, using each actor's GraphIndex.
+    // False if an index is missing, out of range or shared, in which case no cooked graph can match.
+    static bool ComputeActorLayoutHash(const UWorld* World, uint32& OutHash, int32& OutNumNodes);
+
+    // Heap memory only; a mapped blob is not counted
+    SIZE_T GetAllocatedSize() const;
+
+    // Attaches a spawned/loaded actor to its cooked index. Returns false if the index does not fit this graph.
+    bool RegisterActor(ANode* Node, int32 Index);
+
+    int32 NumNodes() const { return PosX.Num(); }
+    int32 NumEdges() const { return EdgeTargets.Num(); }
+    bool IsValidNode(int32 Index) const { return Index >= 0 && Index < NumNodes(); }
+
+    // Index of an actor in the graph, or INDEX_NONE
+    int32 GetNodeIndex(const ANode* Node) const;
+
+    // Actor for a node index; null if the actor was destroyed or has not registered yet
+    ANode* GetNode(int32 Index) const;
+
+    FVector GetLocation(int32 Index) const { return FVector(PosX[Index], PosY[Index], PosZ[Index]); }
+    ENodeType GetType(int32 Index) const { return (ENodeType)Types[Index]; }
+
+    int32 EdgeBegin(int32 Index) const { return EdgeOffsets[Index]; }
+    int32 EdgeEnd(int32 Index) const { return EdgeOffsets[Index + 1]; }
+    int32 GetEdgeTarget(int32 Edge) const { return EdgeTargets[Edge]; }
+    ENodeConnectionType GetEdgeType(int32 Edge) const { return (ENodeConnectionType)EdgeTypes[Edge]; }
+    int32 GetEdgeSource(int32 Edge) const { return EdgeSources[Edge]; }
+
+    // Current traversal cost of an edge
+    float GetEdgeCost(int32 Edge) const { return EdgeCosts[Edge] * NodeCostScales[EdgeTargets[Edge]]; }
+
+    // Length of an edge, ignoring cost scales
+    float GetBaseEdgeCost(int32 Edge) const { return EdgeCosts[Edge]; }
+
+    // Incoming edges of node N are GetInEdge(I) for I in [InEdgeBegin(N), InEdgeEnd(N))
+    int32 InEdgeBegin(int32 Index) const { return InEdgeOffsets[Index]; }
+    int32 InEdgeEnd(int32 Index) const { return InEdgeOffsets[Index + 1]; }
+    int32 GetInEdge(int32 I) const { return InEdges[I]; }
+
+    // Multiplier applied to every edge entering a node. Clamped to >= 1 so distance stays an admissible heuristic.
+    float GetNodeCostScale(int32 Index) const { return NodeCostScales[Index]; }
+    void SetNodeCostScale(int32 Index, float Scale) { NodeCostScales[Index] = FMath::Max(Scale, 1.f); }
+
+    void SetType(int32 Index, ENodeType Type) { Types[Index] = (uint8)Type; }
+
+    // Contiguous node positions for batched tests
+    TConstArrayView<float> GetPositionsX() const { return PosX; }
+    TConstArrayView<float> GetPositionsY() const { return PosY; }
+    TConstArrayView<float> GetPositionsZ() const { return PosZ; }
+    TConstArrayView<uint8> GetTypes() const { return Types; }
+
+    // Closest node to Location within MaxDistance, or INDEX_NONE
+    int32 FindNearestNode(const FVector& Location, float MaxDistance = UE_MAX_FLT) const;
+
+    // Single-source Dijkstra bounded by MaxCost.
+    // OutCosts is sized to NumNodes and holds UE_MAX_FLT for unreached nodes; reached nodes are appended to OutReached in settle order.
+    void Dijkstra(int32 Source, float MaxCost, TArray<float>& OutCosts, TArray<int32>* OutReached = nullptr) const;
+
+    // Dijkstra that only follows links and enters nodes accepted by Filter (see NodeFilterPolicies.h)
+    template <typename FilterType>
+    void Dijkstra(int32 Source, float MaxCost, const FilterType& Filter, TArray<float>& OutCosts, TArray<int32>* OutReached = nullptr) const;
+
+    // A* from Start to Goal through nodes and links accepted by Filter. OutPath holds node indices from Start to Goal.
+    template <typename FilterType>
+    bool FindPath(int32 Start, int32 Goal, const FilterType& Filter, TArray<int32>& OutPath) const;
+
+private:
+    // Points the section views into Data after validating the header
+    bool InitFromBlob(const uint8* Data, int64 Size);
+
+    // Read-only sections, viewing either OwnedBlob or the mapped file
+    TConstArrayView<float> PosX;
+    TConstArrayView<float> PosY;
+    TConstArrayView<float> PosZ;
+    TConstArrayView<int32> EdgeOffsets;
+    TConstArrayView<int32> EdgeSources;
+    TConstArrayView<int32> EdgeTargets;
+    TConstArrayView<uint8> EdgeTypes;
+    TConstArrayView<float> EdgeCosts;
+    TConstArrayView<int32> InEdgeOffsets;
+    TConstArrayView<int32> InEdges;
+
+    // Runtime-mutable per-node data, seeded from the blob
+    TArray<uint8> Types;
+    TArray<float> NodeCostScales;
+
+    // Backing storage
+    TArray<uint8> OwnedBlob;
+    TUniquePtr<IMappedFileHandle> MappedFile;
+    TUniquePtr<IMappedFileRegion> MappedRegion;
+
+    TArray<TWeakObjectPtr<ANode>> Actors;
+    TMap<const ANode*, int32> NodeIndices;
+
+    uint32 LayoutHash = 0;
+};
+
+namespace NodeGraphSearch
+{
+    struct FOpenEntry
+    {
+        float Cost;
+        int32 Node;
+        bool operator<(const FOpenEntry& Other) const { return Cost < Other.Cost; }
+    };
+}
+
+template <typename FilterType>
+void FNodeGraph::Dijkstra(int32 Source, float MaxCost, const FilterType& Filter, TArray<float>& OutCosts, TArray<int32>* OutReached) const
+{
+    OutCosts.Init(UE_MAX_FLT, NumNodes());
+    if (!IsValidNode(Source)) return;
+
+    TArray<NodeGraphSearch::FOpenEntry> Open;
+    OutCosts[Source] = 0.f;
+    Open.HeapPush({ 0.f, Source });
+
+    while (Open.Num() > 0)
+    {
+        NodeGraphSearch::FOpenEntry Entry;
+        Open.HeapPop(Entry, EAllowShrinking::No);
+
+        // Skip stale heap entries
+        if (Entry.Cost > OutCosts[Entry.Node]) continue;
+
+        if (OutReached)
+        {
+            OutReached->Add(Entry.Node);
+        }
+
+        for (int32 Edge = EdgeBegin(Entry.Node); Edge < EdgeEnd(Entry.Node); ++Edge)
+        {
+            const int32 Target = EdgeTargets[Edge];
+            const float NewCost = Entry.Cost + GetEdgeCost(Edge);
+            if (NewCost <= MaxCost && NewCost < OutCosts[Target] && Filter.AcceptEdge(*this, Edge) && Filter.AcceptNode(*this, Target))
+            {
+                OutCosts[Target] = NewCost;
+                Open.HeapPush({ NewCost, Target });
+            }
+        }
+    }
+}
+
+template <typename FilterType>
+bool FNodeGraph::FindPath(int32 Start, int32 Goal, const FilterType& Filter, TArray<int32>& OutPath) const
+{
+    OutPath.Reset();
+    if (!IsValidNode(Start) || !IsValidNode(Goal)) return false;
+
+    const FVector GoalLocation = GetLocation(Goal);
+    TArray<float> Costs;
+    TArray<int32> Parents;
+    Costs.Init(UE_MAX_FLT, NumNodes());
+    Parents.Init(INDEX_NONE, NumNodes());
+
+    // Heap entries are keyed on f = g + h; straight-line h is admissible because cost scales are >= 1
+    TArray<NodeGraphSearch::FOpenEntry> Open;
+    Costs[Start] = 0.f;
+    Open.HeapPush({ (float)FVector::Dist(GetLocation(Start), GoalLocation), Start });
+
+    while (Open.Num() > 0)
+    {
+        NodeGraphSearch::FOpenEntry Entry;
+        Open.HeapPop(Entry, EAllowShrinking::No);
+
+        const int32 Node = Entry.Node;
+        if (Node == Goal) break;
+
+        const float NodeCost = Costs[Node];
+        if (Entry.Cost > NodeCost + FVector::Dist(GetLocation(Node), GoalLocation) + UE_KINDA_SMALL_NUMBER) continue;
+
+        for (int32 Edge = EdgeBegin(Node); Edge < EdgeEnd(Node); ++Edge)
+        {
+            const int32 Target = EdgeTargets[Edge];
+            const float NewCost = NodeCost + GetEdgeCost(Edge);
+            if (NewCost < Costs[Target] && Filter.AcceptEdge(*this, Edge) && Filter.AcceptNode(*this, Target))
+            {
+                Costs[Target] = NewCost;
+                Parents[Target] = Node;
+                Open.HeapPush({ NewCost + (float)FVector::Dist(GetLocation(Target), GoalLocation), Target });
+            }
+        }
+    }
+
+    if (Costs[Goal] >= UE_MAX_FLT) return false;
+
+    for (int32 Node = Goal; Node != INDEX_NONE; Node = Parents[Node])
+    {
+        OutPath.Add(Node);
+    }
+    Algo::Reverse(OutPath);
+    return true;
+}
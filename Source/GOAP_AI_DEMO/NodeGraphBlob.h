@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Header of a cooked node graph blob (.ngraph).
+// Every section offset is in bytes from the start of the blob, so the file can be memory-mapped
+// at any address and read in place. Sections are 16-byte aligned and stored little-endian.
+struct FNodeGraphBlobHeader
+{
+    static constexpr uint32 ExpectedMagic = 0x4850474E; // "NGPH"
+    static constexpr uint32 CurrentVersion = 2;
+    static constexpr uint32 SectionAlignment = 16;
+
+    uint32 Magic;
+    uint32 Version;
+    uint32 TotalSize;
+    uint32 NumNodes;
+    uint32 NumEdges;
+
+    // Hash of node positions, types and links by node index (FNodeGraph::ComputeActorLayoutHash).
+    // Editor builds check it against the placed actors before a mapped blob is used.
+    uint32 LayoutHash;
+
+    // Per node
+    uint32 PosXOffset;          // float[NumNodes]
+    uint32 PosYOffset;          // float[NumNodes]
+    uint32 PosZOffset;          // float[NumNodes]
+    uint32 TypesOffset;         // uint8[NumNodes]
+    uint32 EdgeOffsetsOffset;   // int32[NumNodes + 1]
+    uint32 InEdgeOffsetsOffset; // int32[NumNodes + 1]
+
+    // Per edge
+    uint32 EdgeSourcesOffset;   // int32[NumEdges]
+    uint32 EdgeTargetsOffset;   // int32[NumEdges]
+    uint32 EdgeTypesOffset;     // uint8[NumEdges]
+    uint32 EdgeCostsOffset;     // float[NumEdges]
+    uint32 InEdgesOffset;       // int32[NumEdges]
+};
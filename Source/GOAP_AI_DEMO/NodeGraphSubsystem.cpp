@@ -0,0 +1,347 @@
+#include "NodeGraphSubsystem.h"
+#include "AIMemory.h"
+#include "DStarLitePath.h"
+#include "Node.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#if WITH_EDITOR
+#include "Editor.h"
+#include "UObject/ObjectSaveContext.h"
+#endif
+
+static TAutoConsoleVariable<float> CVarDangerCostScale(
+    TEXT("ai.NodeGraph.DangerCostScale"),
+    10.0f,
+    TEXT("Cost multiplier for links entering Danger nodes."));
+
+static TAutoConsoleVariable<int32> CVarPathRepairBudget(
+    TEXT("ai.NodeGraph.PathRepairBudget"),
+    2048,
+    TEXT("Maximum node expansions per active path per tick when repairing after cost changes."));
+
+namespace NodeGraphCommands
+{
+    static ANode* FindNode(UWorld* World, const FString& Name)
+    {
+        for (TActorIterator<ANode> It(World); It; ++It)
+        {
+            if (It->GetName() == Name || It->GetActorNameOrLabel() == Name) return *It;
+        }
+        return nullptr;
+    }
+
+    static void SetNodeTypeCommand(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+    {
+        ANode* Node = Args.Num() >= 2 ? FindNode(World, Args[0]) : nullptr;
+        const int64 Type = Args.Num() >= 2 ? StaticEnum<ENodeType>()->GetValueByNameString(Args[1]) : INDEX_NONE;
+        if (!Node || Type == INDEX_NONE)
+        {
+            Ar.Logf(TEXT("Usage: ai.NodeGraph.SetNodeType <Node> <Walk|Cover|Flank|Turret|Danger>"));
+            return;
+        }
+        Node->SetNodeType((ENodeType)Type);
+    }
+
+    static void SetCostScaleCommand(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+    {
+        UNodeGraphSubsystem* GraphSubsystem = UNodeGraphSubsystem::Get(World);
+        ANode* Node = Args.Num() >= 2 ? FindNode(World, Args[0]) : nullptr;
+        if (!GraphSubsystem || !Node)
+        {
+            Ar.Logf(TEXT("Usage: ai.NodeGraph.SetCostScale <Node> <Scale>"));
+            return;
+        }
+        GraphSubsystem->SetNodeCostScale(Node, FCString::Atof(*Args[1]));
+    }
+}
+
+// Stand-ins for grenades and fire zones: agents walking the graph repair their paths around the change
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdNodeGraphSetNodeType(
+    TEXT("ai.NodeGraph.SetNodeType"),
+    TEXT("Changes a node's type at runtime, e.g. to or from Danger. Arguments: node name, type."),
+    FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&NodeGraphCommands::SetNodeTypeCommand));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdNodeGraphSetCostScale(
+    TEXT("ai.NodeGraph.SetCostScale"),
+    TEXT("Sets a node's extra cost multiplier (1 = normal). Arguments: node name, scale."),
+    FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&NodeGraphCommands::SetCostScaleCommand));
+
+UNodeGraphSubsystem* UNodeGraphSubsystem::Get(const UWorld* World)
+{
+    return World ? World->GetSubsystem<UNodeGraphSubsystem>() : nullptr;
+}
+
+FString UNodeGraphSubsystem::GetCookedGraphPath(const UWorld* World)
+{
+    FString PackageName = UWorld::RemovePIEPrefix(World->GetOutermost()->GetName());
+    PackageName.RemoveFromStart(TEXT("/Game/"));
+    return FPaths::ProjectContentDir() / TEXT("NodeGraphs") / PackageName + TEXT(".ngraph");
+}
+
+void UNodeGraphSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+#if WITH_EDITOR
+    if (GetWorld()->WorldType == EWorldType::Editor || IsRunningCookCommandlet())
+    {
+        PreSaveWorldHandle = FEditorDelegates::PreSaveWorldWithContext.AddUObject(this, &UNodeGraphSubsystem::OnPreSaveWorld);
+    }
+#endif
+}
+
+void UNodeGraphSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+    LLM_SCOPE_BYTAG(AINodeGraph);
+
+    // Map the cooked graph in place; actors attach themselves in BeginPlay.
+    // Cooked builds trust the blob: it is rewritten whenever the level is saved or cooked.
+    const FString CookedPath = GetCookedGraphPath(&InWorld);
+    if (Graph.LoadMapped(CookedPath))
+    {
+#if WITH_EDITOR
+        // In the editor the level can be played with unsaved edits. Nodes moved, relinked,
+        // added or removed since the last save make the blob stale.
+        uint32 ActorHash = 0;
+        int32 NumActors = 0;
+        if (!FNodeGraph::ComputeActorLayoutHash(&InWorld, ActorHash, NumActors) || NumActors != Graph.NumNodes() || ActorHash != Graph.GetLayoutHash())
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Cooked node graph %s does not match the placed nodes (%d in blob, %d placed); recompiling from actors. Resave the level to refresh it."),
+                *CookedPath, Graph.NumNodes(), NumActors);
+            Graph.Reset();
+        }
+#endif
+    }
+
+    if (Graph.IsMapped())
+    {
+        ++GraphVersion;
+        bDirty = false;
+        OnGraphReplaced();
+
+        UE_LOG(LogTemp, Log, TEXT("Node graph mapped from %s: %d nodes, %d links."), *CookedPath, Graph.NumNodes(), Graph.NumEdges());
+        return;
+    }
+
+    // No cooked data; compile up front so the first query does not pay for it
+    MarkDirty();
+    GetGraph();
+}
+
+void UNodeGraphSubsystem::Deinitialize()
+{
+#if WITH_EDITOR
+    FEditorDelegates::PreSaveWorldWithContext.Remove(PreSaveWorldHandle);
+#endif
+
+    for (const TWeakPtr<FDStarLitePath>& WeakPath : ActivePaths)
+    {
+        if (TSharedPtr<FDStarLitePath> Path = WeakPath.Pin())
+        {
+            Path->Invalidate();
+        }
+    }
+    ActivePaths.Empty();
+    Graph.Reset();
+    Super::Deinitialize();
+}
+
+void UNodeGraphSubsystem::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+    Super::GetResourceSizeEx(CumulativeResourceSize);
+
+    CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Graph.GetAllocatedSize() + ExtraCostScales.GetAllocatedSize()
+        + PendingCostChanges.GetAllocatedSize() + ActivePaths.GetAllocatedSize());
+}
+
+void UNodeGraphSubsystem::RegisterNode(ANode* Node)
+{
+    LLM_SCOPE_BYTAG(AINodeGraph);
+
+    if (!Graph.IsMapped() || bDirty) return; // Runtime builds register their actors themselves
+
+    if (!Graph.RegisterActor(Node, Node->GraphIndex))
+    {
+        // The level changed after the graph was cooked; fall back to compiling from actors
+        UE_LOG(LogTemp, Warning, TEXT("%s has no slot in the cooked node graph; recompiling from actors. Resave the level to refresh it."), *Node->GetName());
+        MarkDirty();
+        return;
+    }
+
+    // Scales set before the actor attached could not be resolved to an index yet
+    if (ExtraCostScales.Contains(Node))
+    {
+        PendingCostChanges.Add(Node);
+    }
+}
+
+#if WITH_EDITOR
+void UNodeGraphSubsystem::OnPreSaveWorld(UWorld* SavedWorld, FObjectPreSaveContext SaveContext)
+{
+    // Cooking is a procedural save too, but the cooked actors and the blob must agree
+    if (SavedWorld != GetWorld() || (SaveContext.IsProceduralSave() && !SaveContext.IsCooking())) return;
+
+    // Indices are written onto the actors, which are saved right after this
+    FNodeGraph CookedGraph;
+    CookedGraph.Build(SavedWorld, true);
+
+    const FString CookedPath = GetCookedGraphPath(SavedWorld);
+    if (!CookedGraph.SaveBlob(CookedPath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to write cooked node graph to %s."), *CookedPath);
+    }
+}
+#endif
+
+TStatId UNodeGraphSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UNodeGraphSubsystem, STATGROUP_Tickables);
+}
+
+void UNodeGraphSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+    LLM_SCOPE_BYTAG(AINodeGraph);
+
+    // Many changes per second collapse into one repair per tick
+    FlushCostChanges();
+}
+
+const FNodeGraph& UNodeGraphSubsystem::GetGraph()
+{
+    if (bDirty)
+    {
+        Graph.Build(GetWorld());
+        ++GraphVersion;
+        bDirty = false;
+        OnGraphReplaced();
+
+        UE_LOG(LogTemp, Log, TEXT("Node graph compiled: %d nodes, %d links."), Graph.NumNodes(), Graph.NumEdges());
+    }
+    return Graph;
+}
+
+void UNodeGraphSubsystem::OnGraphReplaced()
+{
+    ApplyCostScales();
+
+    // Old indices are meaningless now
+    for (const TWeakPtr<FDStarLitePath>& WeakPath : ActivePaths)
+    {
+        if (TSharedPtr<FDStarLitePath> Path = WeakPath.Pin())
+        {
+            Path->Invalidate();
+        }
+    }
+    ActivePaths.Empty();
+    PendingCostChanges.Empty();
+}
+
+void UNodeGraphSubsystem::ApplyCostScales()
+{
+    for (int32 Index = 0; Index < Graph.NumNodes(); ++Index)
+    {
+        Graph.SetNodeCostScale(Index, GetCombinedScale(Graph.GetType(Index), 1.f));
+    }
+
+    // Extra scales are keyed by actor; mapped graphs pick them up as the actors register
+    for (const TPair<TWeakObjectPtr<const ANode>, float>& Pair : ExtraCostScales)
+    {
+        const int32 Index = Graph.GetNodeIndex(Pair.Key.Get());
+        if (Index != INDEX_NONE)
+        {
+            Graph.SetNodeCostScale(Index, GetCombinedScale(Graph.GetType(Index), Pair.Value));
+        }
+    }
+}
+
+TSharedPtr<FDStarLitePath> UNodeGraphSubsystem::CreatePath(int32 StartNode, int32 GoalNode)
+{
+    const FNodeGraph& CompiledGraph = GetGraph();
+    if (!CompiledGraph.IsValidNode(StartNode) || !CompiledGraph.IsValidNode(GoalNode))
+    {
+        return nullptr;
+    }
+
+    TSharedPtr<FDStarLitePath> Path = MakeShared<FDStarLitePath>(CompiledGraph, StartNode, GoalNode);
+    Path->ComputeShortestPath();
+    ActivePaths.Add(Path);
+    return Path;
+}
+
+TSharedPtr<FDStarLitePath> UNodeGraphSubsystem::CreatePath(const ANode* StartNode, const ANode* GoalNode)
+{
+    const FNodeGraph& CompiledGraph = GetGraph();
+    return CreatePath(CompiledGraph.GetNodeIndex(StartNode), CompiledGraph.GetNodeIndex(GoalNode));
+}
+
+void UNodeGraphSubsystem::SetNodeCostScale(const ANode* Node, float Scale)
+{
+    if (!Node) return;
+
+    ExtraCostScales.Add(Node, Scale);
+    PendingCostChanges.Add(Node);
+}
+
+void UNodeGraphSubsystem::NotifyNodeTypeChanged(const ANode* Node)
+{
+    if (!Node) return;
+
+    PendingCostChanges.Add(Node);
+}
+
+float UNodeGraphSubsystem::GetCombinedScale(ENodeType Type, float ExtraScale)
+{
+    const float TypeScale = Type == ENodeType::Danger ? CVarDangerCostScale.GetValueOnGameThread() : 1.f;
+    return TypeScale * ExtraScale;
+}
+
+void UNodeGraphSubsystem::FlushCostChanges()
+{
+    // A rebuild picks up every pending change by itself
+    GetGraph();
+
+    TArray<int32> ChangedNodes;
+    for (const TWeakObjectPtr<const ANode>& WeakNode : PendingCostChanges)
+    {
+        const ANode* Node = WeakNode.Get();
+        const int32 Index = Graph.GetNodeIndex(Node);
+        if (Index == INDEX_NONE) continue;
+
+        const float* ExtraScale = ExtraCostScales.Find(WeakNode);
+        const float NewScale = FMath::Max(GetCombinedScale(Node->NodeType, ExtraScale ? *ExtraScale : 1.f), 1.f);
+
+        Graph.SetType(Index, Node->NodeType);
+        if (Graph.GetNodeCostScale(Index) != NewScale)
+        {
+            Graph.SetNodeCostScale(Index, NewScale);
+            ChangedNodes.Add(Index);
+        }
+    }
+    PendingCostChanges.Reset();
+
+    const int32 RepairBudget = CVarPathRepairBudget.GetValueOnGameThread();
+    for (int32 PathIndex = ActivePaths.Num() - 1; PathIndex >= 0; --PathIndex)
+    {
+        TSharedPtr<FDStarLitePath> Path = ActivePaths[PathIndex].Pin();
+        if (!Path || !Path->IsValid())
+        {
+            ActivePaths.RemoveAtSwap(PathIndex, EAllowShrinking::No);
+            continue;
+        }
+
+        for (int32 Node : ChangedNodes)
+        {
+            Path->NotifyNodeCostChanged(Node);
+        }
+
+        // Paths that ran out of budget last tick keep repairing here
+        if (Path->NeedsRepair())
+        {
+            Path->ComputeShortestPath(RepairBudget);
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NodeGraph.h"
+#include "NodeGraphSubsystem.generated.h"
+
+class ANode;
+class FDStarLitePath;
+class FObjectPreSaveContext;
+
+// Owns the compiled node graph for a world.
+// At begin play the cooked .ngraph saved next to the level is memory-mapped; without one (or if it
+// is stale) the graph is compiled from the ANode actors, lazily, the first time it is requested after MarkDirty.
+// Runtime cost changes (danger zones, fire, grenades) are queued and applied once per tick,
+// then every active incremental path is repaired in place.
+UCLASS()
+class GOAP_AI_DEMO_API UNodeGraphSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static UNodeGraphSubsystem* Get(const UWorld* World);
+
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    virtual void Deinitialize() override;
+    virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // Compiled graph, rebuilt first if dirty
+    const FNodeGraph& GetGraph();
+
+    // Flags the graph for a rebuild, e.g. after nodes were added, moved or relinked
+    void MarkDirty() { bDirty = true; }
+
+    // Incremented on every rebuild; node indices from an older version are invalid
+    uint32 GetGraphVersion() const { return GraphVersion; }
+
+    // Called by ANode::BeginPlay to attach the actor to its cooked index
+    void RegisterNode(ANode* Node);
+
+    // Location of the cooked graph for a level: Content/NodeGraphs/<package path>.ngraph
+    static FString GetCookedGraphPath(const UWorld* World);
+
+    // Starts an incremental path search. The path is repaired automatically when costs change,
+    // and invalidated if the graph is recompiled. Callers own it; the subsystem only keeps a weak reference.
+    TSharedPtr<FDStarLitePath> CreatePath(int32 StartNode, int32 GoalNode);
+    TSharedPtr<FDStarLitePath> CreatePath(const ANode* StartNode, const ANode* GoalNode);
+
+    // Sets a node's extra cost multiplier (1 = normal). Applied on the next tick.
+    void SetNodeCostScale(const ANode* Node, float Scale);
+
+    // Re-reads a node's type after it changed at runtime, e.g. it became or stopped being Danger
+    void NotifyNodeTypeChanged(const ANode* Node);
+
+    // Applies queued cost changes and repairs active paths now instead of waiting for the tick
+    void FlushCostChanges();
+
+private:
+#if WITH_EDITOR
+    // Writes the cooked graph and node indices whenever the level is saved or cooked
+    void OnPreSaveWorld(UWorld* SavedWorld, FObjectPreSaveContext SaveContext);
+
+    FDelegateHandle PreSaveWorldHandle;
+#endif
+
+    // Seeds node cost scales from node types and SetNodeCostScale after the graph was (re)loaded
+    void ApplyCostScales();
+
+    // Invalidates handed-out paths and queued changes after the graph was (re)loaded
+    void OnGraphReplaced();
+
+    // Cost multiplier for a node of Type with an extra scale on top
+    static float GetCombinedScale(ENodeType Type, float ExtraScale);
+
+    FNodeGraph Graph;
+    uint32 GraphVersion = 0;
+    bool bDirty = true;
+
+    // Extra scales set through SetNodeCostScale, re-applied after a rebuild
+    TMap<TWeakObjectPtr<const ANode>, float> ExtraCostScales;
+
+    // Nodes whose cost changed since the last flush
+    TSet<TWeakObjectPtr<const ANode>> PendingCostChanges;
+
+    TArray<TWeakPtr<FDStarLitePath>> ActivePaths;
+};
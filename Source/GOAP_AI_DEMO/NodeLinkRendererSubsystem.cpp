@@ -0,0 +1,196 @@
+#include "NodeLinkRendererSubsystem.h"
+#include "Node.h"
+#include "Components/LineBatchComponent.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+
+namespace NodeLinkRenderer
+{
+    constexpr float LineThickness = 2.f;
+
+    // Below this many free slots compaction is not worth a full redraw
+    constexpr int32 MinFreeLinesToCompact = 256;
+}
+
+UNodeLinkRendererSubsystem* UNodeLinkRendererSubsystem::Get(const UWorld* World)
+{
+    return World ? World->GetSubsystem<UNodeLinkRendererSubsystem>() : nullptr;
+}
+
+bool UNodeLinkRendererSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+#if WITH_EDITOR
+    const UWorld* World = Cast<UWorld>(Outer);
+    return Super::ShouldCreateSubsystem(Outer) && World &&
+        (World->WorldType == EWorldType::Editor || World->WorldType == EWorldType::PIE);
+#else
+    return false;
+#endif
+}
+
+void UNodeLinkRendererSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    // Registered once the world's scene is up, in OnWorldComponentsUpdated
+    LineBatcher = NewObject<ULineBatchComponent>(this, TEXT("NodeLinkLines"), RF_Transient);
+
+    // Accurate bounds walk every line on each change; links span the whole level anyway
+    LineBatcher->bCalculateAccurateBounds = false;
+}
+
+void UNodeLinkRendererSubsystem::Deinitialize()
+{
+    if (LineBatcher && LineBatcher->IsRegistered())
+    {
+        LineBatcher->UnregisterComponent();
+    }
+    LineBatcher = nullptr;
+    Lines.Empty();
+    FreeLines.Empty();
+    LinesByNode.Empty();
+    Super::Deinitialize();
+}
+
+void UNodeLinkRendererSubsystem::OnWorldComponentsUpdated(UWorld& InWorld)
+{
+    Super::OnWorldComponentsUpdated(InWorld);
+
+    if (LineBatcher && !LineBatcher->IsRegistered())
+    {
+        LineBatcher->RegisterComponentWithWorld(&InWorld);
+    }
+
+    // Levels were added or reloaded; nodes loaded from disk do not run OnConstruction
+    RebuildAll();
+}
+
+void UNodeLinkRendererSubsystem::RebuildAll()
+{
+    if (!LineBatcher || !LineBatcher->IsRegistered()) return;
+
+    LineBatcher->Flush();
+    Lines.Reset();
+    FreeLines.Reset();
+    LinesByNode.Reset();
+
+    for (TActorIterator<ANode> It(GetWorld()); It; ++It)
+    {
+        UpdateNode(*It);
+    }
+}
+
+void UNodeLinkRendererSubsystem::UpdateNode(ANode* Node)
+{
+    if (!Node || !LineBatcher || !LineBatcher->IsRegistered()) return;
+
+    const TObjectKey<ANode> Key(Node);
+    const FVector Location = Node->GetActorLocation();
+    TArray<FBatchedLine>& BatchedLines = LineBatcher->BatchedLines;
+
+    // Outgoing links are redrawn from LinkedNodes; incoming ones only move their end
+    const TArray<int32> Touching = LinesByNode.FindRef(Key);
+    for (int32 Line : Touching)
+    {
+        if (Lines[Line].Source == Key)
+        {
+            FreeLine(Line);
+        }
+        else
+        {
+            BatchedLines[Line].End = Location;
+        }
+    }
+
+    for (const TPair<ANode*, ENodeConnectionType>& Pair : Node->LinkedNodes)
+    {
+        ANode* LinkedNode = Pair.Key;
+        if (!LinkedNode || LinkedNode == Node) continue;
+
+        const int32 Line = AllocateLine();
+        Lines[Line] = { Key, TObjectKey<ANode>(LinkedNode) };
+
+        FBatchedLine& BatchedLine = BatchedLines[Line];
+        BatchedLine.Start = Location;
+        BatchedLine.End = LinkedNode->GetActorLocation();
+        BatchedLine.Color = GetLinkColor(Pair.Value);
+        BatchedLine.Thickness = NodeLinkRenderer::LineThickness;
+        BatchedLine.RemainingLifeTime = 0.f;
+        BatchedLine.DepthPriority = SDPG_World;
+
+        LinesByNode.FindOrAdd(Key).Add(Line);
+        LinesByNode.FindOrAdd(Lines[Line].Target).Add(Line);
+    }
+
+    // Many nodes changing in one frame still produce a single proxy update
+    LineBatcher->MarkRenderStateDirty();
+    CompactIfNeeded();
+}
+
+void UNodeLinkRendererSubsystem::RemoveNode(const ANode* Node)
+{
+    if (!Node || !LineBatcher || !LineBatcher->IsRegistered()) return;
+
+    const TObjectKey<ANode> Key(Node);
+    const TArray<int32> Touching = LinesByNode.FindRef(Key);
+    for (int32 Line : Touching)
+    {
+        FreeLine(Line);
+    }
+    LinesByNode.Remove(Key);
+
+    LineBatcher->MarkRenderStateDirty();
+    CompactIfNeeded();
+}
+
+int32 UNodeLinkRendererSubsystem::AllocateLine()
+{
+    if (FreeLines.Num() > 0)
+    {
+        return FreeLines.Pop(EAllowShrinking::No);
+    }
+
+    LineBatcher->BatchedLines.AddDefaulted();
+    return Lines.AddDefaulted();
+}
+
+void UNodeLinkRendererSubsystem::FreeLine(int32 Line)
+{
+    FLinkLine& Link = Lines[Line];
+    if (TArray<int32>* SourceLines = LinesByNode.Find(Link.Source))
+    {
+        SourceLines->RemoveSingleSwap(Line, EAllowShrinking::No);
+    }
+    if (TArray<int32>* TargetLines = LinesByNode.Find(Link.Target))
+    {
+        TargetLines->RemoveSingleSwap(Line, EAllowShrinking::No);
+    }
+    Link = FLinkLine();
+
+    // Zero-length lines draw nothing; the slot is reused by the next link added
+    FBatchedLine& BatchedLine = LineBatcher->BatchedLines[Line];
+    BatchedLine.End = BatchedLine.Start;
+    BatchedLine.Thickness = 0.f;
+    FreeLines.Add(Line);
+}
+
+void UNodeLinkRendererSubsystem::CompactIfNeeded()
+{
+    if (FreeLines.Num() >= NodeLinkRenderer::MinFreeLinesToCompact && FreeLines.Num() * 2 > Lines.Num())
+    {
+        RebuildAll();
+    }
+}
+
+FLinearColor UNodeLinkRendererSubsystem::GetLinkColor(ENodeConnectionType ConnectionType)
+{
+    switch (ConnectionType)
+    {
+        case ENodeConnectionType::Jumping:
+            return FLinearColor::Yellow;
+        case ENodeConnectionType::Climbing:
+            return FLinearColor(1.f, 0.5f, 0.f);
+        default:
+            return FLinearColor::White;
+    }
+}
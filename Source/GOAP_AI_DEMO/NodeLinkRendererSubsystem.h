@@ -0,0 +1,65 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "NodeTypes.h"
+#include "NodeLinkRendererSubsystem.generated.h"
+
+class ANode;
+class ULineBatchComponent;
+
+// Draws every node link in the world through one line batch component.
+// Each link owns a slot in the batch; when a node is moved, relinked or deleted only the slots
+// touching that node are rewritten, so dragging one node costs O(its links) instead of O(graph).
+// Editor builds only.
+UCLASS()
+class GOAP_AI_DEMO_API UNodeLinkRendererSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static UNodeLinkRendererSubsystem* Get(const UWorld* World);
+
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+    virtual void OnWorldComponentsUpdated(UWorld& InWorld) override;
+
+    // Rewrites the links leaving Node and moves the ends of links entering it
+    void UpdateNode(ANode* Node);
+
+    // Drops every link touching Node
+    void RemoveNode(const ANode* Node);
+
+    // Clears the batch and redraws every node in the world
+    void RebuildAll();
+
+private:
+    struct FLinkLine
+    {
+        TObjectKey<ANode> Source;
+        TObjectKey<ANode> Target;
+    };
+
+    // Slot for a new line, reusing freed ones first
+    int32 AllocateLine();
+
+    // Hides a slot and unlinks it from both endpoints
+    void FreeLine(int32 Line);
+
+    // Packs the batch once most slots are free
+    void CompactIfNeeded();
+
+    static FLinearColor GetLinkColor(ENodeConnectionType ConnectionType);
+
+    UPROPERTY(Transient)
+    TObjectPtr<ULineBatchComponent> LineBatcher;
+
+    // Parallel to LineBatcher->BatchedLines
+    TArray<FLinkLine> Lines;
+    TArray<int32> FreeLines;
+
+    // Every slot a node is the source or target of
+    TMap<TObjectKey<ANode>, TArray<int32>> LinesByNode;
+};
@@ -0,0 +1,169 @@
+#include "NodeMeshRendererSubsystem.h"
+#include "Node.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Materials/MaterialInterface.h"
+
+UNodeMeshRendererSubsystem* UNodeMeshRendererSubsystem::Get(const UWorld* World)
+{
+    return World ? World->GetSubsystem<UNodeMeshRendererSubsystem>() : nullptr;
+}
+
+bool UNodeMeshRendererSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+    const UWorld* World = Cast<UWorld>(Outer);
+    return Super::ShouldCreateSubsystem(Outer) && World && World->IsGameWorld();
+}
+
+void UNodeMeshRendererSubsystem::Deinitialize()
+{
+    // The render actor goes down with the world
+    Batches.Empty();
+    BatchComponents.Empty();
+    InstanceLookup.Empty();
+    RenderActor = nullptr;
+    Super::Deinitialize();
+}
+
+bool UNodeMeshRendererSubsystem::AddNode(ANode* Node)
+{
+    if (!Node || !Node->MeshComponent) return false;
+
+    UStaticMesh* Mesh = Node->MeshComponent->GetStaticMesh();
+    if (!Mesh) return false;
+
+    if (InstanceLookup.Contains(Node))
+    {
+        UpdateNode(Node);
+        return true;
+    }
+
+    // Without a material that reads per-instance colour, fall back to the mesh's own, coloured per batch.
+    // A node that already made its colour instance shares its parent with the others.
+    UMaterialInterface* Material = Node->InstancedMaterial;
+    TOptional<ENodeType> ColorType;
+    if (!Material)
+    {
+        Material = Node->MeshComponent->GetMaterial(0);
+        if (const UMaterialInstanceDynamic* NodeMaterial = Cast<UMaterialInstanceDynamic>(Material))
+        {
+            Material = NodeMaterial->Parent;
+        }
+        ColorType = Node->NodeType;
+    }
+    if (!Material) return false;
+
+    const int32 BatchIndex = FindOrAddBatch(Mesh, Material, ColorType);
+    if (BatchIndex == INDEX_NONE) return false;
+
+    FNodeInstanceBatch& Batch = Batches[BatchIndex];
+    const int32 Instance = Batch.Component->AddInstance(Node->MeshComponent->GetComponentTransform(), true);
+    check(Instance == Batch.Nodes.Num());
+    Batch.Nodes.Add(Node);
+    SetInstanceColor(Batch.Component, Instance, Node->NodeType);
+
+    InstanceLookup.Add(Node, { BatchIndex, Instance });
+    return true;
+}
+
+void UNodeMeshRendererSubsystem::RemoveNode(const ANode* Node)
+{
+    FInstanceHandle Handle;
+    if (!InstanceLookup.RemoveAndCopyValue(Node, Handle)) return;
+
+    FNodeInstanceBatch& Batch = Batches[Handle.Batch];
+    if (Batch.Component)
+    {
+        Batch.Component->RemoveInstance(Handle.Instance);
+    }
+
+    // The component moved its last instance into the freed slot; follow it
+    Batch.Nodes.RemoveAtSwap(Handle.Instance, EAllowShrinking::No);
+    if (Batch.Nodes.IsValidIndex(Handle.Instance))
+    {
+        InstanceLookup.FindChecked(Batch.Nodes[Handle.Instance]).Instance = Handle.Instance;
+    }
+}
+
+void UNodeMeshRendererSubsystem::UpdateNode(ANode* Node)
+{
+    const FInstanceHandle* Handle = InstanceLookup.Find(Node);
+    if (!Handle || !Node->MeshComponent) return;
+
+    // The colour lives in the batch material, so a new type means a different batch
+    const TOptional<ENodeType>& ColorType = Batches[Handle->Batch].ColorType;
+    if (ColorType.IsSet() && ColorType.GetValue() != Node->NodeType)
+    {
+        RemoveNode(Node);
+        AddNode(Node);
+        return;
+    }
+
+    UInstancedStaticMeshComponent* Component = Batches[Handle->Batch].Component;
+    Component->UpdateInstanceTransform(Handle->Instance, Node->MeshComponent->GetComponentTransform(), true, false);
+    SetInstanceColor(Component, Handle->Instance, Node->NodeType);
+}
+
+int32 UNodeMeshRendererSubsystem::FindOrAddBatch(UStaticMesh* Mesh, UMaterialInterface* Material, TOptional<ENodeType> ColorType)
+{
+    const int32 Existing = Batches.IndexOfByPredicate([Mesh, Material, &ColorType](const FNodeInstanceBatch& Batch)
+    {
+        return Batch.Mesh == Mesh && Batch.Material == Material && Batch.ColorType == ColorType;
+    });
+    if (Existing != INDEX_NONE) return Existing;
+
+    UWorld* World = GetWorld();
+    if (!RenderActor)
+    {
+        FActorSpawnParameters SpawnParams;
+        SpawnParams.Name = TEXT("NodeMeshRenderer");
+        SpawnParams.NameMode = FActorSpawnParameters::ESpawnActorNameMode::Requested;
+        SpawnParams.ObjectFlags |= RF_Transient;
+        RenderActor = World->SpawnActor<AActor>(SpawnParams);
+        if (!RenderActor) return INDEX_NONE;
+
+        USceneComponent* Root = NewObject<USceneComponent>(RenderActor, TEXT("Root"));
+        RenderActor->SetRootComponent(Root);
+        Root->RegisterComponent();
+    }
+
+    UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(RenderActor);
+    Component->SetStaticMesh(Mesh);
+    if (ColorType.IsSet())
+    {
+        UMaterialInstanceDynamic* ColorMaterial = UMaterialInstanceDynamic::Create(Material, Component);
+        ColorMaterial->SetVectorParameterValue("BaseColor", ANode::GetNodeTypeColor(ColorType.GetValue()));
+        Component->SetMaterial(0, ColorMaterial);
+    }
+    else
+    {
+        Component->SetMaterial(0, Material);
+    }
+    Component->NumCustomDataFloats = 3;
+
+    // RemoveInstance moves the last instance into the hole instead of shifting every index after it
+    Component->bSupportRemoveAtSwap = true;
+
+    // The node actors keep their own collision; this is only for drawing
+    Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    Component->SetCanEverAffectNavigation(false);
+    Component->SetupAttachment(RenderActor->GetRootComponent());
+    Component->RegisterComponent();
+    BatchComponents.Add(Component);
+
+    FNodeInstanceBatch& Batch = Batches.AddDefaulted_GetRef();
+    Batch.Component = Component;
+    Batch.Mesh = Mesh;
+    Batch.Material = Material;
+    Batch.ColorType = ColorType;
+    return Batches.Num() - 1;
+}
+
+void UNodeMeshRendererSubsystem::SetInstanceColor(UInstancedStaticMeshComponent* Component, int32 Instance, ENodeType Type)
+{
+    const FLinearColor Color = ANode::GetNodeTypeColor(Type);
+    const float CustomData[] = { Color.R, Color.G, Color.B };
+    Component->SetCustomData(Instance, MakeArrayView(CustomData), true);
+}
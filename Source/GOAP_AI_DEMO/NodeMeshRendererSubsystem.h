@@ -0,0 +1,76 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "NodeTypes.h"
+#include "NodeMeshRendererSubsystem.generated.h"
+
+class ANode;
+class UInstancedStaticMeshComponent;
+class UMaterialInterface;
+class UStaticMesh;
+
+// Draws every node in a game world through shared instanced static meshes, one per mesh/material pair.
+// The node's type colour is stored as three floats of per-instance custom data (PerInstanceCustomData 0-2),
+// so there is no material instance per node and thousands of nodes render in a handful of draws.
+// Nodes without an InstancedMaterial are drawn with their mesh's own material instead, in one batch per
+// node type with the colour set on that batch's material. Editor worlds keep per-actor meshes so nodes stay selectable.
+UCLASS()
+class GOAP_AI_DEMO_API UNodeMeshRendererSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static UNodeMeshRendererSubsystem* Get(const UWorld* World);
+
+    virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+    virtual void Deinitialize() override;
+
+    // Adds an instance for Node. Returns false if the node has no mesh or material, in which case it keeps drawing itself.
+    bool AddNode(ANode* Node);
+
+    void RemoveNode(const ANode* Node);
+
+    // Refreshes a node's transform and type colour
+    void UpdateNode(ANode* Node);
+
+    bool IsInstanced(const ANode* Node) const { return InstanceLookup.Contains(Node); }
+
+private:
+    struct FNodeInstanceBatch
+    {
+        TObjectPtr<UInstancedStaticMeshComponent> Component;
+        TObjectPtr<UStaticMesh> Mesh;
+        TObjectPtr<UMaterialInterface> Material;
+
+        // Type whose colour is baked into the batch material, or None when instances carry their own colour
+        TOptional<ENodeType> ColorType;
+
+        // Node for each instance, kept in step with the component's remove-at-swap
+        TArray<TObjectKey<ANode>> Nodes;
+    };
+
+    struct FInstanceHandle
+    {
+        int32 Batch = INDEX_NONE;
+        int32 Instance = INDEX_NONE;
+    };
+
+    // Batch drawing Mesh with Material, created on first use. With a ColorType, the batch draws a copy of
+    // Material with that type's colour as its BaseColor.
+    int32 FindOrAddBatch(UStaticMesh* Mesh, UMaterialInterface* Material, TOptional<ENodeType> ColorType);
+
+    static void SetInstanceColor(UInstancedStaticMeshComponent* Component, int32 Instance, ENodeType Type);
+
+    // Transient actor owning the batch components
+    UPROPERTY(Transient)
+    TObjectPtr<AActor> RenderActor;
+
+    // Components are also referenced from RenderActor; this keeps them reachable for the batches
+    UPROPERTY(Transient)
+    TArray<TObjectPtr<UInstancedStaticMeshComponent>> BatchComponents;
+
+    TArray<FNodeInstanceBatch> Batches;
+    TMap<TObjectKey<ANode>, FInstanceHandle> InstanceLookup;
+};
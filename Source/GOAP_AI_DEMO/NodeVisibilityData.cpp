@@ -0,0 +1,324 @@
+#include "NodeVisibilityData.h"
+#include "Node.h"
+#include "EngineUtils.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "Async/ParallelFor.h"
+#include "Misc/Compression.h"
+#include "UObject/ObjectSaveContext.h"
+
+namespace NodeVisibility
+{
+    constexpr int32 CurrentBakeVersion = 1;
+
+    // Samples around the viewer's eye and up the target node's column
+    constexpr int32 NumViewerSamples = 7;
+    constexpr int32 NumTargetSamples = 3;
+
+    // Keeps ground targets just clear of the floor
+    constexpr float GroundOffset = 1.f;
+}
+
+ANodeVisibilityData::ANodeVisibilityData()
+{
+    PrimaryActorTick.bCanEverTick = false;
+}
+
+ANodeVisibilityData* ANodeVisibilityData::Get(const UWorld* World)
+{
+    if (!World) return nullptr;
+
+    for (TActorIterator<ANodeVisibilityData> It(World); It; ++It)
+    {
+        return *It;
+    }
+    return nullptr;
+}
+
+void ANodeVisibilityData::PostLoad()
+{
+    Super::PostLoad();
+    Decompress();
+}
+
+int32 ANodeVisibilityData::GetNodeIndex(const ANode* Node) const
+{
+    const int32* Index = NodeIndices.Find(Node);
+    return Index ? *Index : INDEX_NONE;
+}
+
+bool ANodeVisibilityData::AreIndicesVisible(int32 A, int32 B) const
+{
+    checkSlow(A >= 0 && A < NumNodes && B >= 0 && B < NumNodes);
+    return (Bits[A * WordsPerRow + (B >> 5)] & (1u << (B & 31))) != 0;
+}
+
+bool ANodeVisibilityData::AreIndicesOccluded(int32 A, int32 B) const
+{
+    // Pairs beyond MaxRange were never traced, so their cleared bit means nothing
+    return !AreIndicesVisible(A, B) && FVector::DistSquared(Eyes[A], Eyes[B]) <= FMath::Square(MaxRange);
+}
+
+bool ANodeVisibilityData::AreNodesVisible(const ANode* A, const ANode* B) const
+{
+    const int32 IndexA = GetNodeIndex(A);
+    const int32 IndexB = GetNodeIndex(B);
+    if (IndexA == INDEX_NONE || IndexB == INDEX_NONE)
+    {
+        return true; // Not baked; let the caller trace
+    }
+    return !AreIndicesOccluded(IndexA, IndexB);
+}
+
+int32 ANodeVisibilityData::FindNearestNodeIndex(const FVector& Location, float MaxDistance) const
+{
+    int32 BestIndex = INDEX_NONE;
+    double BestDistSq = FMath::Square(MaxDistance);
+
+    for (int32 Index = 0; Index < NumNodes; ++Index)
+    {
+        if (!Nodes[Index]) continue;
+
+        const double DistSq = FVector::DistSquared(Eyes[Index], Location);
+        if (DistSq < BestDistSq)
+        {
+            BestDistSq = DistSq;
+            BestIndex = Index;
+        }
+    }
+    return BestIndex;
+}
+
+void ANodeVisibilityData::GetVisibleNodes(const ANode* From, TArray<ANode*>& OutNodes, TOptional<ENodeType> TypeFilter) const
+{
+    CollectNodes(From, OutNodes, TypeFilter, true);
+}
+
+void ANodeVisibilityData::GetHiddenNodes(const ANode* From, TArray<ANode*>& OutNodes, TOptional<ENodeType> TypeFilter) const
+{
+    CollectNodes(From, OutNodes, TypeFilter, false);
+}
+
+void ANodeVisibilityData::CollectNodes(const ANode* From, TArray<ANode*>& OutNodes, TOptional<ENodeType> TypeFilter, bool bVisible) const
+{
+    const int32 Row = GetNodeIndex(From);
+    if (Row == INDEX_NONE) return;
+
+    // Walk the row a word at a time; hidden queries invert the word and drop untraced pairs
+    const uint32* RowBits = Bits.GetData() + Row * WordsPerRow;
+    const double MaxRangeSq = FMath::Square(MaxRange);
+    for (int32 Word = 0; Word < WordsPerRow; ++Word)
+    {
+        uint32 Mask = bVisible ? RowBits[Word] : ~RowBits[Word];
+        while (Mask)
+        {
+            const int32 Col = Word * 32 + FMath::CountTrailingZeros(Mask);
+            Mask &= Mask - 1;
+
+            if (Col >= NumNodes) break;
+            if (!bVisible && FVector::DistSquared(Eyes[Row], Eyes[Col]) > MaxRangeSq) continue;
+
+            ANode* Node = Nodes[Col];
+            if (Node && (!TypeFilter.IsSet() || Node->NodeType == TypeFilter.GetValue()))
+            {
+                OutNodes.Add(Node);
+            }
+        }
+    }
+}
+
+void ANodeVisibilityData::Decompress()
+{
+    Bits.Reset();
+    NodeIndices.Reset();
+    NumNodes = 0;
+    WordsPerRow = 0;
+
+    const int32 NumBakedNodes = Nodes.Num();
+    const int32 BakedWordsPerRow = FMath::DivideAndRoundUp(NumBakedNodes, 32);
+    const int32 ExpectedSize = NumBakedNodes * BakedWordsPerRow * (int32)sizeof(uint32);
+    if (NumBakedNodes == 0 || UncompressedSize != ExpectedSize || CompressedBits.Num() == 0 || Eyes.Num() != NumBakedNodes)
+    {
+        return;
+    }
+    if (BakeVersion != NodeVisibility::CurrentBakeVersion)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("%s: node visibility was baked by an older version; rebake required."), *GetName());
+        return;
+    }
+
+    Bits.SetNumUninitialized(NumBakedNodes * BakedWordsPerRow);
+    if (!FCompression::UncompressMemory(NAME_Zlib, Bits.GetData(), UncompressedSize, CompressedBits.GetData(), CompressedBits.Num()))
+    {
+        UE_LOG(LogTemp, Error, TEXT("%s: failed to decompress node visibility matrix; rebake required."), *GetName());
+        Bits.Reset();
+        return;
+    }
+
+    NumNodes = NumBakedNodes;
+    WordsPerRow = BakedWordsPerRow;
+    NodeIndices.Reserve(NumNodes);
+    for (int32 Index = 0; Index < NumNodes; ++Index)
+    {
+        if (Nodes[Index])
+        {
+            NodeIndices.Add(Nodes[Index], Index);
+        }
+    }
+}
+
+uint32 ANodeVisibilityData::ComputeLayoutHash(const TArray<ANode*>& InNodes) const
+{
+    uint32 Hash = HashCombine(HashCombine(GetTypeHash(MaxRange), GetTypeHash(EyeHeight)), GetTypeHash(ViewRadius));
+    for (const ANode* Node : InNodes)
+    {
+        Hash = HashCombine(Hash, Node ? GetTypeHash(Node->GetActorLocation()) : 0);
+    }
+    return Hash;
+}
+
+#if WITH_EDITOR
+TArray<ANode*> ANodeVisibilityData::GatherLevelNodes() const
+{
+    TArray<ANode*> LevelNodes;
+    if (ULevel* Level = GetLevel())
+    {
+        for (AActor* Actor : Level->Actors)
+        {
+            if (ANode* Node = Cast<ANode>(Actor))
+            {
+                LevelNodes.Add(Node);
+            }
+        }
+    }
+    return LevelNodes;
+}
+
+void ANodeVisibilityData::Bake()
+{
+    UWorld* World = GetWorld();
+    if (!World) return;
+
+    Modify();
+
+    Nodes = GatherLevelNodes();
+    const int32 NumBakedNodes = Nodes.Num();
+    const int32 BakedWordsPerRow = FMath::DivideAndRoundUp(NumBakedNodes, 32);
+
+    TArray<uint32> NewBits;
+    NewBits.SetNumZeroed(NumBakedNodes * BakedWordsPerRow);
+
+    // A viewer may stand anywhere within ViewRadius of an eye and look at any height of the other node's
+    // column (ground for the LOS filter, eyes for tactical queries), so both ends are sampled
+    using namespace NodeVisibility;
+    TArray<FVector> BakeEyes;
+    TArray<FVector> Viewers;
+    TArray<FVector> Targets;
+    BakeEyes.Reserve(NumBakedNodes);
+    Viewers.Reserve(NumBakedNodes * NumViewerSamples);
+    Targets.Reserve(NumBakedNodes * NumTargetSamples);
+    for (const ANode* Node : Nodes)
+    {
+        const FVector Ground = Node->GetActorLocation();
+        const FVector Eye = Ground + FVector(0, 0, EyeHeight);
+        BakeEyes.Add(Eye);
+
+        Viewers.Add(Eye);
+        Viewers.Add(Eye + FVector(ViewRadius, 0, 0));
+        Viewers.Add(Eye - FVector(ViewRadius, 0, 0));
+        Viewers.Add(Eye + FVector(0, ViewRadius, 0));
+        Viewers.Add(Eye - FVector(0, ViewRadius, 0));
+        Viewers.Add(Eye + FVector(0, 0, ViewRadius));
+        Viewers.Add(Eye - FVector(0, 0, FMath::Clamp(EyeHeight - GroundOffset, 0.f, ViewRadius)));
+
+        Targets.Add(Ground + FVector(0, 0, GroundOffset));
+        Targets.Add(Ground + FVector(0, 0, EyeHeight * 0.5f));
+        Targets.Add(Eye);
+    }
+
+    const double MaxRangeSq = FMath::Square(MaxRange);
+    const FCollisionObjectQueryParams ObjectParams(ECC_WorldStatic); // Static occluders only
+    FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(NodeVisibilityBake), true);
+
+    // Visible if any viewer sample around From sees any target sample on To
+    auto IsAnySampleVisible = [&](int32 From, int32 To)
+    {
+        for (int32 Viewer = 0; Viewer < NumViewerSamples; ++Viewer)
+        {
+            for (int32 Target = 0; Target < NumTargetSamples; ++Target)
+            {
+                if (!World->LineTraceTestByObjectType(Viewers[From * NumViewerSamples + Viewer], Targets[To * NumTargetSamples + Target], ObjectParams, TraceParams))
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+
+    // Upper triangle, one row per task; each task only writes its own row
+    ParallelFor(NumBakedNodes, [&](int32 Row)
+    {
+        uint32* RowBits = NewBits.GetData() + Row * BakedWordsPerRow;
+        RowBits[Row >> 5] |= 1u << (Row & 31);
+
+        for (int32 Col = Row + 1; Col < NumBakedNodes; ++Col)
+        {
+            if (FVector::DistSquared(BakeEyes[Row], BakeEyes[Col]) > MaxRangeSq)
+                continue;
+
+            // The matrix is symmetric, so a bit has to hold for a viewer at either end
+            if (IsAnySampleVisible(Row, Col) || IsAnySampleVisible(Col, Row))
+            {
+                RowBits[Col >> 5] |= 1u << (Col & 31);
+            }
+        }
+    });
+
+    // Mirror into the lower triangle so any row can be scanned directly
+    for (int32 Row = 0; Row < NumBakedNodes; ++Row)
+    {
+        for (int32 Col = Row + 1; Col < NumBakedNodes; ++Col)
+        {
+            if (NewBits[Row * BakedWordsPerRow + (Col >> 5)] & (1u << (Col & 31)))
+            {
+                NewBits[Col * BakedWordsPerRow + (Row >> 5)] |= 1u << (Row & 31);
+            }
+        }
+    }
+
+    UncompressedSize = NewBits.Num() * sizeof(uint32);
+    int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, UncompressedSize);
+    CompressedBits.SetNumUninitialized(CompressedSize);
+    if (!FCompression::CompressMemory(NAME_Zlib, CompressedBits.GetData(), CompressedSize, NewBits.GetData(), UncompressedSize))
+    {
+        UE_LOG(LogTemp, Error, TEXT("%s: failed to compress node visibility matrix."), *GetName());
+        CompressedBits.Reset();
+        UncompressedSize = 0;
+        Decompress();
+        return;
+    }
+    CompressedBits.SetNum(CompressedSize);
+    BakedLayoutHash = ComputeLayoutHash(Nodes);
+    BakeVersion = CurrentBakeVersion;
+    Eyes = MoveTemp(BakeEyes);
+
+    Decompress();
+
+    UE_LOG(LogTemp, Log, TEXT("Baked node visibility for %d nodes (%d bytes, %d compressed)."), NumNodes, UncompressedSize, CompressedBits.Num());
+}
+
+void ANodeVisibilityData::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+    Super::PreSave(ObjectSaveContext);
+
+    // Cooking ships whatever was baked in the editor; tracing needs the editor world's physics scene
+    if (bRebakeOnSave && !ObjectSaveContext.IsCooking() && !IsTemplate() && GetWorld())
+    {
+        if (ComputeLayoutHash(GatherLevelNodes()) != BakedLayoutHash)
+        {
+            Bake();
+        }
+    }
+}
+#endif
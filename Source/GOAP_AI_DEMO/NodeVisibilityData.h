@@ -0,0 +1,131 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "NodeTypes.h"
+#include "NodeVisibilityData.generated.h"
+
+class ANode;
+
+// Precomputed node-to-node visibility (PVS) for one level.
+// Place one in the level and press Bake; the bit matrix is compressed and saved with the level.
+// Only static geometry is baked, so a set bit still needs a trace if dynamic occluders matter.
+// A cleared bit means every baked sample was blocked: 7 points around the eye against 3 up the target's column.
+// That approximates occlusion, and only for pairs within MaxRange, from viewers within ViewRadius of the eye;
+// a line between the samples can still get through.
+UCLASS(hidecategories = (Actor, Advanced, Display, Events, Object, Attachment, Movement, Collision, Rendering, Input, LOD, Cooking, HLOD, Replication, Physics, DataLayers, WorldPartition))
+class GOAP_AI_DEMO_API ANodeVisibilityData : public AInfo
+{
+    GENERATED_BODY()
+
+public:
+    ANodeVisibilityData();
+
+    // Returns the visibility data placed in World, or nullptr if the level has none
+    static ANodeVisibilityData* Get(const UWorld* World);
+
+    // Node pairs further apart than this are not traced; their visibility is unknown and callers must trace
+    UPROPERTY(EditAnywhere, Category = "Visibility", meta = (ClampMin = "0"))
+    float MaxRange = 5000.f;
+
+    // Viewers this close to a node's eye may use its row. The bake traces from points this far around
+    // each eye to the full height of the other node, so a cleared bit holds for all of them.
+    UPROPERTY(EditAnywhere, Category = "Visibility", meta = (ClampMin = "0"))
+    float ViewRadius = 150.f;
+
+    // Height above each node that the bake traces start and end at
+    UPROPERTY(EditAnywhere, Category = "Visibility")
+    float EyeHeight = 100.f;
+
+    // Rebake automatically when the level is saved and the node layout has changed
+    UPROPERTY(EditAnywhere, Category = "Visibility")
+    bool bRebakeOnSave = true;
+
+#if WITH_EDITOR
+    // Traces between every node pair within MaxRange on all cores and stores the result
+    UFUNCTION(CallInEditor, Category = "Visibility")
+    void Bake();
+#endif
+
+    // True when a matrix has been baked and decompressed
+    bool IsBaked() const { return NumNodes > 0; }
+
+    // Index of Node in the matrix, or INDEX_NONE if it was not part of the bake
+    int32 GetNodeIndex(const ANode* Node) const;
+
+    // Bit test between two baked node indices. A cleared bit on its own means nothing for untraced pairs; use AreIndicesOccluded.
+    bool AreIndicesVisible(int32 A, int32 B) const;
+
+    // True only when the bake traced the pair and static geometry blocked every sample
+    bool AreIndicesOccluded(int32 A, int32 B) const;
+
+    // Bit test between two nodes; nodes missing from the bake or out of range are reported as visible so callers fall back to a trace
+    bool AreNodesVisible(const ANode* A, const ANode* B) const;
+
+    // Closest baked node to Location within MaxDistance, or INDEX_NONE
+    int32 FindNearestNodeIndex(const FVector& Location, float MaxDistance) const;
+
+    // Closest baked node whose row may stand in for a viewer at Location: within both MaxDistance and ViewRadius
+    int32 FindViewpointIndex(const FVector& Location, float MaxDistance) const
+    {
+        return FindNearestNodeIndex(Location, FMath::Min(MaxDistance, ViewRadius));
+    }
+
+    // Baked node for an index
+    ANode* GetNode(int32 Index) const { return Nodes.IsValidIndex(Index) ? Nodes[Index] : nullptr; }
+
+    // Collects nodes visible from From, optionally restricted to one node type
+    void GetVisibleNodes(const ANode* From, TArray<ANode*>& OutNodes, TOptional<ENodeType> TypeFilter = {}) const;
+
+    // Collects nodes the bake found hidden from From, optionally restricted to one node type (e.g. cover hidden from the player).
+    // Nodes beyond MaxRange are left out, as their visibility is unknown.
+    void GetHiddenNodes(const ANode* From, TArray<ANode*>& OutNodes, TOptional<ENodeType> TypeFilter = {}) const;
+
+    virtual void PostLoad() override;
+#if WITH_EDITOR
+    virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+#endif
+
+private:
+    // Inflates CompressedBits into Bits and rebuilds the node lookup
+    void Decompress();
+
+    // Hash of node positions and bake settings, used to detect a stale bake
+    uint32 ComputeLayoutHash(const TArray<ANode*>& InNodes) const;
+
+#if WITH_EDITOR
+    // All nodes currently in this actor's level
+    TArray<ANode*> GatherLevelNodes() const;
+#endif
+
+    void CollectNodes(const ANode* From, TArray<ANode*>& OutNodes, TOptional<ENodeType> TypeFilter, bool bVisible) const;
+
+    // Nodes in matrix order
+    UPROPERTY()
+    TArray<ANode*> Nodes;
+
+    // Zlib-compressed row-major bit matrix
+    UPROPERTY()
+    TArray<uint8> CompressedBits;
+
+    UPROPERTY()
+    int32 UncompressedSize = 0;
+
+    UPROPERTY()
+    uint32 BakedLayoutHash = 0;
+
+    // Bakes from before ViewRadius sampling are rejected at load
+    UPROPERTY()
+    int32 BakeVersion = 0;
+
+    // Eye of each node as baked, for the MaxRange check and viewpoint lookup
+    UPROPERTY()
+    TArray<FVector> Eyes;
+
+    // Decompressed matrix; row i starts at i * WordsPerRow
+    TArray<uint32> Bits;
+    int32 NumNodes = 0;
+    int32 WordsPerRow = 0;
+
+    TMap<const ANode*, int32> NodeIndices;
+};
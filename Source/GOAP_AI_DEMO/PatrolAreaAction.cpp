@@ -13,6 +13,7 @@ UPatrolAreaAction::UPatrolAreaAction()
     Effects.Add(FGOAPState("Alert", true)); // Add Alert state when player is spotted
 
     Cost = 1.0f;
+    CrowdBehavior = EGOAPCrowdBehavior::Patrol;
 }
 
 bool UPatrolAreaAction::CheckProceduralPrecondition(const TMap<FName, bool>& WorldState) const
@@ -0,0 +1,92 @@
+#include "PatrolPathCacheSubsystem.h"
+#include "AIMemory.h"
+#include "Node.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "NavMesh/NavMeshPath.h"
+#include "NavFilters/NavigationQueryFilter.h"
+#include "Engine/World.h"
+
+UPatrolPathCacheSubsystem* UPatrolPathCacheSubsystem::Get(const UWorld* World)
+{
+    return World ? World->GetSubsystem<UPatrolPathCacheSubsystem>() : nullptr;
+}
+
+void UPatrolPathCacheSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(&InWorld))
+    {
+        NavGenerationFinishedHandle = NavSys->OnNavigationGenerationFinishedDelegate.AddUObject(this, &UPatrolPathCacheSubsystem::OnNavigationGenerationFinished);
+    }
+}
+
+void UPatrolPathCacheSubsystem::Deinitialize()
+{
+    if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+    {
+        NavSys->OnNavigationGenerationFinishedDelegate.Remove(NavGenerationFinishedHandle);
+    }
+    Paths.Empty();
+    Super::Deinitialize();
+}
+
+void UPatrolPathCacheSubsystem::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+    Super::GetResourceSizeEx(CumulativeResourceSize);
+
+    SIZE_T Bytes = Paths.GetAllocatedSize();
+    for (const TPair<FSegmentKey, TArray<FVector>>& Path : Paths)
+    {
+        Bytes += Path.Value.GetAllocatedSize();
+    }
+    CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Bytes);
+}
+
+void UPatrolPathCacheSubsystem::Invalidate()
+{
+    Paths.Reset();
+}
+
+void UPatrolPathCacheSubsystem::OnNavigationGenerationFinished(ANavigationData* NavData)
+{
+    // Any tile may have changed under any route
+    Invalidate();
+}
+
+const TArray<FVector>* UPatrolPathCacheSubsystem::FindOrComputePath(const ANavigationData& NavData, const ANode* From, const ANode* To)
+{
+    LLM_SCOPE_BYTAG(AINodeGraph);
+
+    if (!From || !To) return nullptr;
+
+    const FSegmentKey Key{ From, To, &NavData };
+    if (const TArray<FVector>* Cached = Paths.Find(Key))
+    {
+        return Cached->Num() > 0 ? Cached : nullptr;
+    }
+
+    UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    if (!NavSys) return nullptr;
+
+    // Ask for the string-pulled corridor explicitly rather than relying on the navmesh default
+    FNavMeshPath* NavMeshPath = new FNavMeshPath();
+    NavMeshPath->SetWantsStringPulling(true);
+    FNavPathSharedPtr PathInstance = MakeShareable(NavMeshPath);
+
+    FPathFindingQuery Query(nullptr, NavData, From->GetActorLocation(), To->GetActorLocation(), UNavigationQueryFilter::GetQueryFilter(NavData, nullptr, nullptr), PathInstance);
+    const FPathFindingResult Result = NavSys->FindPathSync(Query);
+
+    TArray<FVector>& Points = Paths.Add(Key);
+    if (Result.IsSuccessful() && Result.Path.IsValid())
+    {
+        const TArray<FNavPathPoint>& PathPoints = Result.Path->GetPathPoints();
+        Points.Reserve(PathPoints.Num());
+        for (const FNavPathPoint& Point : PathPoints)
+        {
+            Points.Add(Point.Location);
+        }
+    }
+    return Points.Num() > 0 ? &Points : nullptr;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "PatrolPathCacheSubsystem.generated.h"
+
+class ANode;
+class ANavigationData;
+
+// Navmesh paths between consecutive patrol nodes, computed once and shared by every agent.
+// Paths are string-pulled when computed and only thrown away when the navmesh finishes rebuilding,
+// so agents walking known routes do no pathfinding in steady state.
+UCLASS()
+class GOAP_AI_DEMO_API UPatrolPathCacheSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static UPatrolPathCacheSubsystem* Get(const UWorld* World);
+
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    virtual void Deinitialize() override;
+    virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+    // Path points from From to To on NavData, computed on first use. Null if there is no path.
+    // The pointer is only valid until the next call.
+    const TArray<FVector>* FindOrComputePath(const ANavigationData& NavData, const ANode* From, const ANode* To);
+
+    // Drops every cached path
+    void Invalidate();
+
+    int32 GetNumCachedPaths() const { return Paths.Num(); }
+
+private:
+    struct FSegmentKey
+    {
+        TObjectKey<ANode> From;
+        TObjectKey<ANode> To;
+        TObjectKey<ANavigationData> NavData;
+
+        bool operator==(const FSegmentKey& Other) const
+        {
+            return From == Other.From && To == Other.To && NavData == Other.NavData;
+        }
+
+        friend uint32 GetTypeHash(const FSegmentKey& Key)
+        {
+            return HashCombine(HashCombine(GetTypeHash(Key.From), GetTypeHash(Key.To)), GetTypeHash(Key.NavData));
+        }
+    };
+
+    void OnNavigationGenerationFinished(ANavigationData* NavData);
+
+    // Empty arrays mark segments without a path so they are not queried again
+    TMap<FSegmentKey, TArray<FVector>> Paths;
+
+    FDelegateHandle NavGenerationFinishedHandle;
+};
@@ -0,0 +1,128 @@
+#include "ProjectilePoolSubsystem.h"
+#include "GOAP_AI_DEMOProjectile.h"
+#include "GOAP_AI_DEMOWeaponComponent.h"
+#include "ProjectileSimulationSubsystem.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarProjectilePoolPrewarm(
+    TEXT("projectile.Pool.Prewarm"),
+    32,
+    TEXT("Inactive projectiles spawned for each projectile class, at begin play for weapons already in the level or the first time any other class is fired."));
+
+UProjectilePoolSubsystem* UProjectilePoolSubsystem::Get(const UWorld* World)
+{
+    return World ? World->GetSubsystem<UProjectilePoolSubsystem>() : nullptr;
+}
+
+void UProjectilePoolSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    // Simulated rounds never touch the pool
+    if (UProjectileSimulationSubsystem::IsSimulationEnabled()) return;
+
+    // Weapon pickups placed in the level tell us which classes will be fired, so the first shot spawns nothing
+    const int32 Count = CVarProjectilePoolPrewarm.GetValueOnGameThread();
+    for (TActorIterator<AActor> It(&InWorld); It; ++It)
+    {
+        TInlineComponentArray<UGOAP_AI_DEMOWeaponComponent*> Weapons(*It);
+        for (const UGOAP_AI_DEMOWeaponComponent* Weapon : Weapons)
+        {
+            if (Weapon->ProjectileClass && !FreeLists.Contains(Weapon->ProjectileClass))
+            {
+                Prewarm(Weapon->ProjectileClass, Count);
+            }
+        }
+    }
+}
+
+void UProjectilePoolSubsystem::Deinitialize()
+{
+    UE_LOG(LogTemp, Log, TEXT("Projectile pool: %d spawned, at most %d in flight."), NumSpawned, HighWaterMark);
+
+    FreeLists.Empty();
+    Super::Deinitialize();
+}
+
+AGOAP_AI_DEMOProjectile* UProjectilePoolSubsystem::SpawnPooled(UClass* Class)
+{
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+    SpawnParams.ObjectFlags |= RF_Transient;
+
+    AGOAP_AI_DEMOProjectile* Projectile = GetWorld()->SpawnActor<AGOAP_AI_DEMOProjectile>(Class, FTransform::Identity, SpawnParams);
+    if (Projectile)
+    {
+        Projectile->DeactivateForPool();
+        ++NumSpawned;
+    }
+    return Projectile;
+}
+
+void UProjectilePoolSubsystem::Prewarm(TSubclassOf<AGOAP_AI_DEMOProjectile> Class, int32 Count)
+{
+    if (!Class) return;
+
+    TArray<TWeakObjectPtr<AGOAP_AI_DEMOProjectile>>& FreeList = FreeLists.FindOrAdd(Class);
+    while (FreeList.Num() < Count)
+    {
+        AGOAP_AI_DEMOProjectile* Projectile = SpawnPooled(Class);
+        if (!Projectile) break;
+        FreeList.Add(Projectile);
+    }
+}
+
+AGOAP_AI_DEMOProjectile* UProjectilePoolSubsystem::Acquire(TSubclassOf<AGOAP_AI_DEMOProjectile> Class, const FVector& Location, const FRotator& Rotation)
+{
+    if (!Class) return nullptr;
+
+    if (!FreeLists.Contains(Class))
+    {
+        Prewarm(Class, CVarProjectilePoolPrewarm.GetValueOnGameThread());
+    }
+
+    // Instances destroyed behind the pool's back (level streaming, editor) are skipped
+    AGOAP_AI_DEMOProjectile* Projectile = nullptr;
+    TArray<TWeakObjectPtr<AGOAP_AI_DEMOProjectile>>& FreeList = FreeLists.FindOrAdd(Class);
+    while (!Projectile && FreeList.Num() > 0)
+    {
+        Projectile = FreeList.Pop(EAllowShrinking::No).Get();
+    }
+    if (!Projectile)
+    {
+        Projectile = SpawnPooled(Class);
+        if (!Projectile) return nullptr;
+    }
+
+    FVector LaunchLocation = Location;
+    if (!FindLaunchLocation(*Projectile, LaunchLocation, Rotation))
+    {
+        FreeList.Add(Projectile);
+        return nullptr;
+    }
+
+    Projectile->ActivateFromPool(LaunchLocation, Rotation);
+    HighWaterMark = FMath::Max(HighWaterMark, ++NumActive);
+    return Projectile;
+}
+
+bool UProjectilePoolSubsystem::FindLaunchLocation(AGOAP_AI_DEMOProjectile& Projectile, FVector& Location, const FRotator& Rotation) const
+{
+    // Reused actors skip SpawnActor's collision handling, so do what it does for AdjustIfPossibleButDontSpawnIfColliding.
+    // Pooled projectiles have their collision off, and the test ignores components without it.
+    Projectile.SetActorEnableCollision(true);
+    const bool bFits = GetWorld()->FindTeleportSpot(&Projectile, Location, Rotation);
+    Projectile.SetActorEnableCollision(false);
+    return bFits;
+}
+
+void UProjectilePoolSubsystem::Release(AGOAP_AI_DEMOProjectile* Projectile)
+{
+    if (!Projectile || !Projectile->IsActiveInPool()) return;
+
+    Projectile->DeactivateForPool();
+    FreeLists.FindOrAdd(Projectile->GetClass()).Add(Projectile);
+    --NumActive;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ProjectilePoolSubsystem.generated.h"
+
+class AGOAP_AI_DEMOProjectile;
+
+// Recycles projectile actors instead of spawning and destroying one per shot.
+// Each projectile class gets its own pool of projectile.Pool.Prewarm hidden instances, spawned at begin play
+// for the weapons already in the level and on first use for any other class. Projectiles return to the pool
+// on hit or when their lifetime runs out.
+UCLASS()
+class GOAP_AI_DEMO_API UProjectilePoolSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static UProjectilePoolSubsystem* Get(const UWorld* World);
+
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+    virtual void Deinitialize() override;
+
+    // Spawns hidden, inactive instances until Class has Count free ones
+    void Prewarm(TSubclassOf<AGOAP_AI_DEMOProjectile> Class, int32 Count);
+
+    // A free projectile, or a new one if the pool is empty, launched from Location along Rotation.
+    // Like a spawn with AdjustIfPossibleButDontSpawnIfColliding, Location is moved out of blocking geometry,
+    // and nothing is launched if it cannot be.
+    AGOAP_AI_DEMOProjectile* Acquire(TSubclassOf<AGOAP_AI_DEMOProjectile> Class, const FVector& Location, const FRotator& Rotation);
+
+    // Deactivates Projectile and makes it available again
+    void Release(AGOAP_AI_DEMOProjectile* Projectile);
+
+    int32 GetNumActive() const { return NumActive; }
+    int32 GetHighWaterMark() const { return HighWaterMark; }
+    int32 GetNumSpawned() const { return NumSpawned; }
+
+private:
+    AGOAP_AI_DEMOProjectile* SpawnPooled(UClass* Class);
+
+    // Moves Location to where Projectile fits without blocking collision; false if there is no such spot nearby
+    bool FindLaunchLocation(AGOAP_AI_DEMOProjectile& Projectile, FVector& Location, const FRotator& Rotation) const;
+
+    TMap<UClass*, TArray<TWeakObjectPtr<AGOAP_AI_DEMOProjectile>>> FreeLists;
+
+    int32 NumActive = 0;
+
+    // Most projectiles in flight at once, and instances ever spawned
+    int32 HighWaterMark = 0;
+    int32 NumSpawned = 0;
+};
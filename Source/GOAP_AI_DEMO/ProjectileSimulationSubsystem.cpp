@@ -0,0 +1,224 @@
+#include "ProjectileSimulationSubsystem.h"
+#include "GOAP_AI_DEMOProjectile.h"
+#include "Components/SphereComponent.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/VectorRegister.h"
+
+static TAutoConsoleVariable<int32> CVarProjectileSimulationEnabled(
+    TEXT("projectile.Simulation.Enabled"),
+    0,
+    TEXT("If non-zero, weapons launch rounds into the projectile simulation instead of spawning projectile actors."));
+
+static TAutoConsoleVariable<int32> CVarProjectileSimulationMax(
+    TEXT("projectile.Simulation.MaxProjectiles"),
+    4096,
+    TEXT("Maximum simulated rounds in flight; launches beyond this are dropped."));
+
+namespace ProjectileSimulation
+{
+    // Same scale OnHit applies to the projectile velocity
+    constexpr float ImpulseScale = 100.f;
+
+    // Advances Num rounds: P += V*dt + G*dt^2/2 into Next, then V += G*dt
+    static void IntegrateBatch(const double* PosX, const double* PosY, const double* PosZ,
+        double* VelX, double* VelY, double* VelZ, const double* GravityZ, int32 Num, double DeltaTime,
+        double* NextX, double* NextY, double* NextZ)
+    {
+        const VectorRegister4Double Dt = VectorSetFloat1(DeltaTime);
+        const VectorRegister4Double HalfDtSq = VectorSetFloat1(0.5 * DeltaTime * DeltaTime);
+
+        int32 Index = 0;
+        for (; Index + 4 <= Num; Index += 4)
+        {
+            const VectorRegister4Double G = VectorLoad(GravityZ + Index);
+            const VectorRegister4Double VZ = VectorLoad(VelZ + Index);
+
+            VectorStore(VectorMultiplyAdd(VectorLoad(VelX + Index), Dt, VectorLoad(PosX + Index)), NextX + Index);
+            VectorStore(VectorMultiplyAdd(VectorLoad(VelY + Index), Dt, VectorLoad(PosY + Index)), NextY + Index);
+            VectorStore(VectorMultiplyAdd(G, HalfDtSq, VectorMultiplyAdd(VZ, Dt, VectorLoad(PosZ + Index))), NextZ + Index);
+            VectorStore(VectorMultiplyAdd(G, Dt, VZ), VelZ + Index);
+        }
+        for (; Index < Num; ++Index)
+        {
+            NextX[Index] = PosX[Index] + VelX[Index] * DeltaTime;
+            NextY[Index] = PosY[Index] + VelY[Index] * DeltaTime;
+            NextZ[Index] = PosZ[Index] + VelZ[Index] * DeltaTime + GravityZ[Index] * 0.5 * DeltaTime * DeltaTime;
+            VelZ[Index] += GravityZ[Index] * DeltaTime;
+        }
+    }
+}
+
+UProjectileSimulationSubsystem* UProjectileSimulationSubsystem::Get(const UWorld* World)
+{
+    return World ? World->GetSubsystem<UProjectileSimulationSubsystem>() : nullptr;
+}
+
+bool UProjectileSimulationSubsystem::IsSimulationEnabled()
+{
+    return CVarProjectileSimulationEnabled.GetValueOnGameThread() != 0;
+}
+
+void UProjectileSimulationSubsystem::Deinitialize()
+{
+    Types.Empty();
+    PosX.Empty(); PosY.Empty(); PosZ.Empty();
+    VelX.Empty(); VelY.Empty(); VelZ.Empty();
+    GravityZ.Empty(); LifeRemaining.Empty(); TypeIndex.Empty(); Owners.Empty();
+    NextX.Empty(); NextY.Empty(); NextZ.Empty();
+    Super::Deinitialize();
+}
+
+TStatId UProjectileSimulationSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UProjectileSimulationSubsystem, STATGROUP_Tickables);
+}
+
+int32 UProjectileSimulationSubsystem::FindOrAddType(TSubclassOf<AGOAP_AI_DEMOProjectile> Class)
+{
+    const int32 Existing = Types.IndexOfByPredicate([Class](const FProjectileType& Type) { return Type.Class == Class; });
+    if (Existing != INDEX_NONE) return Existing;
+
+    const AGOAP_AI_DEMOProjectile* Defaults = Class->GetDefaultObject<AGOAP_AI_DEMOProjectile>();
+    const USphereComponent* Collision = Defaults->GetCollisionComp();
+    const UProjectileMovementComponent* Movement = Defaults->GetProjectileMovement();
+
+    FProjectileType& Type = Types.AddDefaulted_GetRef();
+    Type.Class = Class;
+    Type.CollisionProfile = Collision->GetCollisionProfileName();
+    Type.Radius = Collision->GetUnscaledSphereRadius();
+    Type.InitialSpeed = Movement->InitialSpeed;
+    Type.MaxSpeed = Movement->MaxSpeed;
+    Type.GravityScale = Movement->ProjectileGravityScale;
+    Type.Bounciness = Movement->Bounciness;
+    Type.Friction = Movement->Friction;
+    Type.StopSpeed = Movement->BounceVelocityStopSimulatingThreshold;
+    Type.LifeSpan = Defaults->InitialLifeSpan;
+    Type.bShouldBounce = Movement->bShouldBounce;
+    return Types.Num() - 1;
+}
+
+bool UProjectileSimulationSubsystem::Launch(TSubclassOf<AGOAP_AI_DEMOProjectile> Class, const FVector& Location, const FRotator& Rotation, AActor* Owner)
+{
+    if (!Class || PosX.Num() >= CVarProjectileSimulationMax.GetValueOnGameThread()) return false;
+
+    const int32 Type = FindOrAddType(Class);
+    const FVector Velocity = Rotation.Vector() * Types[Type].InitialSpeed;
+
+    PosX.Add(Location.X); PosY.Add(Location.Y); PosZ.Add(Location.Z);
+    VelX.Add(Velocity.X); VelY.Add(Velocity.Y); VelZ.Add(Velocity.Z);
+    GravityZ.Add(GetWorld()->GetGravityZ() * Types[Type].GravityScale);
+    LifeRemaining.Add(Types[Type].LifeSpan > 0.f ? Types[Type].LifeSpan : UE_BIG_NUMBER);
+    TypeIndex.Add(Type);
+    Owners.Add(Owner);
+    return true;
+}
+
+void UProjectileSimulationSubsystem::RemoveProjectile(int32 Index)
+{
+    PosX.RemoveAtSwap(Index, EAllowShrinking::No); PosY.RemoveAtSwap(Index, EAllowShrinking::No); PosZ.RemoveAtSwap(Index, EAllowShrinking::No);
+    VelX.RemoveAtSwap(Index, EAllowShrinking::No); VelY.RemoveAtSwap(Index, EAllowShrinking::No); VelZ.RemoveAtSwap(Index, EAllowShrinking::No);
+    GravityZ.RemoveAtSwap(Index, EAllowShrinking::No);
+    LifeRemaining.RemoveAtSwap(Index, EAllowShrinking::No);
+    TypeIndex.RemoveAtSwap(Index, EAllowShrinking::No);
+    Owners.RemoveAtSwap(Index, EAllowShrinking::No);
+    NextX.RemoveAtSwap(Index, EAllowShrinking::No); NextY.RemoveAtSwap(Index, EAllowShrinking::No); NextZ.RemoveAtSwap(Index, EAllowShrinking::No);
+}
+
+void UProjectileSimulationSubsystem::Integrate(float DeltaTime)
+{
+    const int32 Num = PosX.Num();
+    NextX.SetNumUninitialized(Num, EAllowShrinking::No);
+    NextY.SetNumUninitialized(Num, EAllowShrinking::No);
+    NextZ.SetNumUninitialized(Num, EAllowShrinking::No);
+
+    ProjectileSimulation::IntegrateBatch(PosX.GetData(), PosY.GetData(), PosZ.GetData(),
+        VelX.GetData(), VelY.GetData(), VelZ.GetData(), GravityZ.GetData(), Num, DeltaTime,
+        NextX.GetData(), NextY.GetData(), NextZ.GetData());
+
+    for (float& Life : LifeRemaining)
+    {
+        Life -= DeltaTime;
+    }
+}
+
+bool UProjectileSimulationSubsystem::SweepProjectile(int32 Index, FCollisionQueryParams& QueryParams)
+{
+    const FVector Start(PosX[Index], PosY[Index], PosZ[Index]);
+    const FVector End(NextX[Index], NextY[Index], NextZ[Index]);
+    if (Start.Equals(End)) return true;
+
+    const FProjectileType& Type = Types[TypeIndex[Index]];
+    QueryParams.ClearIgnoredSourceObjects();
+    if (AActor* Owner = Owners[Index].Get())
+    {
+        QueryParams.AddIgnoredActor(Owner);
+    }
+
+    FHitResult Hit;
+    ++NumSweepsLastFrame;
+    if (!GetWorld()->SweepSingleByProfile(Hit, Start, End, FQuat::Identity, Type.CollisionProfile, FCollisionShape::MakeSphere(Type.Radius), QueryParams))
+    {
+        PosX[Index] = End.X; PosY[Index] = End.Y; PosZ[Index] = End.Z;
+        return true;
+    }
+
+    FVector Velocity(VelX[Index], VelY[Index], VelZ[Index]);
+
+    // Same as AGOAP_AI_DEMOProjectile::OnHit: push physics objects and stop there
+    UPrimitiveComponent* OtherComp = Hit.GetComponent();
+    if (OtherComp && OtherComp->IsSimulatingPhysics())
+    {
+        OtherComp->AddImpulseAtLocation(Velocity * ProjectileSimulation::ImpulseScale, Hit.Location);
+        return false;
+    }
+
+    // Anything else is bounced off, or stopped against, like UProjectileMovementComponent does
+    PosX[Index] = Hit.Location.X; PosY[Index] = Hit.Location.Y; PosZ[Index] = Hit.Location.Z;
+    if (Type.bShouldBounce)
+    {
+        const FVector Normal = Hit.Normal;
+        const FVector NormalPart = Normal * (Velocity | Normal);
+        Velocity = (Velocity - NormalPart) * (1.f - Type.Friction) - NormalPart * Type.Bounciness;
+        if (Velocity.SizeSquared() < FMath::Square(Type.StopSpeed))
+        {
+            Velocity = FVector::ZeroVector;
+        }
+        else if (Type.MaxSpeed > 0.f)
+        {
+            Velocity = Velocity.GetClampedToMaxSize(Type.MaxSpeed);
+        }
+    }
+    else
+    {
+        Velocity = FVector::ZeroVector;
+    }
+
+    // Resting rounds stop falling until their lifetime runs out
+    if (Velocity.IsZero())
+    {
+        GravityZ[Index] = 0.0;
+    }
+    VelX[Index] = Velocity.X; VelY[Index] = Velocity.Y; VelZ[Index] = Velocity.Z;
+    return true;
+}
+
+void UProjectileSimulationSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    NumSweepsLastFrame = 0;
+    if (PosX.Num() == 0) return;
+
+    Integrate(DeltaTime);
+
+    FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ProjectileSimulation), false);
+    for (int32 Index = PosX.Num() - 1; Index >= 0; --Index)
+    {
+        if (LifeRemaining[Index] <= 0.f || !SweepProjectile(Index, QueryParams))
+        {
+            RemoveProjectile(Index);
+        }
+    }
+}
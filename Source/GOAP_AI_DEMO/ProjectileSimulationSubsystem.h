@@ -0,0 +1,77 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ProjectileSimulationSubsystem.generated.h"
+
+class AGOAP_AI_DEMOProjectile;
+
+// Projectiles without actors, enabled with projectile.Simulation.Enabled.
+// Rounds are stored as structure-of-arrays records and moved in one pass per frame, four at a time,
+// then swept one after another with a shared shape and query. Movement settings, radius, collision
+// profile and lifetime come from the projectile class defaults, so a round flies, bounces and pushes
+// physics objects the way an AGOAP_AI_DEMOProjectile of that class would.
+UCLASS()
+class GOAP_AI_DEMO_API UProjectileSimulationSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static UProjectileSimulationSubsystem* Get(const UWorld* World);
+
+    // True when projectile.Simulation.Enabled is set; weapons then launch rounds here
+    static bool IsSimulationEnabled();
+
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    virtual void Deinitialize() override;
+
+    // Launches a round of Class from Location along Rotation. Owner is ignored by its sweeps.
+    // Returns false once projectile.Simulation.MaxProjectiles rounds are in flight.
+    bool Launch(TSubclassOf<AGOAP_AI_DEMOProjectile> Class, const FVector& Location, const FRotator& Rotation, AActor* Owner = nullptr);
+
+    int32 GetNumProjectiles() const { return PosX.Num(); }
+    int32 GetNumSweepsLastFrame() const { return NumSweepsLastFrame; }
+
+private:
+    // Class defaults shared by every round of one projectile class
+    struct FProjectileType
+    {
+        TSubclassOf<AGOAP_AI_DEMOProjectile> Class;
+        FName CollisionProfile;
+        float Radius = 0.f;
+        float InitialSpeed = 0.f;
+        float MaxSpeed = 0.f;
+        float GravityScale = 0.f;
+        float Bounciness = 0.f;
+        float Friction = 0.f;
+        float StopSpeed = 0.f;
+        float LifeSpan = 0.f;
+        bool bShouldBounce = false;
+    };
+
+    int32 FindOrAddType(TSubclassOf<AGOAP_AI_DEMOProjectile> Class);
+
+    // Moves every round by DeltaTime into NextX/Y/Z and ages it
+    void Integrate(float DeltaTime);
+
+    // Sweeps every moving round from its position to its next one; returns false if it should be removed
+    bool SweepProjectile(int32 Index, FCollisionQueryParams& QueryParams);
+
+    void RemoveProjectile(int32 Index);
+
+    TArray<FProjectileType> Types;
+
+    // One entry per round in flight
+    TArray<double> PosX, PosY, PosZ;
+    TArray<double> VelX, VelY, VelZ;
+    TArray<double> GravityZ;
+    TArray<float> LifeRemaining;
+    TArray<int32> TypeIndex;
+    TArray<TWeakObjectPtr<AActor>> Owners;
+
+    // Positions at the end of this frame's move, before sweeps
+    TArray<double> NextX, NextY, NextZ;
+
+    int32 NumSweepsLastFrame = 0;
+};
@@ -0,0 +1,361 @@
+#include "SightSubsystem.h"
+#include "AIMemory.h"
+#include "AI_Character_Controller.h"
+#include "GOAPStats.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/VectorRegister.h"
+
+static TAutoConsoleVariable<int32> CVarSightCentralized(
+    TEXT("ai.Sight.Centralized"),
+    0,
+    TEXT("If non-zero, AI controllers that begin play use the shared sight subsystem instead of their own perception sight sense."));
+
+static TAutoConsoleVariable<int32> CVarSightMaxTraces(
+    TEXT("ai.Sight.MaxTracesPerFrame"),
+    64,
+    TEXT("Maximum line of sight traces per frame; the rest of the observer/target pairs keep their last result."));
+
+namespace Sight
+{
+    // Sets Pass[i] for every observer within RadiusSq of Target and inside its view cone
+    static void CullBatch(const float* EyeX, const float* EyeY, const float* EyeZ,
+        const float* DirX, const float* DirY, const float* DirZ,
+        const float* RadiusSq, const float* CosHalfAngle, int32 Num, const FVector3f& Target, uint8* OutPass)
+    {
+        const VectorRegister4Float TargetX = VectorSetFloat1(Target.X);
+        const VectorRegister4Float TargetY = VectorSetFloat1(Target.Y);
+        const VectorRegister4Float TargetZ = VectorSetFloat1(Target.Z);
+
+        int32 Index = 0;
+        for (; Index + 4 <= Num; Index += 4)
+        {
+            const VectorRegister4Float DX = VectorSubtract(TargetX, VectorLoad(EyeX + Index));
+            const VectorRegister4Float DY = VectorSubtract(TargetY, VectorLoad(EyeY + Index));
+            const VectorRegister4Float DZ = VectorSubtract(TargetZ, VectorLoad(EyeZ + Index));
+            const VectorRegister4Float DistSq = VectorMultiplyAdd(DX, DX, VectorMultiplyAdd(DY, DY, VectorMultiply(DZ, DZ)));
+            const VectorRegister4Float Dot = VectorMultiplyAdd(DX, VectorLoad(DirX + Index),
+                VectorMultiplyAdd(DY, VectorLoad(DirY + Index), VectorMultiply(DZ, VectorLoad(DirZ + Index))));
+
+            // In range, and the angle to the target is within the half angle: Dot >= Cos * |D|
+            const VectorRegister4Float InRange = VectorCompareLE(DistSq, VectorLoad(RadiusSq + Index));
+            const VectorRegister4Float InCone = VectorCompareGE(Dot, VectorMultiply(VectorLoad(CosHalfAngle + Index), VectorSqrt(DistSq)));
+            const int32 Mask = VectorMaskBits(VectorBitwiseAnd(InRange, InCone));
+
+            OutPass[Index + 0] = (Mask & 1) != 0;
+            OutPass[Index + 1] = (Mask & 2) != 0;
+            OutPass[Index + 2] = (Mask & 4) != 0;
+            OutPass[Index + 3] = (Mask & 8) != 0;
+        }
+        for (; Index < Num; ++Index)
+        {
+            const FVector3f D(Target.X - EyeX[Index], Target.Y - EyeY[Index], Target.Z - EyeZ[Index]);
+            const float DistSq = D.SizeSquared();
+            const float Dot = D.X * DirX[Index] + D.Y * DirY[Index] + D.Z * DirZ[Index];
+            OutPass[Index] = DistSq <= RadiusSq[Index] && Dot >= CosHalfAngle[Index] * FMath::Sqrt(DistSq);
+        }
+    }
+}
+
+USightSubsystem* USightSubsystem::Get(const UWorld* World)
+{
+    return World ? World->GetSubsystem<USightSubsystem>() : nullptr;
+}
+
+bool USightSubsystem::IsCentralizedSightEnabled()
+{
+    return CVarSightCentralized.GetValueOnGameThread() != 0;
+}
+
+void USightSubsystem::Deinitialize()
+{
+    Observers.Empty();
+    ExtraTargets.Empty();
+    Pairs.Empty();
+    Super::Deinitialize();
+}
+
+void USightSubsystem::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+    Super::GetResourceSizeEx(CumulativeResourceSize);
+
+    SIZE_T Bytes = Observers.GetAllocatedSize() + ExtraTargets.GetAllocatedSize() + Pairs.GetAllocatedSize()
+        + Targets.GetAllocatedSize() + Cells.GetAllocatedSize() + Candidates.GetAllocatedSize() + CandidatePairs.GetAllocatedSize()
+        + (EyeX.GetAllocatedSize() + DirX.GetAllocatedSize()) * 3;
+    for (const FSightObserver& Observer : Observers)
+    {
+        Bytes += Observer.Seen.GetAllocatedSize() + Observer.SeenThisFrame.GetAllocatedSize();
+    }
+    for (const TPair<FIntPoint, TArray<int32>>& Cell : Cells)
+    {
+        Bytes += Cell.Value.GetAllocatedSize();
+    }
+    CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Bytes);
+}
+
+TStatId USightSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(USightSubsystem, STATGROUP_Tickables);
+}
+
+void USightSubsystem::RegisterObserver(AAI_Character_Controller* Controller, float SightRadius, float LoseSightRadius, float HalfAngleDegrees)
+{
+    LLM_SCOPE_BYTAG(AIPerception);
+
+    if (!Controller) return;
+
+    FSightObserver* Observer = Observers.FindByPredicate([Controller](const FSightObserver& Entry) { return Entry.Controller.Get() == Controller; });
+    if (!Observer)
+    {
+        Observer = &Observers.AddDefaulted_GetRef();
+        Observer->Controller = Controller;
+    }
+
+    LoseSightRadius = FMath::Max(LoseSightRadius, SightRadius);
+    Observer->SightRadiusSq = FMath::Square(SightRadius);
+    Observer->LoseSightRadiusSq = FMath::Square(LoseSightRadius);
+    Observer->CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(HalfAngleDegrees, 0.f, 180.f)));
+
+    // One ring of neighbouring cells then covers every observer that could see a target
+    CellSize = FMath::Max(CellSize, LoseSightRadius);
+}
+
+void USightSubsystem::UnregisterObserver(AAI_Character_Controller* Controller)
+{
+    Observers.RemoveAll([Controller](const FSightObserver& Entry) { return Entry.Controller.Get() == Controller; });
+
+    const TObjectKey<AAI_Character_Controller> Key(Controller);
+    for (auto It = Pairs.CreateIterator(); It; ++It)
+    {
+        if (It.Key().Key == Key) It.RemoveCurrent();
+    }
+}
+
+bool USightSubsystem::SetObserverTraceInterval(const AAI_Character_Controller* Controller, float Interval)
+{
+    FSightObserver* Observer = Observers.FindByPredicate([Controller](const FSightObserver& Entry) { return Entry.Controller.Get() == Controller; });
+    if (!Observer) return false;
+
+    Observer->TraceInterval = FMath::Max(Interval, 0.f);
+    return true;
+}
+
+void USightSubsystem::RegisterTarget(AActor* Target)
+{
+    if (Target) ExtraTargets.AddUnique(Target);
+}
+
+void USightSubsystem::UnregisterTarget(AActor* Target)
+{
+    ExtraTargets.Remove(Target);
+}
+
+void USightSubsystem::FCullBatch::Reset()
+{
+    Observers.Reset();
+    EyeX.Reset(); EyeY.Reset(); EyeZ.Reset();
+    DirX.Reset(); DirY.Reset(); DirZ.Reset();
+    RadiusSq.Reset(); CosHalfAngle.Reset();
+}
+
+void USightSubsystem::FCullBatch::Add(int32 Observer, const USightSubsystem& Owner)
+{
+    Observers.Add(Observer);
+    EyeX.Add(Owner.EyeX[Observer]); EyeY.Add(Owner.EyeY[Observer]); EyeZ.Add(Owner.EyeZ[Observer]);
+    DirX.Add(Owner.DirX[Observer]); DirY.Add(Owner.DirY[Observer]); DirZ.Add(Owner.DirZ[Observer]);
+
+    // Culled with the larger radius; pairs not yet visible are checked against the sight radius afterwards
+    RadiusSq.Add(Owner.Observers[Observer].LoseSightRadiusSq);
+    CosHalfAngle.Add(Owner.Observers[Observer].CosHalfAngle);
+}
+
+void USightSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+    LLM_SCOPE_BYTAG(AIPerception);
+    GOAPStats::FScopedSubsystemTimer Timer(EGOAPTimedSubsystem::Sight);
+
+    Observers.RemoveAll([](const FSightObserver& Observer) { return !Observer.Controller.IsValid(); });
+    if (Observers.Num() == 0) return;
+
+    UWorld* World = GetWorld();
+    const double Now = World->GetTimeSeconds();
+
+    Targets.Reset();
+    for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+    {
+        if (APawn* Pawn = It->IsValid() ? (*It)->GetPawn() : nullptr)
+        {
+            Targets.AddUnique(Pawn);
+        }
+    }
+    ExtraTargets.RemoveAll([](const TWeakObjectPtr<AActor>& Target) { return !Target.IsValid(); });
+    for (const TWeakObjectPtr<AActor>& Target : ExtraTargets)
+    {
+        Targets.AddUnique(Target.Get());
+    }
+
+    GatherObserverPoses();
+
+    Candidates.Reset();
+    CandidatePairs.Reset();
+    for (int32 TargetIndex = 0; TargetIndex < Targets.Num(); ++TargetIndex)
+    {
+        CullForTarget(TargetIndex, Targets[TargetIndex]->GetActorLocation(), Now);
+    }
+
+    // Pairs that left range or the view cone are no longer visible
+    for (auto It = Pairs.CreateIterator(); It; ++It)
+    {
+        if (!CandidatePairs.Contains(It.Key())) It.RemoveCurrent();
+    }
+
+    // Stalest due pairs first; pairs that just came into range have never been traced
+    Candidates.Sort([](const FTraceCandidate& A, const FTraceCandidate& B)
+    {
+        return A.bDue != B.bDue ? A.bDue : A.LastTraceTime < B.LastTraceTime;
+    });
+
+    const int32 MaxTraces = FMath::Max(CVarSightMaxTraces.GetValueOnGameThread(), 0);
+    NumTracesLastFrame = 0;
+    for (; NumTracesLastFrame < Candidates.Num() && NumTracesLastFrame < MaxTraces; ++NumTracesLastFrame)
+    {
+        const FTraceCandidate& Candidate = Candidates[NumTracesLastFrame];
+        if (!Candidate.bDue) break;
+
+        AAI_Character_Controller* Controller = Observers[Candidate.Observer].Controller.Get();
+        AActor* Target = Targets[Candidate.Target];
+
+        const FVector Eye(EyeX[Candidate.Observer], EyeY[Candidate.Observer], EyeZ[Candidate.Observer]);
+        FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(CentralSight), true, Controller->GetPawn());
+        TraceParams.AddIgnoredActor(Target);
+
+        FSightPair& Pair = Pairs.FindChecked(FPairKey(Controller, Target));
+        Pair.bVisible = !World->LineTraceTestByChannel(Eye, Target->GetActorLocation(), ECC_Visibility, TraceParams);
+        Pair.LastTraceTime = Now;
+    }
+
+    // Collect what each observer sees and notify those whose set changed
+    for (FSightObserver& Observer : Observers)
+    {
+        Observer.SeenThisFrame.Reset();
+    }
+    for (const FTraceCandidate& Candidate : Candidates)
+    {
+        FSightObserver& Observer = Observers[Candidate.Observer];
+        AActor* Target = Targets[Candidate.Target];
+        if (Pairs.FindChecked(FPairKey(Observer.Controller.Get(), Target)).bVisible)
+        {
+            Observer.SeenThisFrame.Add(Target);
+        }
+    }
+    for (FSightObserver& Observer : Observers)
+    {
+        bool bChanged = Observer.SeenThisFrame.Num() != Observer.Seen.Num();
+        for (int32 Index = 0; !bChanged && Index < Observer.Seen.Num(); ++Index)
+        {
+            bChanged = !Observer.SeenThisFrame.Contains(Observer.Seen[Index].Get());
+        }
+        if (!bChanged) continue;
+
+        Observer.Seen.Reset();
+        for (AActor* Target : Observer.SeenThisFrame)
+        {
+            Observer.Seen.Add(Target);
+        }
+        Observer.Controller->HandleSightUpdated(Observer.SeenThisFrame);
+    }
+}
+
+void USightSubsystem::GatherObserverPoses()
+{
+    const int32 Num = Observers.Num();
+    EyeX.SetNumUninitialized(Num, EAllowShrinking::No);
+    EyeY.SetNumUninitialized(Num, EAllowShrinking::No);
+    EyeZ.SetNumUninitialized(Num, EAllowShrinking::No);
+    DirX.SetNumUninitialized(Num, EAllowShrinking::No);
+    DirY.SetNumUninitialized(Num, EAllowShrinking::No);
+    DirZ.SetNumUninitialized(Num, EAllowShrinking::No);
+
+    for (TPair<FIntPoint, TArray<int32>>& Cell : Cells)
+    {
+        Cell.Value.Reset();
+    }
+
+    for (int32 Index = 0; Index < Num; ++Index)
+    {
+        const AAI_Character_Controller* Controller = Observers[Index].Controller.Get();
+        // Controllers without a pawn stay out of the hash and see nothing
+        if (!Controller->GetPawn()) continue;
+
+        FVector Location;
+        FRotator Rotation;
+        Controller->GetActorEyesViewPoint(Location, Rotation);
+        const FVector Direction = Rotation.Vector();
+
+        EyeX[Index] = Location.X; EyeY[Index] = Location.Y; EyeZ[Index] = Location.Z;
+        DirX[Index] = Direction.X; DirY[Index] = Direction.Y; DirZ[Index] = Direction.Z;
+
+        const FIntPoint CellCoord(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+        Cells.FindOrAdd(CellCoord).Add(Index);
+    }
+}
+
+void USightSubsystem::CullForTarget(int32 TargetIndex, const FVector& TargetLocation, double Now)
+{
+    AActor* Target = Targets[TargetIndex];
+    const FIntPoint TargetCell(FMath::FloorToInt(TargetLocation.X / CellSize), FMath::FloorToInt(TargetLocation.Y / CellSize));
+
+    Batch.Reset();
+    for (int32 DY = -1; DY <= 1; ++DY)
+    {
+        for (int32 DX = -1; DX <= 1; ++DX)
+        {
+            if (const TArray<int32>* Cell = Cells.Find(TargetCell + FIntPoint(DX, DY)))
+            {
+                for (const int32 Observer : *Cell)
+                {
+                    Batch.Add(Observer, *this);
+                }
+            }
+        }
+    }
+    if (Batch.Observers.Num() == 0) return;
+
+    Batch.Pass.SetNumUninitialized(Batch.Observers.Num(), EAllowShrinking::No);
+    Sight::CullBatch(Batch.EyeX.GetData(), Batch.EyeY.GetData(), Batch.EyeZ.GetData(),
+        Batch.DirX.GetData(), Batch.DirY.GetData(), Batch.DirZ.GetData(),
+        Batch.RadiusSq.GetData(), Batch.CosHalfAngle.GetData(), Batch.Observers.Num(),
+        FVector3f(TargetLocation), Batch.Pass.GetData());
+
+    for (int32 Index = 0; Index < Batch.Observers.Num(); ++Index)
+    {
+        if (!Batch.Pass[Index]) continue;
+
+        const int32 ObserverIndex = Batch.Observers[Index];
+        const FSightObserver& Observer = Observers[ObserverIndex];
+        AAI_Character_Controller* Controller = Observer.Controller.Get();
+        if (Controller->GetPawn() == Target) continue;
+
+        // Same affiliation filter as the perception sight config: friendlies only
+        if (Controller->GetTeamAttitudeTowards(*Target) != ETeamAttitude::Friendly) continue;
+
+        const FPairKey Key(Controller, Target);
+        FSightPair* Pair = Pairs.Find(Key);
+        if (!Pair || !Pair->bVisible)
+        {
+            const float DistSq = FVector::DistSquared(TargetLocation, FVector(Batch.EyeX[Index], Batch.EyeY[Index], Batch.EyeZ[Index]));
+            if (DistSq > Observer.SightRadiusSq) continue;
+        }
+        if (!Pair)
+        {
+            Pair = &Pairs.Add(Key);
+        }
+
+        const bool bDue = Now - Pair->LastTraceTime >= Observer.TraceInterval;
+        Candidates.Add({ ObserverIndex, TargetIndex, Pair->LastTraceTime, bDue });
+        CandidatePairs.Add(Key);
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "SightSubsystem.generated.h"
+
+class AAI_Character_Controller;
+
+// World-level sight for every AI controller, enabled with ai.Sight.Centralized.
+// Observers are bucketed in a 2D spatial hash each frame. For every target only the observers in
+// the neighbouring cells are tested, with distance and view cone culling done four at a time.
+// Surviving pairs are line traced, stalest first, up to ai.Sight.MaxTracesPerFrame per frame;
+// pairs that did not get a trace keep their last result.
+// Observers are told whenever the set of targets they see changes.
+UCLASS()
+class GOAP_AI_DEMO_API USightSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static USightSubsystem* Get(const UWorld* World);
+
+    // True when ai.Sight.Centralized is set; controllers then leave their perception sight sense off
+    static bool IsCentralizedSightEnabled();
+
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    virtual void Deinitialize() override;
+    virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+    // HalfAngleDegrees matches UAISenseConfig_Sight::PeripheralVisionAngleDegrees
+    void RegisterObserver(AAI_Character_Controller* Controller, float SightRadius, float LoseSightRadius, float HalfAngleDegrees);
+    void UnregisterObserver(AAI_Character_Controller* Controller);
+
+    // Minimum seconds between traces for Controller's pairs. Returns false if it is not an observer.
+    bool SetObserverTraceInterval(const AAI_Character_Controller* Controller, float Interval);
+
+    // Player pawns are always targets; other actors can be added here
+    void RegisterTarget(AActor* Target);
+    void UnregisterTarget(AActor* Target);
+
+    int32 GetNumObservers() const { return Observers.Num(); }
+    int32 GetNumTracesLastFrame() const { return NumTracesLastFrame; }
+
+private:
+    struct FSightObserver
+    {
+        TWeakObjectPtr<AAI_Character_Controller> Controller;
+        float SightRadiusSq = 0.f;
+        float LoseSightRadiusSq = 0.f;
+        float CosHalfAngle = 0.f;
+        float TraceInterval = 0.f;
+
+        // Targets currently seen, and those found visible this frame
+        TArray<TWeakObjectPtr<AActor>> Seen;
+        TArray<AActor*> SeenThisFrame;
+    };
+
+    struct FSightPair
+    {
+        bool bVisible = false;
+        double LastTraceTime = -UE_BIG_NUMBER;
+    };
+
+    struct FTraceCandidate
+    {
+        int32 Observer;
+        int32 Target;
+        double LastTraceTime;
+
+        // The observer's trace interval has passed since the last trace
+        bool bDue;
+    };
+
+    // Observers near one target, gathered contiguously for the vectorized cull
+    struct FCullBatch
+    {
+        TArray<int32> Observers;
+        TArray<float> EyeX, EyeY, EyeZ;
+        TArray<float> DirX, DirY, DirZ;
+        TArray<float> RadiusSq, CosHalfAngle;
+        TArray<uint8> Pass;
+
+        void Reset();
+        void Add(int32 Observer, const USightSubsystem& Owner);
+    };
+
+    using FPairKey = TPair<TObjectKey<AAI_Character_Controller>, TObjectKey<AActor>>;
+
+    // Eye pose of every observer and the observer spatial hash, rebuilt each frame
+    void GatherObserverPoses();
+
+    // Distance and cone tests for one target against the observers near it
+    void CullForTarget(int32 TargetIndex, const FVector& TargetLocation, double Now);
+
+    TArray<FSightObserver> Observers;
+    TArray<TWeakObjectPtr<AActor>> ExtraTargets;
+    TMap<FPairKey, FSightPair> Pairs;
+    float CellSize = 1.f;
+
+    // Per-frame scratch
+    TArray<AActor*> Targets;
+    TArray<float> EyeX, EyeY, EyeZ;
+    TArray<float> DirX, DirY, DirZ;
+    TMap<FIntPoint, TArray<int32>> Cells;
+    FCullBatch Batch;
+    TArray<FTraceCandidate> Candidates;
+    TSet<FPairKey> CandidatePairs;
+    int32 NumTracesLastFrame = 0;
+};
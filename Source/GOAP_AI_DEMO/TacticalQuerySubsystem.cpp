@@ -0,0 +1,503 @@
+#include "TacticalQuerySubsystem.h"
+#include "NodeGraphSubsystem.h"
+#include "NodeVisibilityData.h"
+#include "NodeFilterPolicies.h"
+#include "UNavFilter.h"
+#include "UPlayerLOSFilter.h"
+#include "Node.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/VectorRegister.h"
+#include "Algo/BinarySearch.h"
+
+static TAutoConsoleVariable<float> CVarTacticalQueryBudgetMs(
+    TEXT("ai.TacticalQuery.BudgetMs"),
+    1.0f,
+    TEXT("Time per frame, in milliseconds, shared by all pending tactical queries."));
+
+namespace TacticalQuery
+{
+    // How close the target must be to a baked node for the PVS to stand in for its viewpoint
+    constexpr float PVSViewRadius = 200.f;
+
+    // Candidates handed to a UUPlayerLOSFilter per batch
+    constexpr int32 FilterBatchSize = 32;
+
+    // Distances from Ref for Num points stored as SoA, four lanes at a time
+    static void ComputeDistances(const float* X, const float* Y, const float* Z, int32 Num, const FVector3f& Ref, float* OutDistances)
+    {
+        const VectorRegister4Float RefX = VectorSetFloat1(Ref.X);
+        const VectorRegister4Float RefY = VectorSetFloat1(Ref.Y);
+        const VectorRegister4Float RefZ = VectorSetFloat1(Ref.Z);
+
+        int32 Index = 0;
+        for (; Index + 4 <= Num; Index += 4)
+        {
+            const VectorRegister4Float DX = VectorSubtract(VectorLoad(X + Index), RefX);
+            const VectorRegister4Float DY = VectorSubtract(VectorLoad(Y + Index), RefY);
+            const VectorRegister4Float DZ = VectorSubtract(VectorLoad(Z + Index), RefZ);
+            const VectorRegister4Float DistSq = VectorMultiplyAdd(DX, DX, VectorMultiplyAdd(DY, DY, VectorMultiply(DZ, DZ)));
+            VectorStore(VectorSqrt(DistSq), OutDistances + Index);
+        }
+        for (; Index < Num; ++Index)
+        {
+            OutDistances[Index] = FMath::Sqrt(FMath::Square(X[Index] - Ref.X) + FMath::Square(Y[Index] - Ref.Y) + FMath::Square(Z[Index] - Ref.Z));
+        }
+    }
+
+    static bool IsTypeAllowed(int32 Mask, uint8 Type)
+    {
+        return (Mask & (1 << Type)) != 0;
+    }
+}
+
+UTacticalQuerySubsystem* UTacticalQuerySubsystem::Get(const UWorld* World)
+{
+    return World ? World->GetSubsystem<UTacticalQuerySubsystem>() : nullptr;
+}
+
+int32 UTacticalQuerySubsystem::RunQuery(const FTacticalQueryRequest& Request, FOnTacticalQueryFinished OnFinished)
+{
+    FRunningQuery& Query = Queries.AddDefaulted_GetRef();
+    Query.Id = NextQueryId++;
+    Query.Request = Request;
+    Query.OnFinished = MoveTemp(OnFinished);
+
+    // The queue is not visible to GC; keep weak references and drop the raw ones
+    Query.Filter = Request.Filter;
+    Query.TargetActor = Request.TargetActor;
+    Query.Request.Filter = nullptr;
+    Query.Request.TargetActor = nullptr;
+
+    return Query.Id;
+}
+
+void UTacticalQuerySubsystem::AbortQuery(int32 QueryId)
+{
+    Queries.RemoveAll([QueryId](const FRunningQuery& Query) { return Query.Id == QueryId; });
+}
+
+void UTacticalQuerySubsystem::Deinitialize()
+{
+    Queries.Empty();
+    Super::Deinitialize();
+}
+
+TStatId UTacticalQuerySubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UTacticalQuerySubsystem, STATGROUP_Tickables);
+}
+
+void UTacticalQuerySubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    if (Queries.Num() == 0) return;
+
+    UNodeGraphSubsystem* GraphSubsystem = UNodeGraphSubsystem::Get(GetWorld());
+    if (!GraphSubsystem) return;
+
+    const FNodeGraph& Graph = GraphSubsystem->GetGraph();
+    const uint32 GraphVersion = GraphSubsystem->GetGraphVersion();
+    const double EndTime = FPlatformTime::Seconds() + CVarTacticalQueryBudgetMs.GetValueOnGameThread() / 1000.0;
+
+    // Round-robin: each pass gives every unfinished query one step until the budget runs out
+    bool bBudgetLeft = true;
+    bool bAnyWork = true;
+    while (bAnyWork && bBudgetLeft)
+    {
+        bAnyWork = false;
+        for (int32 Offset = 0; Offset < Queries.Num() && bBudgetLeft; ++Offset)
+        {
+            FRunningQuery& Query = Queries[(RoundRobinStart + Offset) % Queries.Num()];
+            if (Query.Stage == EStage::Done) continue;
+
+            if (Query.Stage == EStage::Generate)
+            {
+                Query.GraphVersion = GraphVersion;
+            }
+            else if (Query.GraphVersion != GraphVersion)
+            {
+                // The graph was recompiled mid-query; candidate indices are meaningless now
+                Query.Result = FTacticalQueryResult();
+                Query.Stage = EStage::Done;
+                continue;
+            }
+
+            StepQuery(Query, Graph);
+            bAnyWork = true;
+            bBudgetLeft = FPlatformTime::Seconds() < EndTime;
+        }
+    }
+    RoundRobinStart = Queries.Num() > 0 ? (RoundRobinStart + 1) % Queries.Num() : 0;
+
+    // Detach finished queries first; delegates may queue new ones
+    TArray<FRunningQuery> Finished;
+    for (int32 Index = 0; Index < Queries.Num(); )
+    {
+        if (Queries[Index].Stage == EStage::Done)
+        {
+            Finished.Add(MoveTemp(Queries[Index]));
+            Queries.RemoveAt(Index, EAllowShrinking::No);
+        }
+        else
+        {
+            ++Index;
+        }
+    }
+
+    for (FRunningQuery& Query : Finished)
+    {
+        Query.OnFinished.ExecuteIfBound(Query.Result);
+    }
+}
+
+void UTacticalQuerySubsystem::StepQuery(FRunningQuery& Query, const FNodeGraph& Graph)
+{
+    switch (Query.Stage)
+    {
+    case EStage::Generate:
+        Generate(Query, Graph);
+        break;
+    case EStage::CheapTests:
+        RunCheapTests(Query);
+        break;
+    case EStage::PathTests:
+        RunPathTests(Query, Graph);
+        break;
+    case EStage::Sort:
+        SortCandidates(Query);
+        break;
+    case EStage::ExpensiveTests:
+        RunExpensiveTests(Query, Graph);
+        break;
+    default:
+        break;
+    }
+
+    // Nothing left to rank
+    if (Query.Stage != EStage::Done && Query.Stage != EStage::ExpensiveTests && Query.Candidates.Num() == 0)
+    {
+        Finish(Query, Graph);
+    }
+}
+
+void UTacticalQuerySubsystem::Generate(FRunningQuery& Query, const FNodeGraph& Graph)
+{
+    const FTacticalQueryRequest& Request = Query.Request;
+    TConstArrayView<float> PosX = Graph.GetPositionsX();
+    TConstArrayView<float> PosY = Graph.GetPositionsY();
+    TConstArrayView<float> PosZ = Graph.GetPositionsZ();
+    TConstArrayView<uint8> Types = Graph.GetTypes();
+
+    auto AddCandidate = [&Query, &PosX, &PosY, &PosZ](int32 Node)
+    {
+        Query.Candidates.Add(Node);
+        Query.CandX.Add(PosX[Node]);
+        Query.CandY.Add(PosY[Node]);
+        Query.CandZ.Add(PosZ[Node]);
+    };
+
+    Query.QuerierNode = Graph.FindNearestNode(Request.QuerierLocation);
+
+    if (Request.Generator == ETacticalGenerator::Radius)
+    {
+        TArray<float> Distances;
+        Distances.SetNumUninitialized(Graph.NumNodes());
+        TacticalQuery::ComputeDistances(PosX.GetData(), PosY.GetData(), PosZ.GetData(), Graph.NumNodes(), FVector3f(Request.QuerierLocation), Distances.GetData());
+
+        for (int32 Node = 0; Node < Graph.NumNodes(); ++Node)
+        {
+            if (Distances[Node] <= Request.Radius && TacticalQuery::IsTypeAllowed(Request.NodeTypeMask, Types[Node]))
+            {
+                AddCandidate(Node);
+            }
+        }
+    }
+    else if (Query.QuerierNode != INDEX_NONE)
+    {
+        // The search also gives the path test its costs for free
+        TArray<int32> Reached;
+        Graph.Dijkstra(Query.QuerierNode, Request.MaxGraphCost, FConnectionMaskPolicy(Request.ConnectionMask), Query.GraphCosts, &Reached);
+
+        for (int32 Node : Reached)
+        {
+            if (TacticalQuery::IsTypeAllowed(Request.NodeTypeMask, Types[Node]))
+            {
+                AddCandidate(Node);
+            }
+        }
+    }
+
+    Query.Scores.SetNumZeroed(Query.Candidates.Num());
+    Query.Stage = EStage::CheapTests;
+}
+
+void UTacticalQuerySubsystem::RunCheapTests(FRunningQuery& Query)
+{
+    const FTacticalQueryRequest& Request = Query.Request;
+
+    TArray<float> Values;
+    for (const FTacticalQueryTest& Test : Request.Tests)
+    {
+        if (Test.Type != ETacticalTestType::DistanceToQuerier && Test.Type != ETacticalTestType::DistanceToTarget)
+            continue;
+
+        const FVector3f Ref(Test.Type == ETacticalTestType::DistanceToQuerier ? Request.QuerierLocation : Request.TargetLocation);
+        Values.SetNumUninitialized(Query.Candidates.Num(), EAllowShrinking::No);
+        TacticalQuery::ComputeDistances(Query.CandX.GetData(), Query.CandY.GetData(), Query.CandZ.GetData(), Query.Candidates.Num(), Ref, Values.GetData());
+
+        ApplyTestValues(Query, Test, Values);
+    }
+
+    Query.Stage = EStage::PathTests;
+}
+
+void UTacticalQuerySubsystem::RunPathTests(FRunningQuery& Query, const FNodeGraph& Graph)
+{
+    const FTacticalQueryRequest& Request = Query.Request;
+    const bool bHasPathTest = Request.Tests.ContainsByPredicate([](const FTacticalQueryTest& Test) { return Test.Type == ETacticalTestType::PathLength; });
+    if (!bHasPathTest)
+    {
+        Query.Stage = EStage::Sort;
+        return;
+    }
+
+    // One single-source search covers every candidate
+    if (Query.GraphCosts.Num() == 0)
+    {
+        Graph.Dijkstra(Query.QuerierNode, UE_MAX_FLT, FConnectionMaskPolicy(Request.ConnectionMask), Query.GraphCosts);
+    }
+
+    TArray<float> Values;
+    auto GatherCosts = [&Query, &Values]()
+    {
+        Values.SetNumUninitialized(Query.Candidates.Num(), EAllowShrinking::No);
+        for (int32 Index = 0; Index < Query.Candidates.Num(); ++Index)
+        {
+            Values[Index] = Query.GraphCosts[Query.Candidates[Index]];
+        }
+    };
+
+    // Unreachable candidates can never be used, whatever the test says
+    FTacticalQueryTest Reachable;
+    Reachable.bFilter = true;
+    Reachable.FilterMax = UE_BIG_NUMBER;
+    GatherCosts();
+    ApplyTestValues(Query, Reachable, Values);
+
+    for (const FTacticalQueryTest& Test : Request.Tests)
+    {
+        if (Test.Type == ETacticalTestType::PathLength)
+        {
+            GatherCosts();
+            ApplyTestValues(Query, Test, Values);
+        }
+    }
+
+    Query.Stage = EStage::Sort;
+}
+
+void UTacticalQuerySubsystem::SortCandidates(FRunningQuery& Query)
+{
+    const FTacticalQueryRequest& Request = Query.Request;
+
+    // Best cheap score first, so the expensive stage can stop early
+    TArray<int32> Order;
+    Order.Reserve(Query.Candidates.Num());
+    for (int32 Index = 0; Index < Query.Candidates.Num(); ++Index)
+    {
+        Order.Add(Index);
+    }
+    Order.Sort([&Query](int32 A, int32 B) { return Query.Scores[A] > Query.Scores[B]; });
+
+    TArray<int32> SortedCandidates;
+    TArray<float> SortedScores;
+    SortedCandidates.Reserve(Order.Num());
+    SortedScores.Reserve(Order.Num());
+    for (int32 Index : Order)
+    {
+        SortedCandidates.Add(Query.Candidates[Index]);
+        SortedScores.Add(Query.Scores[Index]);
+    }
+    Query.Candidates = MoveTemp(SortedCandidates);
+    Query.Scores = MoveTemp(SortedScores);
+    Query.CandX.Empty();
+    Query.CandY.Empty();
+    Query.CandZ.Empty();
+
+    // Most the remaining tests can still add to a candidate's score
+    Query.ExpensiveUpperBound = 0.f;
+    for (const FTacticalQueryTest& Test : Request.Tests)
+    {
+        if (Test.Type == ETacticalTestType::VisibleFromTarget)
+        {
+            Query.ExpensiveUpperBound += FMath::Max(Test.ScoreWeight, 0.f);
+        }
+    }
+
+    ANodeVisibilityData* VisibilityData = ANodeVisibilityData::Get(GetWorld());
+    if (VisibilityData && VisibilityData->IsBaked())
+    {
+        Query.VisibilityData = VisibilityData;
+        Query.TargetPVSNode = VisibilityData->FindViewpointIndex(Request.TargetLocation, TacticalQuery::PVSViewRadius);
+    }
+
+    Query.Cursor = 0;
+    Query.Stage = EStage::ExpensiveTests;
+}
+
+void UTacticalQuerySubsystem::RunExpensiveTests(FRunningQuery& Query, const FNodeGraph& Graph)
+{
+    const FTacticalQueryRequest& Request = Query.Request;
+    const int32 MaxResults = FMath::Max(Request.MaxResults, 1);
+
+    if (Query.Cursor >= Query.Candidates.Num())
+    {
+        Finish(Query, Graph);
+        return;
+    }
+
+    // Candidates are sorted, so once the best possible remaining score cannot make the list, nothing after it can
+    if (Query.Best.Num() >= MaxResults && Query.Scores[Query.Cursor] + Query.ExpensiveUpperBound <= Query.Best.Last().Key)
+    {
+        Finish(Query, Graph);
+        return;
+    }
+
+    UUNavFilter* Filter = Query.Filter.Get();
+
+    // Hand the LOS filter a batch ahead of the cursor so its checks below are cache lookups
+    if (Query.Cursor % TacticalQuery::FilterBatchSize == 0)
+    {
+        if (const UUPlayerLOSFilter* LOSFilter = Cast<UUPlayerLOSFilter>(Filter))
+        {
+            TArray<ANode*> Batch;
+            const int32 BatchEnd = FMath::Min(Query.Cursor + TacticalQuery::FilterBatchSize, Query.Candidates.Num());
+            for (int32 Index = Query.Cursor; Index < BatchEnd; ++Index)
+            {
+                Batch.Add(Graph.GetNode(Query.Candidates[Index]));
+            }
+            LOSFilter->EvaluateNodesLOS(Batch);
+        }
+    }
+
+    const int32 Node = Query.Candidates[Query.Cursor];
+    float Score = Query.Scores[Query.Cursor];
+    ++Query.Cursor;
+
+    for (const FTacticalQueryTest& Test : Request.Tests)
+    {
+        if (Test.Type != ETacticalTestType::VisibleFromTarget)
+            continue;
+
+        const float Value = IsVisibleFromTarget(Query, Graph, Node) ? 1.f : 0.f;
+        if (Test.bFilter && (Value < Test.FilterMin || Value > Test.FilterMax))
+            return;
+
+        Score += Value * Test.ScoreWeight;
+    }
+
+    if (Filter && !Filter->IsNodeValid(Graph.GetNode(Node)))
+        return;
+
+    // Keep Best sorted, highest score first
+    const int32 InsertAt = Algo::LowerBoundBy(Query.Best, -Score, [](const TPair<float, int32>& Entry) { return -Entry.Key; });
+    Query.Best.Insert(TPair<float, int32>(Score, Node), InsertAt);
+    if (Query.Best.Num() > MaxResults)
+    {
+        Query.Best.Pop(EAllowShrinking::No);
+    }
+}
+
+void UTacticalQuerySubsystem::Finish(FRunningQuery& Query, const FNodeGraph& Graph)
+{
+    for (const TPair<float, int32>& Entry : Query.Best)
+    {
+        if (ANode* Node = Graph.GetNode(Entry.Value))
+        {
+            Query.Result.Nodes.Add(Node);
+            Query.Result.Scores.Add(Entry.Key);
+        }
+    }
+    Query.Result.bSuccess = Query.Result.Nodes.Num() > 0;
+
+    Query.Candidates.Empty();
+    Query.Scores.Empty();
+    Query.GraphCosts.Empty();
+    Query.Best.Empty();
+    Query.Stage = EStage::Done;
+}
+
+void UTacticalQuerySubsystem::ApplyTestValues(FRunningQuery& Query, const FTacticalQueryTest& Test, TArray<float>& Values)
+{
+    const bool bHasPositions = Query.CandX.Num() == Query.Candidates.Num();
+
+    if (Test.bFilter)
+    {
+        int32 Write = 0;
+        for (int32 Read = 0; Read < Query.Candidates.Num(); ++Read)
+        {
+            if (Values[Read] < Test.FilterMin || Values[Read] > Test.FilterMax)
+                continue;
+
+            Query.Candidates[Write] = Query.Candidates[Read];
+            Query.Scores[Write] = Query.Scores[Read];
+            Values[Write] = Values[Read];
+            if (bHasPositions)
+            {
+                Query.CandX[Write] = Query.CandX[Read];
+                Query.CandY[Write] = Query.CandY[Read];
+                Query.CandZ[Write] = Query.CandZ[Read];
+            }
+            ++Write;
+        }
+
+        Query.Candidates.SetNum(Write, EAllowShrinking::No);
+        Query.Scores.SetNum(Write, EAllowShrinking::No);
+        Values.SetNum(Write, EAllowShrinking::No);
+        if (bHasPositions)
+        {
+            Query.CandX.SetNum(Write, EAllowShrinking::No);
+            Query.CandY.SetNum(Write, EAllowShrinking::No);
+            Query.CandZ.SetNum(Write, EAllowShrinking::No);
+        }
+    }
+
+    if (Test.ScoreWeight != 0.f)
+    {
+        float MaxValue = 0.f;
+        for (float Value : Values)
+        {
+            MaxValue = FMath::Max(MaxValue, Value);
+        }
+
+        if (MaxValue > 0.f)
+        {
+            const float Scale = Test.ScoreWeight / MaxValue;
+            for (int32 Index = 0; Index < Values.Num(); ++Index)
+            {
+                Query.Scores[Index] += Values[Index] * Scale;
+            }
+        }
+    }
+}
+
+bool UTacticalQuerySubsystem::IsVisibleFromTarget(const FRunningQuery& Query, const FNodeGraph& Graph, int32 Node) const
+{
+    const FTacticalQueryRequest& Request = Query.Request;
+
+    // A traced, cleared PVS bit means static geometry hides the node; no trace needed
+    if (const ANodeVisibilityData* VisibilityData = Query.VisibilityData.Get())
+    {
+        const int32 PVSIndex = VisibilityData->GetNodeIndex(Graph.GetNode(Node));
+        if (Query.TargetPVSNode != INDEX_NONE && PVSIndex != INDEX_NONE && VisibilityData->AreIndicesOccluded(Query.TargetPVSNode, PVSIndex))
+        {
+            return false;
+        }
+    }
+
+    const FVector NodeEye = Graph.GetLocation(Node) + FVector(0, 0, Request.NodeEyeHeight);
+    FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(TacticalQueryLOS), true, Query.TargetActor.Get());
+    return !GetWorld()->LineTraceTestByChannel(Request.TargetLocation, NodeEye, ECC_Visibility, TraceParams);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TacticalQueryTypes.h"
+#include "TacticalQuerySubsystem.generated.h"
+
+class ANodeVisibilityData;
+struct FNodeGraph;
+
+// Runs tactical position queries (cover, flank, ...) over the compiled node graph.
+// Queries are queued and advanced from Tick under a shared per-frame time budget, so many
+// agents can ask in the same frame without a spike. Results arrive through the query's delegate.
+UCLASS()
+class GOAP_AI_DEMO_API UTacticalQuerySubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static UTacticalQuerySubsystem* Get(const UWorld* World);
+
+    // Queues a query. OnFinished fires on the game thread from a later Tick. Returns a handle for AbortQuery.
+    int32 RunQuery(const FTacticalQueryRequest& Request, FOnTacticalQueryFinished OnFinished);
+
+    // Drops a queued query without calling its delegate
+    void AbortQuery(int32 QueryId);
+
+    int32 GetNumPendingQueries() const { return Queries.Num(); }
+
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    virtual void Deinitialize() override;
+
+private:
+    enum class EStage : uint8
+    {
+        Generate,
+        CheapTests,
+        PathTests,
+        Sort,
+        ExpensiveTests,
+        Done
+    };
+
+    struct FRunningQuery
+    {
+        int32 Id = INDEX_NONE;
+        FTacticalQueryRequest Request;
+        TWeakObjectPtr<UUNavFilter> Filter;
+        TWeakObjectPtr<AActor> TargetActor;
+        FOnTacticalQueryFinished OnFinished;
+        EStage Stage = EStage::Generate;
+        uint32 GraphVersion = 0;
+        int32 QuerierNode = INDEX_NONE;
+
+        // Surviving candidates; all arrays stay parallel
+        TArray<int32> Candidates;
+        TArray<float> CandX;
+        TArray<float> CandY;
+        TArray<float> CandZ;
+        TArray<float> Scores;
+
+        // Graph cost from QuerierNode per graph node, filled by the graph generator or the path test
+        TArray<float> GraphCosts;
+
+        // Expensive stage state
+        TWeakObjectPtr<ANodeVisibilityData> VisibilityData;
+        int32 TargetPVSNode = INDEX_NONE;
+        float ExpensiveUpperBound = 0.f;
+        int32 Cursor = 0;
+        TArray<TPair<float, int32>> Best;
+
+        FTacticalQueryResult Result;
+    };
+
+    // Advances one query by one stage, or by one candidate in the expensive stage
+    void StepQuery(FRunningQuery& Query, const FNodeGraph& Graph);
+
+    void Generate(FRunningQuery& Query, const FNodeGraph& Graph);
+    void RunCheapTests(FRunningQuery& Query);
+    void RunPathTests(FRunningQuery& Query, const FNodeGraph& Graph);
+    void SortCandidates(FRunningQuery& Query);
+    void RunExpensiveTests(FRunningQuery& Query, const FNodeGraph& Graph);
+    void Finish(FRunningQuery& Query, const FNodeGraph& Graph);
+
+    // Filters and scores the current candidates with one value per candidate, compacting the arrays
+    static void ApplyTestValues(FRunningQuery& Query, const FTacticalQueryTest& Test, TArray<float>& Values);
+
+    // Evaluates VisibleFromTarget for one candidate
+    bool IsVisibleFromTarget(const FRunningQuery& Query, const FNodeGraph& Graph, int32 Node) const;
+
+    TArray<FRunningQuery> Queries;
+    int32 NextQueryId = 0;
+
+    // Index of the query that gets the budget first next frame, so no query starves
+    int32 RoundRobinStart = 0;
+};
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NodeTypes.h"
+#include "TacticalQueryTypes.generated.h"
+
+class AActor;
+class ANode;
+class UUNavFilter;
+
+// How the candidate nodes of a tactical query are produced
+UENUM(BlueprintType)
+enum class ETacticalGenerator : uint8
+{
+    Radius          UMETA(DisplayName = "Radius"),          // Every node within Radius of the querier
+    GraphDistance   UMETA(DisplayName = "Graph Distance")   // Every node reachable from the querier within MaxGraphCost
+};
+
+// What a tactical test measures. Cheap tests run first over all candidates, expensive ones last per candidate.
+UENUM(BlueprintType)
+enum class ETacticalTestType : uint8
+{
+    DistanceToQuerier   UMETA(DisplayName = "Distance To Querier"),    // Cheap: straight-line distance
+    DistanceToTarget    UMETA(DisplayName = "Distance To Target"),     // Cheap: straight-line distance
+    PathLength          UMETA(DisplayName = "Path Length"),            // One graph search per query, then a lookup
+    VisibleFromTarget   UMETA(DisplayName = "Visible From Target")     // Expensive: PVS bit test, then a trace. Value is 1 when visible, 0 when hidden
+};
+
+USTRUCT(BlueprintType)
+struct FTacticalQueryTest
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tactical")
+    ETacticalTestType Type = ETacticalTestType::DistanceToQuerier;
+
+    // Drop candidates whose value falls outside [FilterMin, FilterMax]
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tactical")
+    bool bFilter = false;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tactical", meta = (EditCondition = "bFilter"))
+    float FilterMin = 0.f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tactical", meta = (EditCondition = "bFilter"))
+    float FilterMax = 1000000.f;
+
+    // The value is normalized to [0, 1] and multiplied by this; negative weights prefer small values
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tactical")
+    float ScoreWeight = 0.f;
+};
+
+USTRUCT(BlueprintType)
+struct FTacticalQueryRequest
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tactical")
+    FVector QuerierLocation = FVector::ZeroVector;
+
+    // Usually the enemy the querier wants cover from or wants to flank
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tactical")
+    FVector TargetLocation = FVector::ZeroVector;
+
+    // Ignored by VisibleFromTarget traces
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tactical")
+    AActor* TargetActor = nullptr;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tactical")
+    ETacticalGenerator Generator = ETacticalGenerator::Radius;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tactical")
+    float Radius = 2000.f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tactical")
+    float MaxGraphCost = 3000.f;
+
+    // Bit N set = nodes of ENodeType N are candidates
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tactical", meta = (Bitmask, BitmaskEnum = "/Script/GOAP_AI_DEMO.ENodeType"))
+    int32 NodeTypeMask = 0xFF;
+
+    // Querier capabilities: bit N set = links of ENodeConnectionType N can be used by graph searches
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tactical", meta = (Bitmask, BitmaskEnum = "/Script/GOAP_AI_DEMO.ENodeConnectionType"))
+    int32 ConnectionMask = 0xFF;
+
+    // Height above a candidate node that visibility traces aim at
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tactical")
+    float NodeEyeHeight = 100.f;
+
+    // Tests in any order; the engine runs cheap ones first
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tactical")
+    TArray<FTacticalQueryTest> Tests;
+
+    // Optional per-node filter, run after every other test on the surviving candidates
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tactical")
+    UUNavFilter* Filter = nullptr;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tactical", meta = (ClampMin = "1"))
+    int32 MaxResults = 1;
+
+    // Restricts candidates to the given node types
+    void SetNodeTypes(std::initializer_list<ENodeType> InTypes)
+    {
+        NodeTypeMask = 0;
+        for (ENodeType Type : InTypes)
+        {
+            NodeTypeMask |= 1 << (int32)Type;
+        }
+    }
+
+    // Restricts graph searches to the given link types
+    void SetConnectionTypes(std::initializer_list<ENodeConnectionType> InTypes)
+    {
+        ConnectionMask = 0;
+        for (ENodeConnectionType Type : InTypes)
+        {
+            ConnectionMask |= 1 << (int32)Type;
+        }
+    }
+};
+
+USTRUCT(BlueprintType)
+struct FTacticalQueryResult
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "Tactical")
+    bool bSuccess = false;
+
+    // Best node first
+    UPROPERTY(BlueprintReadOnly, Category = "Tactical")
+    TArray<ANode*> Nodes;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Tactical")
+    TArray<float> Scores;
+
+    ANode* GetBest() const { return Nodes.Num() > 0 ? Nodes[0] : nullptr; }
+};
+
+DECLARE_DELEGATE_OneParam(FOnTacticalQueryFinished, const FTacticalQueryResult&);
@@ -13,6 +13,9 @@
  *
  * UUNavFilter is a UObject-derived class that provides a method to check if a given node
  * is valid for navigation purposes. Extend this class to implement custom filtering logic.
+ *
+ * Searches over the compiled FNodeGraph use the inlined policies in NodeFilterPolicies.h;
+ * a UUNavFilter can still be plugged into them through FUObjectFilterPolicy.
  */
 UCLASS()
 class GOAP_AI_DEMO_API UUNavFilter : public UObject
@@ -6,7 +6,10 @@
 #include "GameFramework/Character.h"
 #include "Camera/CameraComponent.h"
 #include "Engine/World.h"
+#include "Async/ParallelFor.h"
 #include "Node.h"
+#include "NodeVisibilityData.h"
+#include "NodeGraph.h"
 
 /**
  * @brief Overrides the IsNodeValid function from UNavFilter to use LOS filtering.
@@ -24,14 +27,11 @@ bool UUPlayerLOSFilter::IsNodeValid(ANode* Node) const
 /**
  * @brief Checks if the given node is in the line of sight (LOS) of any player.
  *
- * This function iterates over all player controllers in the world, retrieves their camera location and forward vector,
- * and performs two tests for each player:
- * 1. Dot Product: Checks if the node is in front of the player's camera.
- * 2. Line Trace: Checks if there is a clear line of sight from the camera to a point slightly above the node.
- *    The trace must not hit any object to be considered valid (since nodes have no collision).
+ * The result is looked up in the per-frame cache first. On a miss the node is traced against the
+ * player camera poses captured for this frame and the result is cached.
  *
  * @param Node Pointer to the node to check.
- * @return true if the node is in LOS of any player, false otherwise.
+ * @return true if the node is in LOS of a player, false otherwise.
  */
 bool UUPlayerLOSFilter::IsNodeInPlayerLOS(ANode* Node) const
 {
@@ -42,8 +42,100 @@ bool UUPlayerLOSFilter::IsNodeInPlayerLOS(ANode* Node) const
 	if (!World)
 		return false;
 
-	const FVector NodeLocation = Node->GetActorLocation();
-	const FVector NodeTarget = NodeLocation + FVector(0, 0, 0.1f); // Slightly above the node
+	PrepareFrame(World);
+
+	if (const bool* Cached = LOSCache.Find(Node))
+	{
+		return *Cached;
+	}
+
+	const int32 PVSIndex = VisibilityData ? VisibilityData->GetNodeIndex(Node) : INDEX_NONE;
+	const bool bInLOS = TraceNodeLOS(World, Node->GetActorLocation(), PVSIndex);
+	LOSCache.Add(Node, bInLOS);
+	return bInLOS;
+}
+
+/**
+ * @brief Evaluates player LOS for a batch of nodes and stores the results in the per-frame cache.
+ *
+ * Nodes that are not cached yet are collected on the game thread, then traced in parallel on
+ * task graph worker threads. Scene queries only read the physics scene, and the game thread
+ * waits for the batch, so nothing mutates the scene while the traces run.
+ *
+ * @param Nodes Nodes to evaluate.
+ */
+void UUPlayerLOSFilter::EvaluateNodesLOS(const TArray<ANode*>& Nodes) const
+{
+	UWorld* World = nullptr;
+	for (ANode* Node : Nodes)
+	{
+		if (Node && Node->GetWorld())
+		{
+			World = Node->GetWorld();
+			break;
+		}
+	}
+
+	if (!World)
+		return;
+
+	PrepareFrame(World);
+
+	// Gather the nodes that still need a trace this frame
+	TArray<ANode*> Pending;
+	TArray<FVector> PendingLocations;
+	TArray<int32> PendingPVSIndices;
+	Pending.Reserve(Nodes.Num());
+	PendingLocations.Reserve(Nodes.Num());
+	PendingPVSIndices.Reserve(Nodes.Num());
+	for (ANode* Node : Nodes)
+	{
+		if (Node && Node->GetWorld() == World && !LOSCache.Contains(Node))
+		{
+			LOSCache.Add(Node, false); // Reserve the slot so duplicates in Nodes are only traced once
+			Pending.Add(Node);
+			PendingLocations.Add(Node->GetActorLocation());
+			PendingPVSIndices.Add(VisibilityData ? VisibilityData->GetNodeIndex(Node) : INDEX_NONE);
+		}
+	}
+
+	if (Pending.Num() == 0)
+		return;
+
+	// Traces are independent; each worker writes only its own result slot
+	TArray<bool> Results;
+	Results.SetNumZeroed(Pending.Num());
+	ParallelFor(Pending.Num(), [this, World, &PendingLocations, &PendingPVSIndices, &Results](int32 Index)
+	{
+		Results[Index] = TraceNodeLOS(World, PendingLocations[Index], PendingPVSIndices[Index]);
+	});
+
+	for (int32 Index = 0; Index < Pending.Num(); ++Index)
+	{
+		LOSCache.Add(Pending[Index], Results[Index]);
+	}
+}
+
+/**
+ * @brief Captures the camera pose of every player once per frame.
+ *
+ * When the frame or world changes, the pose list is rebuilt and the LOS cache is cleared.
+ * The camera component lookup and the baked visibility lookup only happen here, not once per node.
+ *
+ * @param World World whose player controllers are queried.
+ */
+void UUPlayerLOSFilter::PrepareFrame(UWorld* World) const
+{
+	if (CacheFrame == GFrameCounter && CacheWorld.Get() == World)
+		return;
+
+	CacheFrame = GFrameCounter;
+	CacheWorld = World;
+	LOSCache.Reset();
+	ViewPoses.Reset();
+
+	const ANodeVisibilityData* BakedData = ANodeVisibilityData::Get(World);
+	VisibilityData = (BakedData && BakedData->IsBaked()) ? BakedData : nullptr;
 
 	// Iterate over all player controllers
 	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
@@ -56,27 +148,58 @@ bool UUPlayerLOSFilter::IsNodeInPlayerLOS(ANode* Node) const
 		if (!Pawn)
 			continue;
 
-		// Try to get the camera component from the pawn
-		FVector CameraLocation;
-		FVector CameraForward;
+		FPlayerViewPose& Pose = ViewPoses.AddDefaulted_GetRef();
+		Pose.Pawn = Pawn;
 
 		// If the pawn has a camera component, use it
 		UCameraComponent* CameraComp = Pawn->FindComponentByClass<UCameraComponent>();
 		if (CameraComp)
 		{
-			CameraLocation = CameraComp->GetComponentLocation();
-			CameraForward = CameraComp->GetForwardVector();
+			Pose.Location = CameraComp->GetComponentLocation();
+			Pose.Forward = CameraComp->GetForwardVector();
 		}
 		else
 		{
 			// Fallback: use pawn's location and forward vector
-			CameraLocation = Pawn->GetActorLocation();
-			CameraForward = Pawn->GetActorForwardVector();
+			Pose.Location = Pawn->GetActorLocation();
+			Pose.Forward = Pawn->GetActorForwardVector();
 		}
 
+		Pose.PVSNode = VisibilityData ? VisibilityData->FindViewpointIndex(Pose.Location, PVSViewRadius) : INDEX_NONE;
+	}
+}
+
+/**
+ * @brief Tests one node location against the cached player camera poses.
+ *
+ * For each pose up to three tests are performed:
+ * 0. PVS: If both the pose and the node are in the baked visibility matrix and the pair was traced within
+ *    MaxRange, a cleared bit means static geometry hides the node, so the trace is skipped.
+ *    Untraced pairs are unknown and fall through to the trace.
+ * 1. Dot Product: Checks if the node is in front of the player's camera.
+ * 2. Line Trace: Checks if there is a clear line of sight from the camera to a point slightly above the node.
+ *    The trace must not hit any object to be considered valid (since nodes have no collision).
+ *
+ * Only reads ViewPoses, so it can run on worker threads once PrepareFrame has been called.
+ *
+ * @param World World to trace in.
+ * @param NodeLocation Location of the node to test.
+ * @param PVSIndex Index of the node in the baked visibility matrix, or INDEX_NONE.
+ * @return true if any player has LOS to the location, false otherwise.
+ */
+bool UUPlayerLOSFilter::TraceNodeLOS(UWorld* World, const FVector& NodeLocation, int32 PVSIndex) const
+{
+	const FVector NodeTarget = NodeLocation + FVector(0, 0, 0.1f); // Slightly above the node
+
+	for (const FPlayerViewPose& Pose : ViewPoses)
+	{
+		// PVS test: statically hidden nodes need no trace
+		if (PVSIndex != INDEX_NONE && Pose.PVSNode != INDEX_NONE && VisibilityData->AreIndicesOccluded(Pose.PVSNode, PVSIndex))
+			continue;
+
 		// Dot product test: is node in front of camera?
-		FVector ToNode = (NodeLocation - CameraLocation).GetSafeNormal();
-		float Dot = FVector::DotProduct(CameraForward, ToNode);
+		FVector ToNode = (NodeLocation - Pose.Location).GetSafeNormal();
+		float Dot = FVector::DotProduct(Pose.Forward, ToNode);
 		const float DotThreshold = 0.0f; // Adjust as needed (0 = 90deg, 1 = 0deg)
 
 		if (Dot < DotThreshold)
@@ -84,13 +207,12 @@ bool UUPlayerLOSFilter::IsNodeInPlayerLOS(ANode* Node) const
 
 		// Line trace test: is there a clear line of sight?
 		FHitResult HitResult;
-		FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(PlayerLOS), true, Pawn);
+		FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(PlayerLOS), true, Pose.Pawn);
 		TraceParams.bReturnPhysicalMaterial = false;
-		TraceParams.AddIgnoredActor(Pawn);
 
 		bool bHit = World->LineTraceSingleByChannel(
 			HitResult,
-			CameraLocation,
+			Pose.Location,
 			NodeTarget,
 			ECC_Visibility,
 			TraceParams
@@ -106,3 +228,33 @@ bool UUPlayerLOSFilter::IsNodeInPlayerLOS(ANode* Node) const
 	// No player has LOS to this node
 	return false;
 }
+
+/**
+ * @brief Evaluates player LOS for graph nodes and writes it as a bit mask indexed by graph node.
+ *
+ * The nodes are traced as one batch, then every result is read back from the per-frame cache.
+ *
+ * @param Graph Compiled graph the indices refer to.
+ * @param Nodes Graph indices to evaluate; other bits are left clear.
+ * @param OutInLOS Sized to the graph; bit set = node is in LOS of a player.
+ */
+void UUPlayerLOSFilter::BuildLOSMask(const FNodeGraph& Graph, TConstArrayView<int32> Nodes, TBitArray<>& OutInLOS) const
+{
+	OutInLOS.Init(false, Graph.NumNodes());
+
+	TArray<ANode*> Actors;
+	Actors.Reserve(Nodes.Num());
+	for (int32 Index : Nodes)
+	{
+		Actors.Add(Graph.GetNode(Index));
+	}
+	EvaluateNodesLOS(Actors);
+
+	for (int32 I = 0; I < Nodes.Num(); ++I)
+	{
+		if (Actors[I] && Graph.IsValidNode(Nodes[I]))
+		{
+			OutInLOS[Nodes[I]] = IsNodeInPlayerLOS(Actors[I]);
+		}
+	}
+}
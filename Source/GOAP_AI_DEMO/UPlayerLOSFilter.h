@@ -3,20 +3,38 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
 #include "UNavFilter.h"
 #include "Node.h"
 #include "UPlayerLOSFilter.generated.h"
 
+class ANodeVisibilityData;
+struct FNodeGraph;
+
 /**
  * @class UUPlayerLOSFilter
  * @brief Navigation filter that checks if a node is in the line of sight (LOS) of a player.
+ *
+ * Results are cached per frame. Call EvaluateNodesLOS with the full candidate set before filtering
+ * so the traces run as one batch and the per-node checks become cache lookups.
+ * If the level has baked ANodeVisibilityData, nodes statically hidden from the player are rejected
+ * with a bit test and only the remaining nodes are traced.
  */
 UCLASS()
 class GOAP_AI_DEMO_API UUPlayerLOSFilter : public UUNavFilter
 {
 	GENERATED_BODY()
-	
+
 public:
+	/**
+	 * @brief Maximum distance from a player camera to the baked node used as its PVS viewpoint.
+	 *
+	 * If no baked node is this close, the PVS is not used for that player and every node is traced.
+	 * Capped at the bake's ViewRadius, the furthest a viewer can be from the node eye and still be covered by its row.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Navigation")
+	float PVSViewRadius = 150.f;
+
 	/**
 	 * @brief Validates if the given node is valid.
 	 * @param Node Pointer to the node to validate.
@@ -31,4 +49,55 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Navigation")
 	bool IsNodeInPlayerLOS(ANode* Node) const;
+
+	/**
+	 * @brief Evaluates player LOS for a batch of nodes and stores the results in the per-frame cache.
+	 *
+	 * Player camera poses are gathered once per frame, and the line traces are spread across
+	 * task graph worker threads. Nodes already cached this frame are skipped.
+	 *
+	 * @param Nodes Nodes to evaluate.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Navigation")
+	void EvaluateNodesLOS(const TArray<ANode*>& Nodes) const;
+
+	/**
+	 * @brief Evaluates player LOS for graph nodes and writes it as a bit mask indexed by graph node.
+	 *
+	 * Use the mask with FNodeMaskPolicy so searches test LOS with a bit lookup instead of a virtual call per node.
+	 *
+	 * @param Graph Compiled graph the indices refer to.
+	 * @param Nodes Graph indices to evaluate; other bits are left clear.
+	 * @param OutInLOS Sized to the graph; bit set = node is in LOS of a player.
+	 */
+	void BuildLOSMask(const FNodeGraph& Graph, TConstArrayView<int32> Nodes, TBitArray<>& OutInLOS) const;
+
+private:
+	/** Camera pose of one player, captured once per frame. */
+	struct FPlayerViewPose
+	{
+		FVector Location;
+		FVector Forward;
+		const APawn* Pawn;
+		int32 PVSNode; /**< Baked node standing in for the camera, or INDEX_NONE. */
+	};
+
+	/** Refreshes ViewPoses and resets the LOS cache when the frame has changed. */
+	void PrepareFrame(UWorld* World) const;
+
+	/** Runs the PVS, dot product and trace tests for one node against the cached poses. Safe to call off the game thread. */
+	bool TraceNodeLOS(UWorld* World, const FVector& NodeLocation, int32 PVSIndex) const;
+
+	/** Player camera poses for CacheFrame. */
+	mutable TArray<FPlayerViewPose> ViewPoses;
+
+	/** Node visibility results for CacheFrame. */
+	mutable TMap<TObjectKey<ANode>, bool> LOSCache;
+
+	/** Baked visibility for CacheWorld, if the level has one. */
+	mutable const ANodeVisibilityData* VisibilityData = nullptr;
+
+	/** World and frame the poses and cache were built for. */
+	mutable TWeakObjectPtr<UWorld> CacheWorld;
+	mutable uint64 CacheFrame = MAX_uint64;
 };